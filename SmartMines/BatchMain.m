@@ -0,0 +1,648 @@
+//
+//  BatchMain.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+/// Command line driver for the headless minefield engine.
+/** Plays games without a window server, either by feeding a move stream to
+    JbMinefield, by letting a trivial random player click until each game is
+    won or lost, or by letting JbMinefieldSolver play and only guess when it
+    is stuck. A summary line is printed on stdout when all games have
+    been played.
+
+    The games can be recorded as JbMoveJournals (-w), and journals can be
+    replayed (-r), either as fast as possible to verify them, or in real
+    time with one line per move. A journal file is a sequence of journals,
+    each preceded by its length as a four-byte little-endian number.
+
+    With -P the random player plays many games at the same time, hosted by
+    JbSessionManager, to measure how the moves per second grow with the
+    number of worker threads (-t).
+
+    The move stream is plain text with one command per line:
+    @code
+    new             start a new game (implied before the first move)
+    u ROW COLUMN    uncover (uncoverAt:)
+    m ROW COLUMN    mark (markAt:)
+    # ...           comment
+    @endcode
+    Moves on a finished game are ignored until the next "new".
+*/
+
+#import <Foundation/Foundation.h>
+#import <stdio.h>
+#import <stdlib.h>
+#import <string.h>
+#import <unistd.h>
+
+#import "Game.h"
+#import "Minefield.h"
+#import "MinefieldSolver.h"
+#import "MoveJournal.h"
+#import "Random.h"
+#import "SessionManager.h"
+#import "Stopwatch.h"
+
+typedef struct
+{
+    unsigned games;
+    unsigned won;
+    unsigned lost;
+    unsigned long moves;
+    unsigned long affectedSquares;
+    unsigned long guesses;
+    unsigned long long solverSteps;
+    unsigned long long generationAttempts;
+    double generationSeconds;
+    unsigned long long bbbv;
+    unsigned long long zini;
+} JbBatchResults;
+
+static void PrintUsage(const char* program)
+{
+    fprintf(stderr,
+            "usage: %s [-g ROWSxCOLUMNSxMINES] [-n GAMES] [-f MOVEFILE] [-s SEED] [-E] [-N] [-S] [-v]\n"
+            "          [-w JOURNALFILE] [-r JOURNALFILE [-R]] [-P SESSIONS [-t THREADS]]\n"
+            "  -g  game size (default 16x30x99)\n"
+            "  -n  number of games played by the random player (default 1000)\n"
+            "  -f  read moves from MOVEFILE instead (\"-\" is stdin)\n"
+            "  -s  seed that the seeds of the individual games are drawn from\n"
+            "  -E  disable easy start\n"
+            "  -N  only play minefields that can be solved without guessing\n"
+            "  -S  let the solver play, and guess the square least likely to\n"
+            "      have a mine when it is stuck\n"
+            "  -v  print the result of each game\n"
+            "  -w  write the journals of the games to JOURNALFILE\n"
+            "  -r  replay the journals in JOURNALFILE (\"-\" is stdin)\n"
+            "  -R  replay in real time, printing each move\n"
+            "  -P  let the random player play SESSIONS games at a time with\n"
+            "      JbSessionManager\n"
+            "  -t  number of worker threads for -P (default the number of processors)\n",
+            program);
+}
+
+static BOOL WriteJournal(JbMoveJournal* journal, FILE* file)
+{
+    NSData* data = [journal data];
+    uint32_t length = (uint32_t)[data length];
+    uint8_t prefix[4] = {length, length >> 8, length >> 16, length >> 24};
+    return fwrite(prefix, 1, 4, file) == 4
+           && fwrite([data bytes], 1, length, file) == length;
+}
+
+/// Reads the next journal from @a file.
+/** @return nil at the end of the file, or if the journal is invalid, in
+            which case @a isValid is set to NO.
+*/
+static JbMoveJournal* ReadJournal(FILE* file, BOOL* isValid)
+{
+    uint8_t prefix[4];
+    *isValid = YES;
+    size_t count = fread(prefix, 1, 4, file);
+    if (count == 0)
+        return nil;
+    uint32_t length = prefix[0] | (prefix[1] << 8) | (prefix[2] << 16)
+                      | ((uint32_t)prefix[3] << 24);
+    NSMutableData* data = [NSMutableData dataWithLength:length];
+    JbMoveJournal* journal = nil;
+    if (count == 4 && fread([data mutableBytes], 1, length, file) == length)
+        journal = [JbMoveJournal journalWithData:data];
+    *isValid = journal != nil;
+    return journal;
+}
+
+static void RecordGame(JbMinefield* minefield,
+                       JbBatchResults* results,
+                       BOOL verbose,
+                       FILE* journalFile)
+{
+    JbMinefieldState state = [minefield state];
+    if (state == JbNotStarted)
+        return;
+
+    if (journalFile != NULL)
+        WriteJournal([minefield journal], journalFile);
+
+    ++results->games;
+    results->generationAttempts += [minefield numberOfGenerationAttempts];
+    results->generationSeconds += [minefield generationTime];
+    JbMinefieldMetrics metrics = [minefield metrics];
+    results->bbbv += metrics.bbbv;
+    results->zini += metrics.zini;
+    if (state == JbCompleted)
+        ++results->won;
+    else if (state == JbBlownUp)
+        ++results->lost;
+
+    if (verbose)
+        printf("game=%u seed=%llu state=%s covered=%u marked=%u"
+               " openings=%u isolated_numbers=%u bbbv=%u zini=%u"
+               " generation_attempts=%llu generation_seconds=%.6f\n",
+               results->games,
+               (unsigned long long)[minefield seed],
+               state == JbCompleted ? "won" : state == JbBlownUp ? "lost" : "unfinished",
+               [minefield numberOfCoveredSquares],
+               [minefield numberOfMarkedSquares],
+               metrics.openings, metrics.isolatedNumbers, metrics.bbbv, metrics.zini,
+               (unsigned long long)[minefield numberOfGenerationAttempts],
+               [minefield generationTime]);
+}
+
+static BOOL IsGameOver(JbMinefield* minefield)
+{
+    JbMinefieldState state = [minefield state];
+    return state == JbCompleted || state == JbBlownUp;
+}
+
+static void PlayRandomGames(JbMinefield* minefield,
+                            JbRandom* random,
+                            unsigned games,
+                            JbBatchResults* results,
+                            BOOL verbose,
+                            FILE* journalFile)
+{
+    JbTableSize size = [minefield size];
+    JbTableIndexList* affected = [[JbTableIndexList alloc] initWithCapacity:64];
+    for (unsigned game = 0; game != games; ++game)
+    {
+        NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+        [minefield clear];
+        [minefield setSeed:JbNextRandom(random)];
+        JbTableIndex idx = JbMakeTableIndex(size.rows / 2, size.columns / 2);
+        while (!IsGameOver(minefield))
+        {
+            if ([minefield stateAt:idx] == JbUnmarked)
+            {
+                [affected removeAllValues];
+                [minefield uncoverAt:idx affectedSquares:affected];
+                results->affectedSquares += [affected count];
+                ++results->moves;
+            }
+            idx = JbMakeTableIndex((unsigned)JbRandomBelow(random, size.rows),
+                                   (unsigned)JbRandomBelow(random, size.columns));
+        }
+        RecordGame(minefield, results, verbose, journalFile);
+        [pool release];
+    }
+    [affected release];
+}
+
+static void PlaySolverGames(JbMinefield* minefield,
+                            JbRandom* random,
+                            unsigned games,
+                            JbBatchResults* results,
+                            BOOL verbose,
+                            FILE* journalFile)
+{
+    JbTableSize size = [minefield size];
+    JbMinefieldSolver* solver = [[JbMinefieldSolver alloc] initWithSize:size
+                                                          numberOfMines:[minefield numberOfMines]];
+    JbTableIndexList* affected = [[JbTableIndexList alloc] initWithCapacity:64];
+    for (unsigned game = 0; game != games; ++game)
+    {
+        NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+        [minefield clear];
+        [minefield setSeed:JbNextRandom(random)];
+        [solver clear];
+        JbTableIndex idx = JbMakeTableIndex(size.rows / 2, size.columns / 2);
+        while (!IsGameOver(minefield))
+        {
+            [affected removeAllValues];
+            [minefield uncoverAt:idx affectedSquares:affected];
+            results->affectedSquares += [affected count];
+            ++results->moves;
+            [solver addUncoveredSquares:affected ofMinefield:minefield];
+            if ([solver solveMinefield:minefield] || IsGameOver(minefield))
+                break;
+            [[solver mineSquares] removeAllValues];
+            idx = [solver guessSquareOfMinefield:minefield];
+            ++results->guesses;
+        }
+        RecordGame(minefield, results, verbose, journalFile);
+        [pool release];
+    }
+    results->solverSteps += [solver numberOfSteps];
+    [affected release];
+    [solver release];
+}
+
+static BOOL PlayMoveStream(JbMinefield* minefield,
+                           JbRandom* random,
+                           FILE* file,
+                           JbBatchResults* results,
+                           BOOL verbose,
+                           FILE* journalFile)
+{
+    JbTableSize size = [minefield size];
+    char line[256];
+    unsigned lineNumber = 0;
+    JbTableIndexList* affected = [[[JbTableIndexList alloc] initWithCapacity:64] autorelease];
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    [minefield clear];
+    [minefield setSeed:JbNextRandom(random)];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        ++lineNumber;
+        char command[16];
+        unsigned row, column;
+        int fields = sscanf(line, "%15s %u %u", command, &row, &column);
+        if (fields <= 0 || command[0] == '#')
+            continue;
+
+        if (strcmp(command, "new") == 0)
+        {
+            RecordGame(minefield, results, verbose, journalFile);
+            [pool release];
+            pool = [[NSAutoreleasePool alloc] init];
+            [minefield clear];
+            [minefield setSeed:JbNextRandom(random)];
+            continue;
+        }
+
+        if (fields != 3 || (strcmp(command, "u") != 0 && strcmp(command, "m") != 0))
+        {
+            fprintf(stderr, "line %u: invalid command: %s", lineNumber, line);
+            [pool release];
+            return NO;
+        }
+        if (row >= size.rows || column >= size.columns)
+        {
+            fprintf(stderr, "line %u: square is outside the minefield: %s",
+                    lineNumber, line);
+            [pool release];
+            return NO;
+        }
+        if (IsGameOver(minefield))
+            continue;
+
+        JbTableIndex idx = JbMakeTableIndex(row, column);
+        [affected removeAllValues];
+        if (command[0] == 'u')
+            [minefield uncoverAt:idx affectedSquares:affected];
+        else if ([minefield state] != JbNotStarted)
+            [minefield markAt:idx affectedSquares:affected];
+        else
+            continue;
+        results->affectedSquares += [affected count];
+        ++results->moves;
+    }
+    RecordGame(minefield, results, verbose, journalFile);
+    [pool release];
+    return YES;
+}
+
+/// The random player for games hosted by JbSessionManager.
+/** Every result is answered with the session's next request: a random
+    uncover, or when the game is over, a new game or the end of the session.
+    The results are counted with atomic additions, as the delegate is called
+    on all the worker threads.
+*/
+@interface JbSessionPlayer : NSObject <JbSessionManagerDelegate>
+{
+    JbTableSize mSize;
+    uint64_t mSeed;
+    volatile long long mGamesToStart;
+    volatile unsigned mGames;
+    volatile unsigned mWon;
+    volatile unsigned mLost;
+}
+
+- (id)initWithSize:(JbTableSize)size seed:(uint64_t)seed gamesToStart:(long long)games;
+- (void)getResults:(JbBatchResults*)results;
+@end
+
+@implementation JbSessionPlayer
+
+- (id)initWithSize:(JbTableSize)size seed:(uint64_t)seed gamesToStart:(long long)games
+{
+    self = [super init];
+    if (self)
+    {
+        mSize = size;
+        mSeed = seed;
+        mGamesToStart = games;
+        mGames = 0;
+        mWon = 0;
+        mLost = 0;
+    }
+    return self;
+}
+
+- (void)sessionManager:(JbSessionManager*)manager
+      didHandleRequest:(const JbSessionRequest*)request
+                result:(const JbSessionResult*)result
+{
+    if (!result->isValid || request->command == JbSessionClose)
+        return;
+
+    JbSessionRequest next;
+    next.session = request->session;
+    next.index = JbMakeTableIndex(0, 0);
+    if (result->state == JbCompleted || result->state == JbBlownUp)
+    {
+        __sync_add_and_fetch(&mGames, 1);
+        __sync_add_and_fetch(result->state == JbCompleted ? &mWon : &mLost, 1);
+        next.command = __sync_sub_and_fetch(&mGamesToStart, 1) >= 0
+                       ? JbSessionNewGame : JbSessionClose;
+    }
+    else if (result->numberOfMoves == 0)
+    {
+        next.command = JbSessionUncover;
+        next.index = JbMakeTableIndex(mSize.rows / 2, mSize.columns / 2);
+    }
+    else
+    {
+        // The squares only depend on the seed, the session and the move.
+        JbRandom random;
+        JbSeedRandom(&random, mSeed ^ ((uint64_t)request->session << 32)
+                              ^ result->numberOfMoves);
+        next.command = JbSessionUncover;
+        next.index = JbMakeTableIndex((unsigned)JbRandomBelow(&random, mSize.rows),
+                                      (unsigned)JbRandomBelow(&random, mSize.columns));
+    }
+    [manager submitRequest:next];
+}
+
+- (void)getResults:(JbBatchResults*)results
+{
+    results->games += mGames;
+    results->won += mWon;
+    results->lost += mLost;
+}
+
+@end
+
+/// Plays @a games games with the random player, @a sessions at a time.
+static void PlaySessionGames(JbGame* game,
+                             BOOL usesEasyStart,
+                             uint64_t seed,
+                             unsigned games,
+                             unsigned sessions,
+                             unsigned threads,
+                             JbBatchResults* results)
+{
+    sessions = MIN(sessions, games);
+    JbSessionManager* manager = [[JbSessionManager alloc] initWithNumberOfThreads:threads];
+    JbSessionPlayer* player = [[JbSessionPlayer alloc] initWithSize:[game size]
+                                                               seed:seed
+                                                       gamesToStart:(long long)games - sessions];
+    [manager setDelegate:player];
+    JbRandom random;
+    JbSeedRandom(&random, seed);
+    for (unsigned i = 0; i != sessions; ++i)
+        [manager createSessionWithSize:[game size]
+                         numberOfMines:[game mines]
+                         usesEasyStart:usesEasyStart
+                                  seed:JbNextRandom(&random)];
+    [manager waitUntilIdle];
+    [manager stop];
+
+    [player getResults:results];
+    results->moves += [manager numberOfMoves];
+    [player release];
+    [manager release];
+}
+
+/// Prints the moves of @a journal from number @a first to @a last.
+static void PrintMoves(JbMoveJournal* journal, size_t first, size_t last)
+{
+    const JbJournalMove* moves = [journal moves];
+    for (size_t i = first; i != last; ++i)
+    {
+        if (moves[i].kind == JbSettingsMove)
+            printf("%.3f settings %u\n", moves[i].milliseconds / 1000.0, moves[i].settings);
+        else
+            printf("%.3f %c %u %u\n", moves[i].milliseconds / 1000.0,
+                   moves[i].kind == JbUncoverMove ? 'u' : 'm',
+                   moves[i].index.row, moves[i].index.column);
+    }
+    fflush(stdout);
+}
+
+/// Replays @a journal on @a minefield with the moves' own timing.
+static void ReplayInRealTime(JbMoveJournal* journal, JbMinefield* minefield)
+{
+    [journal prepareMinefield:minefield];
+    JbStopwatch* stopwatch = [[JbStopwatch alloc] init];
+    [stopwatch start];
+    const JbJournalMove* moves = [journal moves];
+    size_t count = [journal numberOfMoves];
+    size_t i = 0;
+    while (i < count)
+    {
+        double delay = moves[i].milliseconds / 1000.0 - [stopwatch seconds];
+        if (delay > 0)
+            usleep((useconds_t)(delay * 1e6));
+        size_t next = [journal replayMovesOnMinefield:minefield
+                                            fromIndex:i
+                                         untilSeconds:moves[i].milliseconds / 1000.0
+                                      affectedSquares:nil];
+        PrintMoves(journal, i, MIN(next, count));
+        i = next;
+    }
+    [stopwatch release];
+}
+
+static BOOL ReplayJournals(JbMinefield* minefield,
+                           FILE* file,
+                           BOOL isRealTime,
+                           JbBatchResults* results,
+                           BOOL verbose)
+{
+    BOOL isValid = YES;
+    JbMoveJournal* journal;
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    while ((journal = ReadJournal(file, &isValid)) != nil)
+    {
+        if (isRealTime)
+            ReplayInRealTime(journal, minefield);
+        else
+            [journal replayOnMinefield:minefield];
+        results->moves += [journal numberOfMoves];
+        RecordGame(minefield, results, verbose, NULL);
+        if (results->games % 1024 == 0)
+        {
+            [pool release];
+            pool = [[NSAutoreleasePool alloc] init];
+        }
+    }
+    [pool release];
+    if (!isValid)
+        fprintf(stderr, "journal %u is invalid\n", results->games + 1);
+    return isValid;
+}
+
+int main(int argc, char* argv[])
+{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    const char* description = "16x30x99";
+    const char* moveFileName = NULL;
+    const char* journalFileName = NULL;
+    const char* replayFileName = NULL;
+    BOOL isRealTime = NO;
+    unsigned games = 1000;
+    uint64_t seed = JbMakeRandomSeed();
+    BOOL usesEasyStart = YES;
+    BOOL usesSolver = NO;
+    unsigned sessions = 0;
+    unsigned threads = 0;
+    BOOL usesNoGuessBoards = NO;
+    BOOL verbose = NO;
+
+    int option;
+    while ((option = getopt(argc, argv, "g:n:f:s:ENSvw:r:RP:t:")) != -1)
+    {
+        switch (option)
+        {
+        case 'g': description = optarg; break;
+        case 'n': games = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'f': moveFileName = optarg; break;
+        case 's': seed = strtoull(optarg, NULL, 10); break;
+        case 'E': usesEasyStart = NO; break;
+        case 'N': usesNoGuessBoards = YES; break;
+        case 'S': usesSolver = YES; break;
+        case 'v': verbose = YES; break;
+        case 'w': journalFileName = optarg; break;
+        case 'r': replayFileName = optarg; break;
+        case 'R': isRealTime = YES; break;
+        case 'P': sessions = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 't': threads = (unsigned)strtoul(optarg, NULL, 10); break;
+        default:
+            PrintUsage(argv[0]);
+            [pool release];
+            return 1;
+        }
+    }
+
+    JbGame* game = [[[JbGame alloc] initWithDescription:
+                        [NSString stringWithUTF8String:description]] autorelease];
+    if (game == nil)
+    {
+        fprintf(stderr, "%s: invalid game size: %s\n", argv[0], description);
+        [pool release];
+        return 1;
+    }
+
+    [game setUsesNoGuessBoards:usesNoGuessBoards];
+
+    JbRandom random;
+    JbSeedRandom(&random, seed);
+    JbMinefield* minefield = [[[JbMinefield alloc] initWithSize:[game size]
+                                                  numberOfMines:[game mines]] autorelease];
+    [minefield setUsesEasyStart:usesEasyStart];
+    [minefield setUsesNoGuessBoards:[game usesNoGuessBoards]];
+
+    if ((journalFileName != NULL && replayFileName != NULL)
+        || (isRealTime && replayFileName == NULL)
+        || (sessions != 0 && (journalFileName != NULL || replayFileName != NULL
+                              || moveFileName != NULL || usesSolver
+                              || usesNoGuessBoards)))
+    {
+        PrintUsage(argv[0]);
+        [pool release];
+        return 1;
+    }
+
+    FILE* journalFile = NULL;
+    if (journalFileName != NULL)
+    {
+        journalFile = fopen(journalFileName, "wb");
+        if (journalFile == NULL)
+        {
+            fprintf(stderr, "%s: can't create %s\n", argv[0], journalFileName);
+            [pool release];
+            return 1;
+        }
+        [minefield setJournal:[[[JbMoveJournal alloc] init] autorelease]];
+    }
+
+    JbBatchResults results = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    JbStopwatch* stopwatch = [[[JbStopwatch alloc] init] autorelease];
+    [stopwatch start];
+
+    BOOL success = YES;
+    if (replayFileName != NULL)
+    {
+        FILE* file = strcmp(replayFileName, "-") == 0 ? stdin : fopen(replayFileName, "rb");
+        if (file == NULL)
+        {
+            fprintf(stderr, "%s: can't open %s\n", argv[0], replayFileName);
+            [pool release];
+            return 1;
+        }
+        success = ReplayJournals(minefield, file, isRealTime, &results, verbose);
+        if (file != stdin)
+            fclose(file);
+    }
+    else if (moveFileName != NULL)
+    {
+        FILE* file = strcmp(moveFileName, "-") == 0 ? stdin : fopen(moveFileName, "r");
+        if (file == NULL)
+        {
+            fprintf(stderr, "%s: can't open %s\n", argv[0], moveFileName);
+            [pool release];
+            return 1;
+        }
+        success = PlayMoveStream(minefield, &random, file, &results, verbose, journalFile);
+        if (file != stdin)
+            fclose(file);
+    }
+    else if (sessions != 0)
+    {
+        PlaySessionGames(game, usesEasyStart, seed, games, sessions, threads, &results);
+    }
+    else if (usesSolver)
+    {
+        PlaySolverGames(minefield, &random, games, &results, verbose, journalFile);
+    }
+    else
+    {
+        PlayRandomGames(minefield, &random, games, &results, verbose, journalFile);
+    }
+
+    double seconds = [stopwatch stop];
+    if (journalFile != NULL && fclose(journalFile) != 0)
+    {
+        fprintf(stderr, "%s: can't write %s\n", argv[0], journalFileName);
+        success = NO;
+    }
+    printf("game=%s seed=%llu games=%u won=%u lost=%u moves=%lu affected=%lu"
+           " guesses=%lu solver_steps=%llu bbbv=%llu zini=%llu"
+           " generation_attempts=%llu generation_seconds=%.6f seconds=%.6f"
+           " games_per_second=%.1f\n",
+           [[game description] UTF8String], (unsigned long long)seed,
+           results.games, results.won, results.lost,
+           results.moves, results.affectedSquares,
+           results.guesses, results.solverSteps,
+           results.bbbv, results.zini,
+           results.generationAttempts, results.generationSeconds,
+           seconds, seconds > 0 ? results.games / seconds : 0.0);
+
+    [pool release];
+    return success ? 0 : 1;
+}
@@ -0,0 +1,552 @@
+//
+//  BenchMain.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+/// Benchmarks of the minefield engine's basic operations.
+/** Every benchmark is run for each combination of board size and mine
+    density, and prints one line of key=value pairs:
+    @code
+    benchmark=uncover_cascade rows=16 columns=30 mines=96 density=0.20 rounds=5
+    ops=262 ns_per_op=1234.5 min_ns_per_op=1200.1 max_ns_per_op=1290.3
+    allocations_per_op=0.000
+    @endcode
+    (on a single line). The minefields are generated from a fixed seed and
+    the number of operations per round only depends on the board size, so
+    two runs do the same work and their output can be compared line by
+    line. ns_per_op is the median of the rounds, after one round that
+    warms up the caches and lets the minefield's buffers grow.
+
+    With glibc the tool counts the calls to malloc, calloc, realloc and
+    posix_memalign by defining them itself and forwarding them to the C
+    library. Elsewhere allocations_per_op is -1.
+*/
+
+#import <Foundation/Foundation.h>
+#import <errno.h>
+#import <stdio.h>
+#import <stdlib.h>
+#import <string.h>
+#import <time.h>
+#import <unistd.h>
+
+#import "Minefield.h"
+#import "Random.h"
+#import "TableIndexList.h"
+
+/// JbMinefield's internal steps, which are timed on their own.
+@interface JbMinefield (Internals)
+- (void)createMinefieldAroundFirstUncoveredSquareAt:(JbTableIndex)idx;
+- (void)computeMinedNeighborCounts;
+- (void)smartUncoverAt:(JbTableIndex)idx
+       affectedSquares:(id<JbTableIndexCollector>)affectedSquares;
+@end
+
+#if defined(__GLIBC__)
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* pointer, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+
+static volatile unsigned long long NumberOfAllocations = 0;
+static const BOOL CountsAllocations = YES;
+
+void* malloc(size_t size)
+{
+    __sync_add_and_fetch(&NumberOfAllocations, 1);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    __sync_add_and_fetch(&NumberOfAllocations, 1);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size)
+{
+    __sync_add_and_fetch(&NumberOfAllocations, 1);
+    return __libc_realloc(pointer, size);
+}
+
+int posix_memalign(void** pointer, size_t alignment, size_t size)
+{
+    __sync_add_and_fetch(&NumberOfAllocations, 1);
+    *pointer = __libc_memalign(alignment, size);
+    return *pointer != NULL ? 0 : ENOMEM;
+}
+
+#else
+
+static const unsigned long long NumberOfAllocations = 0;
+static const BOOL CountsAllocations = NO;
+
+#endif
+
+/// The number of squares each round visits, roughly. Small boards get many
+/// operations per round and the largest get one.
+enum {SquaresPerRound = 1 << 22};
+enum {MaximumOperationsPerRound = 100000};
+enum {MaximumRounds = 101};
+
+typedef struct
+{
+    unsigned long long operations;
+    double seconds;
+    unsigned long long allocations;
+} JbBenchmarkRound;
+
+typedef void (*JbBenchmarkFunction)(JbMinefield* minefield,
+                                    unsigned operations,
+                                    uint64_t seed,
+                                    JbBenchmarkRound* round);
+
+static inline double GetTime(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1.0e-9;
+}
+
+/// Measures the time and allocations between a call to StartMeasuring and
+/// the next call to StopMeasuring.
+static inline void StartMeasuring(JbBenchmarkRound* round)
+{
+    round->allocations -= NumberOfAllocations;
+    round->seconds -= GetTime();
+}
+
+static inline void StopMeasuring(JbBenchmarkRound* round)
+{
+    round->seconds += GetTime();
+    round->allocations += NumberOfAllocations;
+}
+
+static JbTableIndex MiddleSquare(JbMinefield* minefield)
+{
+    JbTableSize size = [minefield size];
+    return JbMakeTableIndex(size.rows / 2, size.columns / 2);
+}
+
+/// Clears @a minefield and places its mines with @a seed.
+static void PlaceMines(JbMinefield* minefield, uint64_t seed)
+{
+    [minefield clear];
+    [minefield setSeed:seed];
+    [minefield createMinefieldAroundFirstUncoveredSquareAt:MiddleSquare(minefield)];
+}
+
+/// Places the mines, which includes counting the mined neighbors and
+/// finding the openings.
+static void BenchmarkPlace(JbMinefield* minefield,
+                           unsigned operations,
+                           uint64_t seed,
+                           JbBenchmarkRound* round)
+{
+    JbTableIndex middle = MiddleSquare(minefield);
+    for (unsigned i = 0; i != operations; ++i)
+    {
+        [minefield clear];
+        [minefield setSeed:seed + i];
+        StartMeasuring(round);
+        [minefield createMinefieldAroundFirstUncoveredSquareAt:middle];
+        StopMeasuring(round);
+        ++round->operations;
+    }
+}
+
+static void BenchmarkNeighborCounts(JbMinefield* minefield,
+                                    unsigned operations,
+                                    uint64_t seed,
+                                    JbBenchmarkRound* round)
+{
+    PlaceMines(minefield, seed);
+    StartMeasuring(round);
+    for (unsigned i = 0; i != operations; ++i)
+        [minefield computeMinedNeighborCounts];
+    StopMeasuring(round);
+    round->operations += operations;
+}
+
+/// Uncovers the middle square, which is always the start of an opening.
+static void BenchmarkUncoverCascade(JbMinefield* minefield,
+                                    unsigned operations,
+                                    uint64_t seed,
+                                    JbBenchmarkRound* round)
+{
+    JbTableIndex middle = MiddleSquare(minefield);
+    JbTableIndexList* affected = [[JbTableIndexList alloc] initWithCapacity:64];
+    for (unsigned i = 0; i != operations; ++i)
+    {
+        PlaceMines(minefield, seed + i);
+        [affected removeAllValues];
+        StartMeasuring(round);
+        [minefield uncoverAt:middle affectedSquares:affected];
+        StopMeasuring(round);
+        ++round->operations;
+    }
+    [affected release];
+}
+
+/// Marks every mine, and then smart uncovers every uncovered number with
+/// unmarked neighbors, row by row, until the game is won or the numbers in
+/// reach have all been visited.
+static void BenchmarkSmartUncover(JbMinefield* minefield,
+                                  unsigned operations,
+                                  uint64_t seed,
+                                  JbBenchmarkRound* round)
+{
+    JbTableSize size = [minefield size];
+    JbTableIndexList* affected = [[JbTableIndexList alloc] initWithCapacity:64];
+    for (unsigned i = 0; i != operations; ++i)
+    {
+        PlaceMines(minefield, seed + i);
+        [affected removeAllValues];
+        [minefield uncoverAt:MiddleSquare(minefield) affectedSquares:affected];
+        JbTableIndexList* mines = [minefield mineSquares];
+        for (size_t j = 0; j != [mines count] && [minefield state] == JbNotCompleted; ++j)
+        {
+            [affected removeAllValues];
+            [minefield markAt:[mines valueAtIndex:j] affectedSquares:affected];
+        }
+
+        JbTableIterator it = JbMakeTableIterator(0, 0, size.rows, size.columns);
+        while ([minefield state] == JbNotCompleted && JbTableIteratorNext(&it))
+        {
+            if ([minefield stateAt:it.index] != JbUncovered
+                || [minefield countCoveredNeighborsAt:it.index]
+                   == [minefield countMarkedNeighborsAt:it.index])
+                continue;
+            [affected removeAllValues];
+            StartMeasuring(round);
+            [minefield smartUncoverAt:it.index affectedSquares:affected];
+            StopMeasuring(round);
+            ++round->operations;
+        }
+    }
+    [affected release];
+}
+
+/// Marks and unmarks covered squares chosen at random.
+static void BenchmarkMark(JbMinefield* minefield,
+                          unsigned operations,
+                          uint64_t seed,
+                          JbBenchmarkRound* round)
+{
+    JbTableSize size = [minefield size];
+    JbTableIndexList* affected = [[JbTableIndexList alloc] initWithCapacity:64];
+    PlaceMines(minefield, seed);
+    [minefield uncoverAt:MiddleSquare(minefield) affectedSquares:affected];
+    if ([minefield state] != JbNotCompleted)
+    {
+        // The first click won the game, which leaves nothing to mark.
+        [affected release];
+        return;
+    }
+
+    JbRandom random;
+    JbSeedRandom(&random, seed);
+    JbTableIndexList* squares = [[JbTableIndexList alloc] initWithCapacity:operations];
+    while ([squares count] != operations)
+    {
+        JbTableIndex idx = JbMakeTableIndex((unsigned)JbRandomBelow(&random, size.rows),
+                                            (unsigned)JbRandomBelow(&random, size.columns));
+        if ([minefield stateAt:idx] == JbUnmarked)
+            [squares addValue:idx];
+    }
+
+    StartMeasuring(round);
+    for (unsigned i = 0; i != operations; ++i)
+    {
+        JbTableIndex idx = [squares valueAtIndex:i];
+        [affected removeAllValues];
+        [minefield markAt:idx affectedSquares:affected];
+        [affected removeAllValues];
+        [minefield markAt:idx affectedSquares:affected];
+    }
+    StopMeasuring(round);
+    round->operations += 2 * operations;
+    [squares release];
+    [affected release];
+}
+
+/// Tries uncovering covered squares chosen at random, rolling each try
+/// back, as a look-ahead search would.
+static void BenchmarkCheckpoint(JbMinefield* minefield,
+                                unsigned operations,
+                                uint64_t seed,
+                                JbBenchmarkRound* round)
+{
+    JbTableSize size = [minefield size];
+    JbTableIndexList* affected = [[JbTableIndexList alloc] initWithCapacity:64];
+    PlaceMines(minefield, seed);
+    [minefield uncoverAt:MiddleSquare(minefield) affectedSquares:affected];
+    if ([minefield state] != JbNotCompleted)
+    {
+        [affected release];
+        return;
+    }
+
+    JbRandom random;
+    JbSeedRandom(&random, seed);
+    JbTableIndexList* squares = [[JbTableIndexList alloc] initWithCapacity:operations];
+    while ([squares count] != operations)
+    {
+        JbTableIndex idx = JbMakeTableIndex((unsigned)JbRandomBelow(&random, size.rows),
+                                            (unsigned)JbRandomBelow(&random, size.columns));
+        if ([minefield stateAt:idx] == JbUnmarked)
+            [squares addValue:idx];
+    }
+
+    StartMeasuring(round);
+    for (unsigned i = 0; i != operations; ++i)
+    {
+        [affected removeAllValues];
+        [minefield pushCheckpoint];
+        [minefield uncoverAt:[squares valueAtIndex:i] affectedSquares:affected];
+        [affected removeAllValues];
+        [minefield rollBackWithAffectedSquares:affected];
+    }
+    StopMeasuring(round);
+    round->operations += operations;
+    [squares release];
+    [affected release];
+}
+
+/// Fills a new list with as many indexes as there are squares, starting
+/// with room for 16.
+static void BenchmarkIndexListGrowth(JbMinefield* minefield,
+                                     unsigned operations,
+                                     uint64_t seed,
+                                     JbBenchmarkRound* round)
+{
+    JbTableSize size = [minefield size];
+    for (unsigned i = 0; i != operations; ++i)
+    {
+        StartMeasuring(round);
+        JbTableIndexList* list = [[JbTableIndexList alloc] initWithCapacity:16];
+        JbTableIterator it = JbMakeTableIterator(0, 0, size.rows, size.columns);
+        while (JbTableIteratorNext(&it))
+            [list addValue:it.index];
+        [list release];
+        StopMeasuring(round);
+        round->operations += (unsigned long long)size.rows * size.columns;
+    }
+}
+
+typedef struct
+{
+    const char* name;
+    JbBenchmarkFunction function;
+    /// The number of squares an operation visits, as a multiple of the
+    /// board size, which determines the number of operations per round.
+    double squaresPerOperation;
+} JbBenchmark;
+
+static const JbBenchmark Benchmarks[] =
+{
+    {"place", BenchmarkPlace, 1},
+    {"neighbor_counts", BenchmarkNeighborCounts, 1},
+    {"uncover_cascade", BenchmarkUncoverCascade, 1},
+    {"smart_uncover", BenchmarkSmartUncover, 2},
+    {"mark", BenchmarkMark, 0.001},
+    {"checkpoint", BenchmarkCheckpoint, 0.01},
+    {"index_list_add", BenchmarkIndexListGrowth, 1}
+};
+enum {NumberOfBenchmarks = sizeof(Benchmarks) / sizeof(*Benchmarks)};
+
+static int CompareDoubles(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static void RunBenchmark(const JbBenchmark* benchmark,
+                         JbTableSize size,
+                         unsigned mines,
+                         unsigned rounds,
+                         uint64_t seed)
+{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    JbMinefield* minefield = [[[JbMinefield alloc] initWithSize:size
+                                                  numberOfMines:mines] autorelease];
+    [minefield setUsesEasyStart:YES];
+    [minefield setUsesSmartUncover:YES];
+    [minefield setUsesSmartMark:YES];
+    [minefield setUsesQuestionMarks:NO affectedSquares:nil];
+
+    double squares = (double)size.rows * size.columns;
+    double operations = SquaresPerRound / (squares * benchmark->squaresPerOperation);
+    unsigned operationsPerRound = (unsigned)MAX(MIN(operations, (double)MaximumOperationsPerRound), 1.0);
+
+    double nanoseconds[MaximumRounds];
+    JbBenchmarkRound round;
+    for (unsigned i = 0; i <= rounds; ++i)
+    {
+        memset(&round, 0, sizeof(round));
+        benchmark->function(minefield, operationsPerRound, seed, &round);
+        if (i != 0)
+            nanoseconds[i - 1] = round.operations != 0
+                                 ? round.seconds * 1e9 / round.operations : 0;
+    }
+    qsort(nanoseconds, rounds, sizeof(*nanoseconds), CompareDoubles);
+
+    printf("benchmark=%s rows=%u columns=%u mines=%u density=%.2f rounds=%u ops=%llu"
+           " ns_per_op=%.1f min_ns_per_op=%.1f max_ns_per_op=%.1f allocations_per_op=%.3f\n",
+           benchmark->name, size.rows, size.columns, mines, mines / squares, rounds,
+           round.operations, nanoseconds[rounds / 2], nanoseconds[0], nanoseconds[rounds - 1],
+           !CountsAllocations ? -1.0
+           : round.operations != 0 ? (double)round.allocations / round.operations : 0.0);
+    fflush(stdout);
+    [pool release];
+}
+
+static void PrintUsage(const char* program)
+{
+    fprintf(stderr,
+            "usage: %s [-g ROWSxCOLUMNS,...] [-d PERCENT,...] [-b BENCHMARK,...] [-r ROUNDS] [-s SEED]\n"
+            "  -g  board sizes (default 9x9,16x16,16x30,100x100,500x500,2000x2000)\n"
+            "  -d  mine densities in percent (default 10,20,30,40,50)\n"
+            "  -b  the benchmarks to run (default all): place, neighbor_counts,\n"
+            "      uncover_cascade, smart_uncover, mark, checkpoint, index_list_add\n"
+            "  -r  number of measured rounds (default 5)\n"
+            "  -s  seed of the minefields (default 1)\n",
+            program);
+}
+
+/// Parses a comma-separated list of up to 64 board sizes.
+static unsigned ParseSizes(const char* text, JbTableSize* sizes)
+{
+    unsigned count = 0;
+    while (*text != '\0' && count != 64)
+    {
+        unsigned rows, columns;
+        int length;
+        if (sscanf(text, "%ux%u%n", &rows, &columns, &length) != 2
+            || rows < 3 || columns < 3)
+            return 0;
+        sizes[count++] = JbMakeTableSize(rows, columns);
+        text += length;
+        if (*text == ',')
+            ++text;
+        else if (*text != '\0')
+            return 0;
+    }
+    return count;
+}
+
+/// Parses a comma-separated list of up to 64 percentages.
+static unsigned ParseDensities(const char* text, double* densities)
+{
+    unsigned count = 0;
+    while (*text != '\0' && count != 64)
+    {
+        char* end;
+        double density = strtod(text, &end);
+        if (end == text || density <= 0 || density >= 100)
+            return 0;
+        densities[count++] = density;
+        if (*end == ',')
+            ++end;
+        else if (*end != '\0')
+            return 0;
+        text = end;
+    }
+    return count;
+}
+
+/// True if @a name is in the comma-separated @a list.
+static BOOL IsInList(const char* name, const char* list)
+{
+    size_t length = strlen(name);
+    for (const char* it = list; it != NULL; it = strchr(it, ','))
+    {
+        if (*it == ',')
+            ++it;
+        if (strncmp(it, name, length) == 0 && (it[length] == ',' || it[length] == '\0'))
+            return YES;
+    }
+    return NO;
+}
+
+int main(int argc, char* argv[])
+{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    const char* sizeList = "9x9,16x16,16x30,100x100,500x500,2000x2000";
+    const char* densityList = "10,20,30,40,50";
+    const char* benchmarkList = NULL;
+    unsigned rounds = 5;
+    uint64_t seed = 1;
+
+    int option;
+    BOOL isValid = YES;
+    while (isValid && (option = getopt(argc, argv, "g:d:b:r:s:")) != -1)
+    {
+        switch (option)
+        {
+        case 'g': sizeList = optarg; break;
+        case 'd': densityList = optarg; break;
+        case 'b': benchmarkList = optarg; break;
+        case 'r': rounds = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 's': seed = strtoull(optarg, NULL, 10); break;
+        default: isValid = NO; break;
+        }
+    }
+
+    JbTableSize sizes[64];
+    unsigned numberOfSizes = ParseSizes(sizeList, sizes);
+    double densities[64];
+    unsigned numberOfDensities = ParseDensities(densityList, densities);
+    if (!isValid || optind != argc || rounds == 0 || rounds >= MaximumRounds
+        || numberOfSizes == 0 || numberOfDensities == 0)
+    {
+        PrintUsage(argv[0]);
+        [pool release];
+        return 1;
+    }
+
+    for (unsigned b = 0; b != NumberOfBenchmarks; ++b)
+    {
+        if (benchmarkList != NULL && !IsInList(Benchmarks[b].name, benchmarkList))
+            continue;
+        for (unsigned i = 0; i != numberOfSizes; ++i)
+        {
+            unsigned squares = sizes[i].rows * sizes[i].columns;
+            for (unsigned j = 0; j != numberOfDensities; ++j)
+            {
+                unsigned mines = (unsigned)(squares * densities[j] / 100 + 0.5);
+                if (mines + 9 < squares)
+                    RunBenchmark(&Benchmarks[b], sizes[i], mines, rounds, seed);
+            }
+        }
+    }
+
+    [pool release];
+    return 0;
+}
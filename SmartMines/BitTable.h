@@ -0,0 +1,103 @@
+//
+//  BitTable.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import <stdint.h>
+
+/// A two-dimensional table of bits.
+/** Each row starts on a new 64-bit word, and the bits past the last column
+    of a row are always 0. Column @a c of a row is bit (c % 64) of word
+    (c / 64), so shifting a word left moves its bits one column to the right.
+*/
+typedef struct JbBitTableStruct
+{
+    unsigned rows;
+    unsigned columns;
+    unsigned wordsPerRow;
+    uint64_t* words;
+} JbBitTable;
+
+/// Allocates a table of @a rows x @a columns bits that are all 0.
+/** @return NO if the memory couldn't be allocated.
+*/
+BOOL JbInitBitTable(JbBitTable* table, unsigned rows, unsigned columns);
+void JbFreeBitTable(JbBitTable* table);
+
+/// Sets every bit in the table to @a value.
+void JbFillBitTable(JbBitTable* table, BOOL value);
+
+/// Returns the number of bits in the table that are 1.
+size_t JbCountBits(const JbBitTable* table);
+
+/// Counts the neighbors of every square whose bit is 1.
+/** For each square, the number of the (up to) eight surrounding squares
+    whose bit is set in @a table is stored as a nibble in @a counts, which
+    must have room for table->rows * table->columns nibbles. The counts are
+    computed 64 squares at a time with bit-sliced adders over shifted rows.
+*/
+void JbCountNeighborBits(const JbBitTable* table, uint8_t* counts);
+
+static inline uint64_t* JbBitTableRow(const JbBitTable* table, unsigned row)
+{
+    return &table->words[(size_t)row * table->wordsPerRow];
+}
+
+static inline BOOL JbGetBit(const JbBitTable* table, unsigned row, unsigned column)
+{
+    return (JbBitTableRow(table, row)[column >> 6] >> (column & 63)) & 1;
+}
+
+static inline void JbSetBit(JbBitTable* table, unsigned row, unsigned column)
+{
+    JbBitTableRow(table, row)[column >> 6] |= (uint64_t)1 << (column & 63);
+}
+
+static inline void JbClearBit(JbBitTable* table, unsigned row, unsigned column)
+{
+    JbBitTableRow(table, row)[column >> 6] &= ~((uint64_t)1 << (column & 63));
+}
+
+/// Returns the number of bytes needed to store @a count nibbles.
+static inline size_t JbNibbleArraySize(size_t count)
+{
+    return (count + 1) / 2;
+}
+
+static inline unsigned JbGetNibble(const uint8_t* nibbles, size_t index)
+{
+    return (nibbles[index >> 1] >> ((index & 1) << 2)) & 0xF;
+}
+
+static inline void JbSetNibble(uint8_t* nibbles, size_t index, unsigned value)
+{
+    unsigned shift = (index & 1) << 2;
+    nibbles[index >> 1] = (uint8_t)((nibbles[index >> 1] & ~(0xF << shift))
+                                    | ((value & 0xF) << shift));
+}
@@ -0,0 +1,156 @@
+//
+//  BitTable.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "BitTable.h"
+#import <stdlib.h>
+#import <string.h>
+
+static inline void AddBits(uint64_t bits,
+                           uint64_t* sum0, uint64_t* sum1,
+                           uint64_t* sum2, uint64_t* sum3)
+{
+    uint64_t carry = *sum0 & bits;
+    *sum0 ^= bits;
+    bits = carry;
+    carry = *sum1 & bits;
+    *sum1 ^= bits;
+    bits = carry;
+    carry = *sum2 & bits;
+    *sum2 ^= bits;
+    *sum3 |= carry;
+}
+
+/// Returns word @a w of @a row, with each bit moved one column to the right.
+static inline uint64_t LeftNeighborBits(const uint64_t* row, unsigned w)
+{
+    return (row[w] << 1) | (w != 0 ? row[w - 1] >> 63 : 0);
+}
+
+/// Returns word @a w of @a row, with each bit moved one column to the left.
+static inline uint64_t RightNeighborBits(const uint64_t* row, unsigned w,
+                                         unsigned wordsPerRow)
+{
+    return (row[w] >> 1) | (w + 1 != wordsPerRow ? row[w + 1] << 63 : 0);
+}
+
+BOOL JbInitBitTable(JbBitTable* table, unsigned rows, unsigned columns)
+{
+    table->rows = rows;
+    table->columns = columns;
+    table->wordsPerRow = (columns + 63) / 64;
+    table->words = (uint64_t*)calloc((size_t)rows * table->wordsPerRow,
+                                     sizeof(uint64_t));
+    return table->words != NULL || rows == 0 || columns == 0;
+}
+
+void JbFreeBitTable(JbBitTable* table)
+{
+    if (table->words != NULL)
+        free(table->words);
+    table->words = NULL;
+    table->rows = table->columns = table->wordsPerRow = 0;
+}
+
+void JbFillBitTable(JbBitTable* table, BOOL value)
+{
+    size_t wordCount = (size_t)table->rows * table->wordsPerRow;
+    if (!value || wordCount == 0)
+    {
+        memset(table->words, 0, wordCount * sizeof(uint64_t));
+        return;
+    }
+
+    memset(table->words, 0xFF, wordCount * sizeof(uint64_t));
+    unsigned usedBits = table->columns & 63;
+    if (usedBits == 0)
+        return;
+    uint64_t mask = ((uint64_t)1 << usedBits) - 1;
+    for (unsigned row = 0; row != table->rows; ++row)
+        JbBitTableRow(table, row)[table->wordsPerRow - 1] &= mask;
+}
+
+size_t JbCountBits(const JbBitTable* table)
+{
+    size_t count = 0;
+    const uint64_t* end = table->words + (size_t)table->rows * table->wordsPerRow;
+    for (const uint64_t* it = table->words; it != end; ++it)
+        count += __builtin_popcountll(*it);
+    return count;
+}
+
+void JbCountNeighborBits(const JbBitTable* table, uint8_t* counts)
+{
+    unsigned wordsPerRow = table->wordsPerRow;
+    memset(counts, 0, JbNibbleArraySize((size_t)table->rows * table->columns));
+
+    for (unsigned row = 0; row != table->rows; ++row)
+    {
+        const uint64_t* above = row != 0 ? JbBitTableRow(table, row - 1) : NULL;
+        const uint64_t* middle = JbBitTableRow(table, row);
+        const uint64_t* below = row + 1 != table->rows ? JbBitTableRow(table, row + 1) : NULL;
+        size_t rowStart = (size_t)row * table->columns;
+
+        for (unsigned w = 0; w != wordsPerRow; ++w)
+        {
+            uint64_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+            if (above)
+            {
+                AddBits(LeftNeighborBits(above, w), &sum0, &sum1, &sum2, &sum3);
+                AddBits(above[w], &sum0, &sum1, &sum2, &sum3);
+                AddBits(RightNeighborBits(above, w, wordsPerRow), &sum0, &sum1, &sum2, &sum3);
+            }
+            AddBits(LeftNeighborBits(middle, w), &sum0, &sum1, &sum2, &sum3);
+            AddBits(RightNeighborBits(middle, w, wordsPerRow), &sum0, &sum1, &sum2, &sum3);
+            if (below)
+            {
+                AddBits(LeftNeighborBits(below, w), &sum0, &sum1, &sum2, &sum3);
+                AddBits(below[w], &sum0, &sum1, &sum2, &sum3);
+                AddBits(RightNeighborBits(below, w, wordsPerRow), &sum0, &sum1, &sum2, &sum3);
+            }
+
+            // The counts were cleared above, so only the squares with at
+            // least one neighbor need to be written.
+            uint64_t nonZero = sum0 | sum1 | sum2 | sum3;
+            unsigned columnsInWord = MIN(64, table->columns - w * 64);
+            if (columnsInWord != 64)
+                nonZero &= ((uint64_t)1 << columnsInWord) - 1;
+            while (nonZero != 0)
+            {
+                unsigned bit = __builtin_ctzll(nonZero);
+                nonZero &= nonZero - 1;
+                unsigned count = ((sum0 >> bit) & 1)
+                                 | ((sum1 >> bit) & 1) << 1
+                                 | ((sum2 >> bit) & 1) << 2
+                                 | ((sum3 >> bit) & 1) << 3;
+                JbSetNibble(counts, rowStart + w * 64 + bit, count);
+            }
+        }
+    }
+}
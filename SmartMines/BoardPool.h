@@ -0,0 +1,119 @@
+//
+//  BoardPool.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "Table.h"
+
+/// Minefields generated by a background thread before they are needed.
+/** The mines can't be placed before the first square has been uncovered,
+    and a minefield placed around one square is not a fair game when
+    another square is uncovered first: it has a second region without mines
+    around the square it was placed around. A pooled minefield is therefore
+    only handed out when the player uncovers the square it was placed
+    around. The pool places its minefields around the square the previous
+    game started at, or the middle square before the first game, as players
+    tend to start every game at the same square. When the player starts
+    somewhere else, the pool's minefields are discarded and it starts
+    generating minefields around the new square.
+
+    The pool holds at most capacity minefields, and the worker thread sleeps
+    while it is full. All the minefields are discarded when the settings
+    change, including the one the worker is busy with.
+
+    If JbNoGuessGenerator gives up on a no-guess minefield, the settings are
+    unlikely to ever succeed, and the worker sleeps until the settings or
+    the first square change.
+*/
+@interface JbBoardPool : NSObject
+{
+    NSCondition* mCondition;
+    JbTableSize mSize;
+    unsigned mNumberOfMines;
+    JbTableIndex mFirstSquare;
+    BOOL mUsesEasyStart;
+    BOOL mUsesNoGuessBoards;
+    unsigned mGeneration;
+    /// YES if the worker has given up on the current settings.
+    BOOL mHasFailed;
+    /// The seeds of the minefields that are ready.
+    uint64_t* mSeeds;
+    unsigned mNumberOfBoards;
+    unsigned mCapacity;
+    unsigned mNumberOfThreads;
+    BOOL mIsWorkerRunning;
+    BOOL mIsStopped;
+    unsigned long mNumberOfHits;
+    unsigned long mNumberOfMisses;
+}
+
+- (id)initWithCapacity:(unsigned)capacity;
+
+/// The maximum number of minefields in the pool.
+- (unsigned)capacity;
+/// The number of minefields that are ready.
+- (unsigned)numberOfBoards;
+
+/// The number of threads each no-guess minefield is searched for with
+/// (default 1, so the pool doesn't compete with the game for processors).
+- (unsigned)numberOfThreads;
+- (void)setNumberOfThreads:(unsigned)threads;
+
+/// Sets the kind of minefields to generate and starts the worker thread.
+/** If any of the settings differ from the current ones, the minefields in
+    the pool are discarded.
+*/
+- (void)setSize:(JbTableSize)size
+  numberOfMines:(unsigned)mines
+  usesEasyStart:(BOOL)usesEasyStart
+usesNoGuessBoards:(BOOL)usesNoGuessBoards;
+
+/// Stops the worker thread, which otherwise keeps the pool alive.
+- (void)stop;
+
+/// Removes a minefield with the given settings that was placed around
+/// @a firstSquare.
+/** If the pool has no such minefield and @a firstSquare isn't the square
+    its minefields are placed around, the minefields are discarded and new
+    ones are placed around @a firstSquare.
+    @return NO if the pool has no such minefield, otherwise YES with the
+    minefield's seed in @a seed.
+*/
+- (BOOL)takeBoardWithSize:(JbTableSize)size
+            numberOfMines:(unsigned)mines
+            usesEasyStart:(BOOL)usesEasyStart
+        usesNoGuessBoards:(BOOL)usesNoGuessBoards
+              firstSquare:(JbTableIndex)firstSquare
+                     seed:(uint64_t*)seed;
+
+/// The number of times takeBoardWithSize:... found a minefield.
+- (unsigned long)numberOfHits;
+/// The number of times takeBoardWithSize:... found none.
+- (unsigned long)numberOfMisses;
+@end
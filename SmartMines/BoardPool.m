@@ -0,0 +1,267 @@
+//
+//  BoardPool.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "BoardPool.h"
+#import <assert.h>
+#import <stdlib.h>
+#import <string.h>
+#import "NoGuessGenerator.h"
+#import "Random.h"
+
+@implementation JbBoardPool
+
+- (id)initWithCapacity:(unsigned)capacity
+{
+    self = [super init];
+    if (self)
+    {
+        mCondition = [[NSCondition alloc] init];
+        mSize = JbMakeTableSize(0, 0);
+        mNumberOfMines = 0;
+        mFirstSquare = JbMakeTableIndex(0, 0);
+        mUsesEasyStart = NO;
+        mUsesNoGuessBoards = NO;
+        mGeneration = 0;
+        mHasFailed = NO;
+        mSeeds = capacity != 0 ? malloc(capacity * sizeof(uint64_t)) : NULL;
+        NSAssert(capacity == 0 || mSeeds != NULL,
+                 @"Unable to allocate memory for the board pool");
+        mNumberOfBoards = 0;
+        mCapacity = capacity;
+        mNumberOfThreads = 1;
+        mIsWorkerRunning = NO;
+        mIsStopped = NO;
+        mNumberOfHits = 0;
+        mNumberOfMisses = 0;
+    }
+    return self;
+}
+
+/// Discards the minefields in the pool and the one the worker is busy with.
+- (void)discardBoards
+{
+    mNumberOfBoards = 0;
+    ++mGeneration;
+    mHasFailed = NO;
+}
+
+- (void)dealloc
+{
+    free(mSeeds);
+    [mCondition release];
+    [super dealloc];
+}
+
+- (unsigned)capacity
+{
+    return mCapacity;
+}
+
+- (unsigned)numberOfBoards
+{
+    [mCondition lock];
+    unsigned count = mNumberOfBoards;
+    [mCondition unlock];
+    return count;
+}
+
+- (unsigned)numberOfThreads
+{
+    return mNumberOfThreads;
+}
+
+- (void)setNumberOfThreads:(unsigned)threads
+{
+    assert(threads != 0);
+    mNumberOfThreads = threads;
+}
+
+/// Finds the seed of a minefield with the given settings.
+/** @return NO if no minefield without guessing was found.
+*/
+- (BOOL)generateSeed:(uint64_t*)seed
+            withSize:(JbTableSize)size
+       numberOfMines:(unsigned)mines
+       usesEasyStart:(BOOL)usesEasyStart
+   usesNoGuessBoards:(BOOL)usesNoGuessBoards
+         firstSquare:(JbTableIndex)firstSquare
+              random:(JbRandom*)random
+{
+    *seed = JbNextRandom(random);
+    if (!usesNoGuessBoards)
+        return YES;
+
+    JbNoGuessGenerator* generator = [[JbNoGuessGenerator alloc] initWithSize:size
+                                                               numberOfMines:mines
+                                                               usesEasyStart:usesEasyStart
+                                                                 firstSquare:firstSquare
+                                                                    baseSeed:*seed];
+    [generator setNumberOfThreads:mNumberOfThreads];
+    BOOL isFound = [generator run];
+    *seed = [generator seed];
+    [generator release];
+    return isFound;
+}
+
+/// The body of the worker thread.
+- (void)runWorker:(id)unused
+{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    JbRandom random;
+    JbSeedRandom(&random, JbMakeRandomSeed());
+
+    [mCondition lock];
+    while (!mIsStopped)
+    {
+        if (mNumberOfBoards == mCapacity || mHasFailed)
+        {
+            [mCondition wait];
+            continue;
+        }
+
+        unsigned generation = mGeneration;
+        JbTableSize size = mSize;
+        unsigned mines = mNumberOfMines;
+        BOOL usesEasyStart = mUsesEasyStart;
+        BOOL usesNoGuessBoards = mUsesNoGuessBoards;
+        JbTableIndex firstSquare = mFirstSquare;
+        [mCondition unlock];
+
+        uint64_t seed;
+        NSAutoreleasePool* boardPool = [[NSAutoreleasePool alloc] init];
+        BOOL isGenerated = [self generateSeed:&seed
+                                     withSize:size
+                                numberOfMines:mines
+                                usesEasyStart:usesEasyStart
+                            usesNoGuessBoards:usesNoGuessBoards
+                                  firstSquare:firstSquare
+                                       random:&random];
+        [boardPool release];
+
+        [mCondition lock];
+        if (generation != mGeneration)
+            continue;
+        if (!isGenerated)
+            mHasFailed = YES;
+        else if (mNumberOfBoards != mCapacity)
+            mSeeds[mNumberOfBoards++] = seed;
+    }
+    mIsWorkerRunning = NO;
+    [mCondition unlock];
+    [pool release];
+}
+
+- (void)setSize:(JbTableSize)size
+  numberOfMines:(unsigned)mines
+  usesEasyStart:(BOOL)usesEasyStart
+usesNoGuessBoards:(BOOL)usesNoGuessBoards
+{
+    assert(size.rows != 0 && size.columns != 0);
+    [mCondition lock];
+    if (!JbEqualTableSizes(size, mSize)
+        || mines != mNumberOfMines
+        || usesEasyStart != mUsesEasyStart
+        || usesNoGuessBoards != mUsesNoGuessBoards)
+    {
+        [self discardBoards];
+        if (!JbEqualTableSizes(size, mSize))
+            mFirstSquare = JbMakeTableIndex(size.rows / 2, size.columns / 2);
+        mSize = size;
+        mNumberOfMines = mines;
+        mUsesEasyStart = usesEasyStart;
+        mUsesNoGuessBoards = usesNoGuessBoards;
+    }
+    if (!mIsWorkerRunning && !mIsStopped && mCapacity != 0)
+    {
+        // The thread retains the pool until it is stopped.
+        mIsWorkerRunning = YES;
+        [NSThread detachNewThreadSelector:@selector(runWorker:)
+                                 toTarget:self
+                               withObject:nil];
+    }
+    [mCondition signal];
+    [mCondition unlock];
+}
+
+- (void)stop
+{
+    [mCondition lock];
+    mIsStopped = YES;
+    [mCondition signal];
+    [mCondition unlock];
+}
+
+- (BOOL)takeBoardWithSize:(JbTableSize)size
+            numberOfMines:(unsigned)mines
+            usesEasyStart:(BOOL)usesEasyStart
+        usesNoGuessBoards:(BOOL)usesNoGuessBoards
+              firstSquare:(JbTableIndex)firstSquare
+                     seed:(uint64_t*)seed
+{
+    [mCondition lock];
+    BOOL isFound = NO;
+    if (JbEqualTableSizes(size, mSize)
+        && mines == mNumberOfMines
+        && usesEasyStart == mUsesEasyStart
+        && usesNoGuessBoards == mUsesNoGuessBoards)
+    {
+        if (!JbEqualTableIndexes(firstSquare, mFirstSquare))
+        {
+            [self discardBoards];
+            mFirstSquare = firstSquare;
+        }
+        else if (mNumberOfBoards != 0)
+        {
+            *seed = mSeeds[0];
+            memmove(mSeeds, mSeeds + 1, (mNumberOfBoards - 1) * sizeof(uint64_t));
+            --mNumberOfBoards;
+            isFound = YES;
+        }
+        [mCondition signal];
+    }
+    if (isFound)
+        ++mNumberOfHits;
+    else
+        ++mNumberOfMisses;
+    [mCondition unlock];
+    return isFound;
+}
+
+- (unsigned long)numberOfHits
+{
+    return mNumberOfHits;
+}
+
+- (unsigned long)numberOfMisses
+{
+    return mNumberOfMisses;
+}
+
+@end
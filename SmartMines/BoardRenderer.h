@@ -0,0 +1,114 @@
+//
+//  BoardRenderer.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "Table.h"
+
+@class JbMinefield;
+
+/// Where the squares go when a minefield is drawn in a view.
+typedef struct JbBoardLayoutStruct
+{
+    float squareSize;
+    float horizontalOffset;
+    float verticalOffset;
+} JbBoardLayout;
+
+/// The largest whole number of pixels a square can have if the minefield
+/// is to fit in a view of @a viewSize.
+float JbSquareSizeForViewSize(NSSize viewSize, JbTableSize minefieldSize);
+
+/// Centers the minefield in a view of @a viewSize.
+/** Squares are a whole number of pixels, unless that would make them
+    smaller than @a minimumWholeSquareSize. Smaller squares are stretched
+    so that the minefield fills the view.
+*/
+JbBoardLayout JbMakeBoardLayout(NSSize viewSize,
+                                JbTableSize minefieldSize,
+                                float minimumWholeSquareSize);
+
+/// The thickness of a raised square's frame.
+float JbFrameThicknessForSquareSize(float squareSize);
+
+/// Scales an image of @a imageSize to fit inside a square's frame, and
+/// centers it. The rectangle is relative to the square's corner.
+NSRect JbFitImageInSquare(NSSize imageSize, float squareSize, float frameThickness);
+
+/// Draws minefields into an RGBA pixel buffer without AppKit.
+/** Every combination of frame and symbol is rasterized into a tile once,
+    when the renderer is created, with the symbols drawn from small built-in
+    bitmap glyphs. Rendering a minefield then copies one tile row at a time
+    with memcpy, a full square row of the image per pass over the row's
+    squares.
+
+    The minefield's first row is at the bottom of the image, as in
+    JbMinefieldView. When the game is over, the mines that weren't found
+    and the incorrect marks are shown the way the game shows them.
+*/
+@interface JbBoardRenderer : NSObject
+{
+    unsigned mSquareSize;
+    unsigned mFrameThickness;
+    uint8_t* mTiles;
+    uint8_t* mPixels;
+    size_t mPixelsCapacity;
+    unsigned mWidth;
+    unsigned mHeight;
+    uint8_t* mRowTiles;
+    void* mRowSquares;
+    size_t mRowCapacity;
+}
+
+/// Creates a renderer that draws squares of @a squareSize x @a squareSize
+/// pixels. @a squareSize must be at least 1.
+- (id)initWithSquareSize:(unsigned)squareSize;
+
+- (unsigned)squareSize;
+
+/// Draws @a minefield into the pixel buffer, which is resized to fit it.
+- (void)renderMinefield:(JbMinefield*)minefield;
+
+/// The pixels of the last rendered minefield: four bytes per pixel in
+/// RGBA order, row by row from the top, without padding.
+- (const uint8_t*)pixels;
+- (unsigned)width;
+- (unsigned)height;
+
+/// Writes the last rendered minefield to @a path as a binary PPM (P6).
+/** @return NO if the file couldn't be written.
+*/
+- (BOOL)writePPMToFile:(NSString*)path;
+
+/// Writes the last rendered minefield to @a path as an RGBA PNG.
+/** The image data is stored without compression, so no zlib is needed.
+    @return NO if the file couldn't be written.
+*/
+- (BOOL)writePNGToFile:(NSString*)path;
+@end
@@ -0,0 +1,532 @@
+//
+//  BoardRenderer.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "BoardRenderer.h"
+#import <assert.h>
+#import <math.h>
+#import <stdio.h>
+#import <stdlib.h>
+#import <string.h>
+#import "Minefield.h"
+
+/// The tiles, in the same order as JbMinefieldSymbol. The lowered tiles
+/// follow the raised ones.
+enum
+{
+    EmptyTile = 0,
+    ExplosionTile = 9,
+    MarkTile,
+    QuestionMarkTile,
+    MarkedMineTile,
+    QuestionMarkedMineTile,
+    UnmarkedMineTile,
+    IncorrectMarkTile,
+    IncorrectQuestionMarkTile,
+    NumberOfSymbolTiles,
+    LoweredTiles = NumberOfSymbolTiles,
+    NumberOfTiles = 2 * NumberOfSymbolTiles
+};
+
+enum {GlyphHeight = 7};
+
+static const char* const DigitGlyphs[9][GlyphHeight] =
+{
+    {".###.", "#...#", "....#", "...#.", "..#..", ".....", "..#.."},
+    {"..#..", ".##..", "..#..", "..#..", "..#..", "..#..", ".###."},
+    {".###.", "#...#", "....#", "...#.", "..#..", ".#...", "#####"},
+    {".###.", "#...#", "....#", "..##.", "....#", "#...#", ".###."},
+    {"...#.", "..##.", ".#.#.", "#..#.", "#####", "...#.", "...#."},
+    {"#####", "#....", "####.", "....#", "....#", "#...#", ".###."},
+    {"..##.", ".#...", "#....", "####.", "#...#", "#...#", ".###."},
+    {"#####", "....#", "...#.", "..#..", ".#...", ".#...", ".#..."},
+    {".###.", "#...#", "#...#", ".###.", "#...#", "#...#", ".###."}
+};
+
+static const char* const FlagGlyph[GlyphHeight] =
+{
+    ".##....", ".####..", ".#####.", ".####..", ".##....", ".#.....", "####..."
+};
+
+static const char* const MineGlyph[GlyphHeight] =
+{
+    "...#...", ".#####.", ".#.###.", "#######", ".#####.", ".#####.", "...#..."
+};
+
+/// The colors of the numbers, the same as in JbMinefieldView.
+static const uint8_t NumberColors[9][3] =
+{
+    {0, 0, 0},
+    {85, 85, 85},
+    {153, 102, 51},
+    {128, 0, 128},
+    {255, 0, 255},
+    {255, 255, 0},
+    {255, 128, 0},
+    {255, 0, 0},
+    {0, 0, 255}
+};
+
+static const uint8_t BackgroundColor[3] = {192, 192, 192};
+static const uint8_t LightFrameColor[3] = {224, 224, 224};
+static const uint8_t DarkFrameColor[3] = {96, 96, 96};
+static const uint8_t LoweredFrameColor[3] = {128, 128, 128};
+static const uint8_t ErrorColor[3] = {207, 144, 144};
+static const uint8_t BlackColor[3] = {0, 0, 0};
+static const uint8_t FlagColor[3] = {200, 0, 0};
+static const uint8_t TransparentMineColor[3] = {112, 112, 112};
+
+float JbSquareSizeForViewSize(NSSize viewSize, JbTableSize minefieldSize)
+{
+    float maxSquareHeight = viewSize.height / minefieldSize.rows;
+    float maxSquareWidth = viewSize.width / minefieldSize.columns;
+    return floor(MIN(maxSquareHeight, maxSquareWidth));
+}
+
+JbBoardLayout JbMakeBoardLayout(NSSize viewSize,
+                                JbTableSize minefieldSize,
+                                float minimumWholeSquareSize)
+{
+    JbBoardLayout layout;
+    layout.squareSize = JbSquareSizeForViewSize(viewSize, minefieldSize);
+    if (layout.squareSize < minimumWholeSquareSize)
+        layout.squareSize = MIN(viewSize.width / minefieldSize.columns,
+                                viewSize.height / minefieldSize.rows);
+    layout.horizontalOffset = floor((viewSize.width
+                                     - minefieldSize.columns * layout.squareSize) / 2.0);
+    layout.verticalOffset = floor((viewSize.height
+                                   - minefieldSize.rows * layout.squareSize) / 2.0);
+    return layout;
+}
+
+float JbFrameThicknessForSquareSize(float squareSize)
+{
+    return ceil(squareSize / 25.0);
+}
+
+NSRect JbFitImageInSquare(NSSize imageSize, float squareSize, float frameThickness)
+{
+    float imgMaxDim = MAX(imageSize.width, imageSize.height);
+    float imgSquareSize = squareSize - 2 * frameThickness;
+    imageSize = NSMakeSize(imgSquareSize * imageSize.width / imgMaxDim,
+                           imgSquareSize * imageSize.height / imgMaxDim);
+    return NSMakeRect((squareSize - imageSize.width) / 2,
+                      (squareSize - imageSize.height) / 2,
+                      imageSize.width,
+                      imageSize.height);
+}
+
+static void FillRect(uint8_t* tile, unsigned squareSize,
+                     unsigned x, unsigned y, unsigned width, unsigned height,
+                     const uint8_t color[3])
+{
+    for (unsigned row = y; row != y + height; ++row)
+    {
+        uint8_t* pixel = tile + ((size_t)row * squareSize + x) * 4;
+        for (unsigned col = 0; col != width; ++col, pixel += 4)
+        {
+            pixel[0] = color[0];
+            pixel[1] = color[1];
+            pixel[2] = color[2];
+            pixel[3] = 255;
+        }
+    }
+}
+
+/// Draws a glyph centered in the square, scaled by a whole number so that
+/// it fills about two thirds of the square's height.
+static void DrawGlyph(uint8_t* tile, unsigned squareSize, unsigned frameThickness,
+                      const char* const glyph[GlyphHeight], const uint8_t color[3])
+{
+    unsigned inner = squareSize - 2 * frameThickness;
+    unsigned scale = inner * 2 / (3 * GlyphHeight);
+    if (scale == 0)
+    {
+        if (inner < GlyphHeight)
+            return;
+        scale = 1;
+    }
+    unsigned glyphWidth = (unsigned)strlen(glyph[0]);
+    unsigned x = (squareSize - glyphWidth * scale) / 2;
+    unsigned y = (squareSize - GlyphHeight * scale) / 2;
+    for (unsigned row = 0; row != GlyphHeight; ++row)
+    {
+        for (unsigned col = 0; col != glyphWidth; ++col)
+        {
+            if (glyph[row][col] == '#')
+                FillRect(tile, squareSize, x + col * scale, y + row * scale,
+                         scale, scale, color);
+        }
+    }
+}
+
+static void DrawTile(uint8_t* tile, unsigned squareSize, unsigned frameThickness,
+                     unsigned symbol, BOOL isLowered)
+{
+    FillRect(tile, squareSize, 0, 0, squareSize, squareSize, BackgroundColor);
+    if (isLowered)
+    {
+        FillRect(tile, squareSize, 0, 0, squareSize, 1, LoweredFrameColor);
+        FillRect(tile, squareSize, 0, 0, 1, squareSize, LoweredFrameColor);
+    }
+    else
+    {
+        unsigned t = MIN(frameThickness, squareSize / 2);
+        FillRect(tile, squareSize, 0, 0, squareSize, t, LightFrameColor);
+        FillRect(tile, squareSize, 0, 0, t, squareSize, LightFrameColor);
+        FillRect(tile, squareSize, 0, squareSize - t, squareSize, t, DarkFrameColor);
+        FillRect(tile, squareSize, squareSize - t, 0, t, squareSize, DarkFrameColor);
+    }
+
+    unsigned inner = squareSize > 2 * frameThickness ? squareSize - 2 * frameThickness : 0;
+    if (symbol == ExplosionTile || symbol == IncorrectMarkTile
+        || symbol == IncorrectQuestionMarkTile)
+        FillRect(tile, squareSize, frameThickness, frameThickness, inner, inner, ErrorColor);
+    if (inner == 0)
+        return;
+
+    if (symbol >= 1 && symbol <= 8)
+        DrawGlyph(tile, squareSize, frameThickness, DigitGlyphs[symbol], NumberColors[symbol]);
+    else if (symbol == ExplosionTile)
+        DrawGlyph(tile, squareSize, frameThickness, MineGlyph, BlackColor);
+    else if (symbol == MarkedMineTile || symbol == QuestionMarkedMineTile
+             || symbol == UnmarkedMineTile)
+        DrawGlyph(tile, squareSize, frameThickness, MineGlyph, TransparentMineColor);
+
+    if (symbol == MarkTile || symbol == MarkedMineTile || symbol == IncorrectMarkTile)
+        DrawGlyph(tile, squareSize, frameThickness, FlagGlyph, FlagColor);
+    else if (symbol == QuestionMarkTile || symbol == QuestionMarkedMineTile
+             || symbol == IncorrectQuestionMarkTile)
+        DrawGlyph(tile, squareSize, frameThickness, DigitGlyphs[0], BlackColor);
+}
+
+static unsigned TileForSquare(const JbMinefieldSquare* square, BOOL isGameOver)
+{
+    switch (square->state)
+    {
+    case JbUncovered:
+        return LoweredTiles + (square->hasMine ? ExplosionTile : square->minedNeighbors);
+    case JbMarked:
+        return isGameOver && !square->hasMine ? IncorrectMarkTile : MarkTile;
+    case JbQuestionMarked:
+        if (!isGameOver)
+            return QuestionMarkTile;
+        return square->hasMine ? QuestionMarkedMineTile : IncorrectQuestionMarkTile;
+    default:
+        return isGameOver && square->hasMine ? UnmarkedMineTile : EmptyTile;
+    }
+}
+
+/// The CRC-32 of every byte value, with the polynomial PNG uses
+/// (0xEDB88320). It is a constant so renderers on different threads can
+/// share it.
+static const uint32_t Crc32Table[256] =
+{
+    0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F,
+    0xE963A535, 0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988,
+    0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91, 0x1DB71064, 0x6AB020F2,
+    0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+    0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9,
+    0xFA0F3D63, 0x8D080DF5, 0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172,
+    0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B, 0x35B5A8FA, 0x42B2986C,
+    0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+    0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423,
+    0xCFBA9599, 0xB8BDA50F, 0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924,
+    0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D, 0x76DC4190, 0x01DB7106,
+    0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+    0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D,
+    0x91646C97, 0xE6635C01, 0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E,
+    0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457, 0x65B0D9C6, 0x12B7E950,
+    0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+    0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7,
+    0xA4D1C46D, 0xD3D6F4FB, 0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0,
+    0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9, 0x5005713C, 0x270241AA,
+    0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+    0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81,
+    0xB7BD5C3B, 0xC0BA6CAD, 0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A,
+    0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683, 0xE3630B12, 0x94643B84,
+    0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+    0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB,
+    0x196C3671, 0x6E6B06E7, 0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC,
+    0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5, 0xD6D6A3E8, 0xA1D1937E,
+    0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+    0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55,
+    0x316E8EEF, 0x4669BE79, 0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236,
+    0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F, 0xC5BA3BBE, 0xB2BD0B28,
+    0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+    0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F,
+    0x72076785, 0x05005713, 0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38,
+    0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21, 0x86D3D2D4, 0xF1D4E242,
+    0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+    0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69,
+    0x616BFFD3, 0x166CCF45, 0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2,
+    0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB, 0xAED16A4A, 0xD9D65ADC,
+    0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+    0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693,
+    0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94,
+    0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+};
+
+static uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t length)
+{
+    crc = ~crc;
+    for (size_t i = 0; i != length; ++i)
+        crc = Crc32Table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PutUInt32(uint8_t* bytes, uint32_t value)
+{
+    bytes[0] = (uint8_t)(value >> 24);
+    bytes[1] = (uint8_t)(value >> 16);
+    bytes[2] = (uint8_t)(value >> 8);
+    bytes[3] = (uint8_t)value;
+}
+
+static BOOL WritePngChunk(FILE* file, const char type[4],
+                          const uint8_t* data, uint32_t length)
+{
+    uint8_t header[8];
+    PutUInt32(header, length);
+    memcpy(header + 4, type, 4);
+    uint32_t crc = Crc32(Crc32(0, header + 4, 4), data, length);
+    uint8_t trailer[4];
+    PutUInt32(trailer, crc);
+    return fwrite(header, 1, 8, file) == 8
+           && (length == 0 || fwrite(data, 1, length, file) == length)
+           && fwrite(trailer, 1, 4, file) == 4;
+}
+
+/// The image data of a PNG, written as a zlib stream of stored (not
+/// compressed) deflate blocks, one IDAT chunk per block.
+typedef struct
+{
+    FILE* file;
+    uint8_t block[5 + 65535];
+    size_t count;
+    uint32_t adlerA;
+    uint32_t adlerB;
+    BOOL isOk;
+} PngDataWriter;
+
+static void FlushPngBlock(PngDataWriter* writer, BOOL isFinal)
+{
+    uint16_t length = (uint16_t)writer->count;
+    writer->block[0] = isFinal ? 1 : 0;
+    writer->block[1] = (uint8_t)length;
+    writer->block[2] = (uint8_t)(length >> 8);
+    writer->block[3] = (uint8_t)~length;
+    writer->block[4] = (uint8_t)(~length >> 8);
+    writer->isOk = writer->isOk
+                   && WritePngChunk(writer->file, "IDAT", writer->block,
+                                    (uint32_t)(5 + writer->count));
+    writer->count = 0;
+}
+
+static void WritePngData(PngDataWriter* writer, const uint8_t* data, size_t length)
+{
+    for (size_t i = 0; i != length; ++i)
+    {
+        writer->adlerA = (writer->adlerA + data[i]) % 65521;
+        writer->adlerB = (writer->adlerB + writer->adlerA) % 65521;
+    }
+    while (length != 0)
+    {
+        size_t n = MIN(length, 65535 - writer->count);
+        memcpy(writer->block + 5 + writer->count, data, n);
+        writer->count += n;
+        data += n;
+        length -= n;
+        if (writer->count == 65535)
+            FlushPngBlock(writer, NO);
+    }
+}
+
+@implementation JbBoardRenderer
+
+- (id)initWithSquareSize:(unsigned)squareSize
+{
+    assert(squareSize != 0);
+    self = [super init];
+    if (self)
+    {
+        mSquareSize = squareSize;
+        mFrameThickness = (unsigned)JbFrameThicknessForSquareSize(squareSize);
+        size_t tileBytes = (size_t)squareSize * squareSize * 4;
+        mTiles = malloc(NumberOfTiles * tileBytes);
+        NSAssert(mTiles != NULL, @"Unable to allocate memory for the tiles");
+        for (unsigned k = 0; k != NumberOfTiles; ++k)
+            DrawTile(mTiles + k * tileBytes, squareSize, mFrameThickness,
+                     k % NumberOfSymbolTiles, k >= LoweredTiles);
+        mPixels = NULL;
+        mPixelsCapacity = 0;
+        mWidth = 0;
+        mHeight = 0;
+        mRowTiles = NULL;
+        mRowSquares = NULL;
+        mRowCapacity = 0;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(mTiles);
+    free(mPixels);
+    free(mRowTiles);
+    free(mRowSquares);
+    [super dealloc];
+}
+
+- (unsigned)squareSize
+{
+    return mSquareSize;
+}
+
+- (void)renderMinefield:(JbMinefield*)minefield
+{
+    JbTableSize size = [minefield size];
+    mWidth = size.columns * mSquareSize;
+    mHeight = size.rows * mSquareSize;
+    size_t rowBytes = (size_t)mWidth * 4;
+    if (rowBytes * mHeight > mPixelsCapacity)
+    {
+        free(mPixels);
+        mPixelsCapacity = rowBytes * mHeight;
+        mPixels = malloc(mPixelsCapacity);
+        NSAssert(mPixels != NULL, @"Unable to allocate memory for the image");
+    }
+    if (size.columns > mRowCapacity)
+    {
+        free(mRowTiles);
+        free(mRowSquares);
+        mRowCapacity = size.columns;
+        mRowTiles = malloc(mRowCapacity);
+        mRowSquares = malloc(mRowCapacity * sizeof(JbMinefieldSquare));
+        NSAssert(mRowTiles != NULL && mRowSquares != NULL,
+                 @"Unable to allocate memory for the image");
+    }
+
+    JbMinefieldState state = [minefield state];
+    BOOL isGameOver = state == JbCompleted || state == JbBlownUp;
+    JbMinefieldSquare* squares = (JbMinefieldSquare*)mRowSquares;
+    size_t tileRowBytes = (size_t)mSquareSize * 4;
+    size_t tileBytes = tileRowBytes * mSquareSize;
+    for (unsigned row = 0; row != size.rows; ++row)
+    {
+        [minefield getSquares:squares inSpan:JbMakeTableSpan(row, 0, size.columns)];
+        for (unsigned col = 0; col != size.columns; ++col)
+            mRowTiles[col] = (uint8_t)TileForSquare(&squares[col], isGameOver);
+
+        uint8_t* dst = mPixels + (size_t)(size.rows - 1 - row) * mSquareSize * rowBytes;
+        for (unsigned y = 0; y != mSquareSize; ++y, dst += rowBytes)
+        {
+            const uint8_t* tileRows = mTiles + y * tileRowBytes;
+            uint8_t* out = dst;
+            for (unsigned col = 0; col != size.columns; ++col, out += tileRowBytes)
+                memcpy(out, tileRows + mRowTiles[col] * tileBytes, tileRowBytes);
+        }
+    }
+}
+
+- (const uint8_t*)pixels
+{
+    return mPixels;
+}
+
+- (unsigned)width
+{
+    return mWidth;
+}
+
+- (unsigned)height
+{
+    return mHeight;
+}
+
+- (BOOL)writePPMToFile:(NSString*)path
+{
+    FILE* file = fopen([path fileSystemRepresentation], "wb");
+    if (file == NULL)
+        return NO;
+
+    BOOL isOk = fprintf(file, "P6\n%u %u\n255\n", mWidth, mHeight) > 0;
+    uint8_t* row = malloc((size_t)mWidth * 3 + 1);
+    for (unsigned y = 0; isOk && y != mHeight; ++y)
+    {
+        const uint8_t* pixel = mPixels + (size_t)y * mWidth * 4;
+        for (unsigned x = 0; x != mWidth; ++x, pixel += 4)
+            memcpy(row + x * 3, pixel, 3);
+        isOk = fwrite(row, 3, mWidth, file) == mWidth;
+    }
+    free(row);
+    return fclose(file) == 0 && isOk;
+}
+
+- (BOOL)writePNGToFile:(NSString*)path
+{
+    FILE* file = fopen([path fileSystemRepresentation], "wb");
+    if (file == NULL)
+        return NO;
+
+    static const uint8_t signature[8] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+    uint8_t header[13];
+    PutUInt32(header, mWidth);
+    PutUInt32(header + 4, mHeight);
+    header[8] = 8;  // Bits per sample.
+    header[9] = 6;  // RGBA.
+    header[10] = header[11] = header[12] = 0;
+    static const uint8_t zlibHeader[2] = {0x78, 0x01};
+    BOOL isOk = fwrite(signature, 1, 8, file) == 8
+                && WritePngChunk(file, "IHDR", header, 13)
+                && WritePngChunk(file, "IDAT", zlibHeader, 2);
+
+    PngDataWriter* writer = malloc(sizeof(PngDataWriter));
+    writer->file = file;
+    writer->count = 0;
+    writer->adlerA = 1;
+    writer->adlerB = 0;
+    writer->isOk = isOk;
+    static const uint8_t noFilter = 0;
+    for (unsigned y = 0; writer->isOk && y != mHeight; ++y)
+    {
+        WritePngData(writer, &noFilter, 1);
+        WritePngData(writer, mPixels + (size_t)y * mWidth * 4, (size_t)mWidth * 4);
+    }
+    FlushPngBlock(writer, YES);
+    uint8_t adler[4];
+    PutUInt32(adler, (writer->adlerB << 16) | writer->adlerA);
+    isOk = writer->isOk
+           && WritePngChunk(file, "IDAT", adler, 4)
+           && WritePngChunk(file, "IEND", NULL, 0);
+    free(writer);
+    return fclose(file) == 0 && isOk;
+}
+
+@end
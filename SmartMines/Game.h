@@ -28,7 +28,7 @@
 //  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 //  OTHER DEALINGS IN THE SOFTWARE.
 
-#import <Cocoa/Cocoa.h>
+#import <Foundation/Foundation.h>
 #import "HighScores.h"
 #import "Table.h"
 
@@ -43,6 +43,7 @@
     unsigned mTimesWon;
     unsigned mTimesLost;
     BOOL mIsCustomGame;
+    BOOL mUsesNoGuessBoards;
 }
 + (NSString*)describeGameWithSize:(JbTableSize)size mines:(unsigned)mines;
 + (BOOL)isValidGameSize:(JbTableSize)size mines:(unsigned)mines;
@@ -71,4 +72,7 @@
 - (unsigned)timesLost;
 - (BOOL)isCustomGame;
 - (void)setCustomGame:(BOOL)newCustomGame;
+/// True if the game's minefields can always be solved without guessing.
+- (BOOL)usesNoGuessBoards;
+- (void)setUsesNoGuessBoards:(BOOL)newUsesNoGuessBoards;
 @end
@@ -40,6 +40,8 @@ static NSString* TimesPlayedKey = @"TimesPlayed";
 static NSString* TimesWonKey = @"TimesWon";
 static NSString* TimesLostKey = @"TimesLost";
 static NSString* IsCustomGameKey = @"IsCustomGame";
+static NSString* UsesNoGuessBoardsKey = @"UsesNoGuessBoards";
+enum {MinRowsOrColumns = 5, MaxRowsOrColumns = 2000};
 
 
 static BOOL ParseMinefieldSize(NSString* description,
@@ -55,8 +57,8 @@ static BOOL ParseMinefieldSize(NSString* description,
 
 + (BOOL)isValidGameSize:(JbTableSize)size mines:(unsigned)mines
 {
-    return size.rows >= 5 && size.rows < 100
-           && size.columns >= 5 && size.columns < 100
+    return size.rows >= MinRowsOrColumns && size.rows <= MaxRowsOrColumns
+           && size.columns >= MinRowsOrColumns && size.columns <= MaxRowsOrColumns
            && mines <= (size.rows * size.columns) / 2;
 }
 
@@ -91,6 +93,7 @@ static BOOL ParseMinefieldSize(NSString* description,
         mTimesWon = 0;
         mTimesLost = 0;
         mIsCustomGame = YES;
+        mUsesNoGuessBoards = NO;
     }
     return self;
 }
@@ -119,6 +122,7 @@ static BOOL ParseMinefieldSize(NSString* description,
         mTimesWon = [coder decodeInt32ForKey:TimesWonKey];
         mTimesLost = [coder decodeInt32ForKey:TimesLostKey];
         mIsCustomGame = [coder decodeBoolForKey:IsCustomGameKey];
+        mUsesNoGuessBoards = [coder decodeBoolForKey:UsesNoGuessBoardsKey];
     }
     return self;
 }
@@ -143,6 +147,7 @@ static BOOL ParseMinefieldSize(NSString* description,
     [coder encodeInt32:mTimesWon forKey:TimesWonKey];
     [coder encodeInt32:mTimesLost forKey:TimesLostKey];
     [coder encodeBool:mIsCustomGame forKey:IsCustomGameKey];
+    [coder encodeBool:mUsesNoGuessBoards forKey:UsesNoGuessBoardsKey];
 }
 
 - (BOOL)isPlayedMoreRecentlyThan:(JbGame*)game
@@ -241,6 +246,16 @@ static BOOL ParseMinefieldSize(NSString* description,
     mIsCustomGame = newIsCustomGame;
 }
 
+- (BOOL)usesNoGuessBoards
+{
+    return mUsesNoGuessBoards;
+}
+
+- (void)setUsesNoGuessBoards:(BOOL)newUsesNoGuessBoards
+{
+    mUsesNoGuessBoards = newUsesNoGuessBoards;
+}
+
 @end
 
 BOOL ParseMinefieldSize(NSString* description,
@@ -34,12 +34,16 @@
 extern NSString* JbBeginnerGame;
 extern NSString* JbIntermediateGame;
 extern NSString* JbExpertGame;
+/// The user default new games take their no-guess setting from.
+extern NSString* JbNoGuessBoardsKey;
 
 @interface JbGameCollection : NSObject  <NSCoding>
 {
     NSMutableDictionary* mGames;
 }
 + (JbGameCollection*)defaultGameCollection;
+/// The file the game in progress is saved to when the application quits.
++ (NSString*)savedGamePath;
 - (NSArray*)games;
 - (void)addGame:(JbGame*)game;
 - (JbGame*)beginnerGame;
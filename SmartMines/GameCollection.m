@@ -32,11 +32,13 @@
 
 static NSString* ApplicationName = @"SmartMines";
 static NSString* DefaultFileName = @"SmartMines.plist";
+static NSString* SavedGameFileName = @"SavedGame.minefield";
 static NSString* GamesKey = @"Games";
 
 NSString* JbBeginnerGame = @"9x9x10";
 NSString* JbIntermediateGame = @"16x16x40";
 NSString* JbExpertGame = @"16x30x99";
+NSString* JbNoGuessBoardsKey = @"NoGuessBoards";
 
 NSString* JbPathForUserApplicationSupport(NSString* applicationName)
 {
@@ -64,6 +66,12 @@ NSString* JbPathForUserApplicationSupport(NSString* applicationName)
     return [NSString stringWithFormat:@"%@/%@", appSuppPath, DefaultFileName];
 }
 
++ (NSString*)savedGamePath
+{
+    NSString* appSuppPath = JbPathForUserApplicationSupport(ApplicationName);
+    return [NSString stringWithFormat:@"%@/%@", appSuppPath, SavedGameFileName];
+}
+
 + (JbGameCollection*)defaultGameCollection
 {
     NSString* fileName = [JbGameCollection defaultGameCollectionPath];
@@ -148,6 +156,8 @@ NSString* JbPathForUserApplicationSupport(NSString* applicationName)
         return game;
 
     game = [[[JbGame alloc] initWithDescription:description] autorelease];
+    NSUserDefaults* ud = [NSUserDefaults standardUserDefaults];
+    [game setUsesNoGuessBoards:[[ud valueForKey:JbNoGuessBoardsKey] boolValue]];
     [self addGame:game];
     return game;
 }
@@ -225,6 +225,7 @@ NSString* JbJoinStrings(NSString* separator, NSArray* strings);
 
 - (void)applicationWillTerminate:(NSNotification*)theNotification
 {
+    [minefieldController applicationWillTerminate:theNotification];
     [mGames saveDefaultGameCollection];
 }
 
@@ -28,20 +28,46 @@
 //  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 //  OTHER DEALINGS IN THE SOFTWARE.
 
-#import <Cocoa/Cocoa.h>
+#import <Foundation/Foundation.h>
+
+@class JbMinefield;
 
 @interface JbHighScores : NSObject <NSCoding>
 {
     NSMutableArray* mHighScores;
+    JbMinefield* mReplayMinefield;
 }
 - (id)initWithCoder:(NSCoder*)coder;
 - (void)encodeWithCoder:(NSCoder*)coder;
 - (void)addElapsedTime:(NSNumber*)seconds
                 forPlayer:(NSString*)player;
+/// Adds an entry for a minefield with the given 3BV.
+- (void)addElapsedTime:(NSNumber*)seconds
+             forPlayer:(NSString*)player
+            boardValue:(unsigned)bbbv;
+/// Adds an entry with the journal of the game, so its time can be
+/// verified.
+- (void)addElapsedTime:(NSNumber*)seconds
+             forPlayer:(NSString*)player
+            boardValue:(unsigned)bbbv
+               journal:(NSData*)journal;
 - (unsigned)count;
 - (NSString*)playerNameAtIndex:(unsigned)index;
 - (NSNumber*)elapsedTimeAtIndex:(unsigned)index;
 - (NSDate*)dateAtIndex:(unsigned)index;
+/// The 3BV of the entry's minefield, or nil for entries that were added
+/// without one.
+- (NSNumber*)boardValueAtIndex:(unsigned)index;
+/// The entry's 3BV divided by its time, or nil if it has no 3BV.
+- (NSNumber*)boardValuePerSecondAtIndex:(unsigned)index;
+/// The binary JbMoveJournal of the entry's game, or nil.
+- (NSData*)journalAtIndex:(unsigned)index;
+/// True if the entry has a journal that replays to a win in the entry's
+/// time.
+/** The journals are all replayed on the same minefield, which is kept
+    until the high scores are released.
+*/
+- (BOOL)isVerifiedEntryAtIndex:(unsigned)index;
 - (unsigned)rankOfElapsedTime:(NSNumber*)seconds;
 - (BOOL)isNewHighScoreEntry:(NSNumber*)seconds;
 @end
@@ -29,11 +29,15 @@
 //  OTHER DEALINGS IN THE SOFTWARE.
 
 #import "HighScores.h"
+#import <assert.h>
+#import "MoveJournal.h"
 
 static NSString* HighScoresKey = @"HighScores";
 static NSString* ElapsedTimeKey = @"ElapsedTime";
 static NSString* PlayerNameKey = @"PlayerName";
 static NSString* DateKey = @"Date";
+static NSString* BoardValueKey = @"BoardValue";
+static NSString* JournalKey = @"Journal";
 enum {GamesWonIndex, GamesLostIndex};
 enum {MaxHighScoreEntries = 50};
 
@@ -77,6 +81,7 @@ size_t FindUpperBound(NSArray* highScores, NSNumber* elapsedTime)
     if (self)
     {
         mHighScores = [[NSMutableArray arrayWithCapacity:25] retain];
+        mReplayMinefield = nil;
     }
     return self;
 }
@@ -93,6 +98,7 @@ size_t FindUpperBound(NSArray* highScores, NSNumber* elapsedTime)
             [self release];
             return nil;
         }
+        mReplayMinefield = nil;
     }
     return self;
 }
@@ -100,6 +106,7 @@ size_t FindUpperBound(NSArray* highScores, NSNumber* elapsedTime)
 - (void)dealloc
 {
     [mHighScores release];
+    [mReplayMinefield release];
     [super dealloc];
 }
 
@@ -108,18 +115,49 @@ size_t FindUpperBound(NSArray* highScores, NSNumber* elapsedTime)
     [coder encodeObject:mHighScores forKey:HighScoresKey];
 }
 
+- (void)addEntry:(NSDictionary*)newEntry
+{
+    if ([mHighScores count] < MaxHighScoreEntries)
+        [mHighScores addObject:newEntry];
+    else
+        [mHighScores replaceObjectAtIndex:[mHighScores count] - 1 withObject:newEntry];
+    [mHighScores sortUsingFunction:CompareHighScoreEntries context:NULL];
+}
+
 - (void)addElapsedTime:(NSNumber*)seconds forPlayer:(NSString*)player
 {
     NSMutableDictionary* newEntry = [NSMutableDictionary dictionaryWithCapacity:3];
     [newEntry setObject:seconds forKey:ElapsedTimeKey];
     [newEntry setObject:player forKey:PlayerNameKey];
     [newEntry setObject:[NSDate date] forKey:DateKey];
+    [self addEntry:newEntry];
+}
 
-    if ([mHighScores count] < MaxHighScoreEntries)
-        [mHighScores addObject:newEntry];
-    else
-        [mHighScores replaceObjectAtIndex:[mHighScores count] - 1 withObject:newEntry];
-    [mHighScores sortUsingFunction:CompareHighScoreEntries context:NULL];
+- (void)addElapsedTime:(NSNumber*)seconds
+             forPlayer:(NSString*)player
+            boardValue:(unsigned)bbbv
+{
+    NSMutableDictionary* newEntry = [NSMutableDictionary dictionaryWithCapacity:4];
+    [newEntry setObject:seconds forKey:ElapsedTimeKey];
+    [newEntry setObject:player forKey:PlayerNameKey];
+    [newEntry setObject:[NSDate date] forKey:DateKey];
+    [newEntry setObject:[NSNumber numberWithUnsignedInt:bbbv] forKey:BoardValueKey];
+    [self addEntry:newEntry];
+}
+
+- (void)addElapsedTime:(NSNumber*)seconds
+             forPlayer:(NSString*)player
+            boardValue:(unsigned)bbbv
+               journal:(NSData*)journal
+{
+    NSMutableDictionary* newEntry = [NSMutableDictionary dictionaryWithCapacity:5];
+    [newEntry setObject:seconds forKey:ElapsedTimeKey];
+    [newEntry setObject:player forKey:PlayerNameKey];
+    [newEntry setObject:[NSDate date] forKey:DateKey];
+    [newEntry setObject:[NSNumber numberWithUnsignedInt:bbbv] forKey:BoardValueKey];
+    if (journal != nil)
+        [newEntry setObject:journal forKey:JournalKey];
+    [self addEntry:newEntry];
 }
 
 - (unsigned)count
@@ -142,6 +180,41 @@ size_t FindUpperBound(NSArray* highScores, NSNumber* elapsedTime)
     return [[mHighScores objectAtIndex:index] objectForKey:DateKey];
 }
 
+- (NSNumber*)boardValueAtIndex:(unsigned)index
+{
+    return [[mHighScores objectAtIndex:index] objectForKey:BoardValueKey];
+}
+
+- (NSNumber*)boardValuePerSecondAtIndex:(unsigned)index
+{
+    NSNumber* bbbv = [self boardValueAtIndex:index];
+    if (bbbv == nil)
+        return nil;
+    // The elapsed time is in whole seconds, and a game that took less than
+    // one second is counted as one.
+    double seconds = MAX([[self elapsedTimeAtIndex:index] doubleValue], 1.0);
+    return [NSNumber numberWithDouble:[bbbv doubleValue] / seconds];
+}
+
+- (NSData*)journalAtIndex:(unsigned)index
+{
+    return [[mHighScores objectAtIndex:index] objectForKey:JournalKey];
+}
+
+- (BOOL)isVerifiedEntryAtIndex:(unsigned)index
+{
+    NSData* data = [self journalAtIndex:index];
+    if (data == nil)
+        return NO;
+    JbMoveJournal* journal = [JbMoveJournal journalWithData:data];
+    if (journal == nil)
+        return NO;
+    if (mReplayMinefield == nil)
+        mReplayMinefield = [[JbMinefield alloc] init];
+    return [journal verifiesElapsedTime:[[self elapsedTimeAtIndex:index] doubleValue]
+                            onMinefield:mReplayMinefield];
+}
+
 - (unsigned)rankOfElapsedTime:(NSNumber*)seconds
 {
     assert(seconds != nil);
@@ -209,6 +209,11 @@ objectValueForTableColumn:(NSTableColumn*)aTableColumn
         return [highScores playerNameAtIndex:rowIndex];
     else if ([[aTableColumn identifier] isEqualToString:@"Time"])
         return [highScores elapsedTimeAtIndex:rowIndex];
+    else if ([[aTableColumn identifier] isEqualToString:@"BoardValuePerSecond"])
+    {
+        NSNumber* rate = [highScores boardValuePerSecondAtIndex:rowIndex];
+        return rate != nil ? [NSString stringWithFormat:@"%.2f", [rate doubleValue]] : @"";
+    }
     return nil;
 }
 
@@ -220,10 +225,14 @@ objectValueForTableColumn:(NSTableColumn*)aTableColumn
          mouseLocation:(NSPoint)mouseLocation
 {
     JbHighScores* highScores = [mCurrentGame highScores];
-    if (row < [highScores count])
-        return [[highScores dateAtIndex:row] descriptionWithLocale:[[NSUserDefaults standardUserDefaults] dictionaryRepresentation]];
-    else
+    if (row >= [highScores count])
         return nil;
+    NSString* date = [[highScores dateAtIndex:row] descriptionWithLocale:[[NSUserDefaults standardUserDefaults] dictionaryRepresentation]];
+    NSNumber* bbbv = [highScores boardValueAtIndex:row];
+    if (bbbv == nil)
+        return date;
+    return [NSString stringWithFormat:@"%@\n3BV: %@ (%.2f 3BV/s)", date, bbbv,
+            [[highScores boardValuePerSecondAtIndex:row] doubleValue]];
 }
 
 - (NSTableView*)highScoreList
@@ -0,0 +1,117 @@
+//
+//  MineProbabilities.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "BitTable.h"
+#import "Table.h"
+
+/// A group of covered squares next to the uncovered ones, whose mines
+/// don't depend on the mines of any other group.
+typedef struct JbFrontierComponentStruct
+{
+    /// The linear index (row * columns + column) of the first square.
+    size_t firstSquare;
+    unsigned count;
+    /// Linear indices of the squares, in the order they are enumerated.
+    size_t* squares;
+    /// solutions[k] is the number of arrangements with k mines.
+    double* solutions;
+    /// mineSolutions[i * (count + 1) + k] is the number of arrangements
+    /// with k mines where squares[i] has a mine.
+    double* mineSolutions;
+} JbFrontierComponent;
+
+/// Computes the exact probability that each covered square has a mine.
+/** The probabilities are computed from what a player can see: which
+    squares are uncovered, their numbers and the total number of mines.
+
+    The covered squares next to uncovered ones (the frontier) are split into
+    components that don't share any numbers. Every component's mine
+    arrangements are counted separately for each number of mines, square by
+    square, without listing them one by one. The components are then
+    combined, and each total is weighted by the number of ways the
+    remaining mines can be placed in the covered squares that aren't next
+    to any number. The counts are rescaled while they are computed, so
+    they don't overflow however large the minefield is.
+
+    The update is incremental: the squares uncovered since the previous
+    update are found by comparing the covered squares with a copy, and only
+    the components within two squares of them are enumerated again.
+*/
+@interface JbMineProbabilities : NSObject
+{
+    JbTableSize mSize;
+    unsigned mNumberOfMines;
+    JbBitTable mCovered;
+    JbBitTable mFrontier;
+    JbBitTable mDirty;
+    JbBitTable mVisited;
+    JbBitTable mListed;
+    JbBitTable mScratch;
+    uint8_t* mNumbers;
+    unsigned* mLocalIndices;
+    double* mProbabilities;
+    JbFrontierComponent* mComponents;
+    size_t mNumberOfComponents;
+    size_t mComponentCapacity;
+    BOOL mIsUpToDate;
+    unsigned long mNumberOfEnumerations;
+}
+
+- (id)initWithSize:(JbTableSize)size numberOfMines:(unsigned)mines;
+/// Forgets all cached results.
+- (void)clear;
+
+- (JbTableSize)size;
+- (unsigned)numberOfMines;
+
+/// Recomputes the probabilities if any squares have been uncovered.
+/** @param covered the covered squares of the minefield.
+    @param minedNeighbors the number of mined neighbors of every square,
+           stored as nibbles. Only the numbers of uncovered squares are read.
+*/
+- (void)updateWithCovered:(const JbBitTable*)covered
+           minedNeighbors:(const uint8_t*)minedNeighbors;
+
+/// Sets the probabilities to 1 for the squares in @a mines and 0 for the
+/// rest, e.g. when the game is over.
+- (void)updateWithMines:(const JbBitTable*)mines;
+
+/// The probability that the square at @a idx has a mine.
+/** Uncovered squares have probability 0.
+*/
+- (double)probabilityAt:(JbTableIndex)idx;
+/// The probabilities of all squares, row by row.
+- (const double*)probabilities;
+
+/// The number of components that have been enumerated, rather than taken
+/// from the previous update.
+- (unsigned long)numberOfEnumerations;
+@end
@@ -0,0 +1,1128 @@
+//
+//  MineProbabilities.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MineProbabilities.h"
+#import <assert.h>
+#import <math.h>
+#import <stdlib.h>
+#import <string.h>
+
+/// Partial mine arrangements of a component, grouped by how many mines they
+/// place next to each of the numbers that have squares on both sides of a
+/// cut through the component's list of squares.
+/** Each group (state) has a key with one byte per such number, and a
+    polynomial whose k'th coefficient is the number of arrangements with k
+    mines. Only the coefficients from low up to, but not including, high
+    can be non-zero.
+*/
+typedef struct
+{
+    unsigned keyLength;
+    unsigned width;
+    size_t count;
+    size_t capacity;
+    uint8_t* keys;
+    double* polynomials;
+    unsigned* low;
+    unsigned* high;
+    /// Open addressing hash table of state indices plus one, 0 if empty.
+    size_t* buckets;
+    size_t bucketCount;
+} JbStateTable;
+
+/// The numbers next to a component and the squares next to each number.
+typedef struct
+{
+    unsigned count;
+    unsigned constraints;
+    /// The numbers next to square i are squareConstraints[i * 8 ...].
+    unsigned* squareConstraints;
+    unsigned* squareConstraintCounts;
+    /// The position of square i in the member list of each of its numbers.
+    unsigned* squareConstraintPositions;
+    /// The number of mines next to each number.
+    int* need;
+    unsigned* firstMember;
+    unsigned* lastMember;
+    unsigned* memberCount;
+    /// The numbers that have squares on both sides of cut t (i.e. both
+    /// before and from square t) are active[activeStart[t] ...
+    /// activeStart[t + 1]], in ascending order.
+    unsigned* activeStart;
+    unsigned* active;
+} JbComponentConstraints;
+
+static inline uint64_t LastWordMask(const JbBitTable* table)
+{
+    unsigned bits = table->columns % 64;
+    return bits != 0 ? ((uint64_t)1 << bits) - 1 : ~(uint64_t)0;
+}
+
+/// Finds the covered squares that have at least one uncovered neighbor.
+/** The uncovered squares are dilated by one column in @a scratch, and then
+    by one row when the rows are combined in @a frontier.
+*/
+static void ComputeFrontier(const JbBitTable* covered,
+                            JbBitTable* scratch,
+                            JbBitTable* frontier)
+{
+    unsigned words = covered->wordsPerRow;
+    uint64_t lastMask = LastWordMask(covered);
+    for (unsigned row = 0; row != covered->rows; ++row)
+    {
+        const uint64_t* c = JbBitTableRow(covered, row);
+        uint64_t* s = JbBitTableRow(scratch, row);
+        uint64_t carry = 0;
+        for (unsigned w = 0; w != words; ++w)
+        {
+            uint64_t u = ~c[w] & (w == words - 1 ? lastMask : ~(uint64_t)0);
+            uint64_t next = w + 1 != words ? ~c[w + 1] & (w + 1 == words - 1 ? lastMask : ~(uint64_t)0) : 0;
+            s[w] = u | (u << 1) | carry | (u >> 1) | (next << 63);
+            carry = u >> 63;
+        }
+    }
+
+    for (unsigned row = 0; row != covered->rows; ++row)
+    {
+        const uint64_t* c = JbBitTableRow(covered, row);
+        const uint64_t* s = JbBitTableRow(scratch, row);
+        const uint64_t* above = row != 0 ? JbBitTableRow(scratch, row - 1) : NULL;
+        const uint64_t* below = row + 1 != covered->rows ? JbBitTableRow(scratch, row + 1) : NULL;
+        uint64_t* f = JbBitTableRow(frontier, row);
+        for (unsigned w = 0; w != words; ++w)
+        {
+            uint64_t near = s[w];
+            if (above != NULL)
+                near |= above[w];
+            if (below != NULL)
+                near |= below[w];
+            f[w] = c[w] & near;
+        }
+    }
+}
+
+static unsigned BreadthFirst(const JbBitTable* covered,
+                             JbBitTable* visited,
+                             size_t start,
+                             size_t** squares,
+                             size_t* capacity)
+{
+    unsigned columns = covered->columns;
+    unsigned count = 0;
+    JbSetBit(visited, start / columns, start % columns);
+    (*squares)[count++] = start;
+    for (unsigned head = 0; head != count; ++head)
+    {
+        unsigned row = (*squares)[head] / columns, col = (*squares)[head] % columns;
+        unsigned rowBegin = row != 0 ? row - 1 : 0;
+        unsigned rowEnd = MIN(row + 2, covered->rows);
+        unsigned colBegin = col != 0 ? col - 1 : 0;
+        unsigned colEnd = MIN(col + 2, columns);
+        for (unsigned r = rowBegin; r != rowEnd; ++r)
+        {
+            for (unsigned c = colBegin; c != colEnd; ++c)
+            {
+                if (JbGetBit(covered, r, c))
+                    continue;
+                // Every covered neighbor of the number at (r, c) belongs to
+                // the same component.
+                unsigned nRowBegin = r != 0 ? r - 1 : 0;
+                unsigned nRowEnd = MIN(r + 2, covered->rows);
+                unsigned nColBegin = c != 0 ? c - 1 : 0;
+                unsigned nColEnd = MIN(c + 2, columns);
+                for (unsigned nr = nRowBegin; nr != nRowEnd; ++nr)
+                {
+                    for (unsigned nc = nColBegin; nc != nColEnd; ++nc)
+                    {
+                        if (!JbGetBit(covered, nr, nc) || JbGetBit(visited, nr, nc))
+                            continue;
+                        JbSetBit(visited, nr, nc);
+                        if (count == *capacity)
+                        {
+                            *capacity *= 2;
+                            *squares = (size_t*)realloc(*squares, *capacity * sizeof(size_t));
+                            assert(*squares != NULL);
+                        }
+                        (*squares)[count++] = (size_t)nr * columns + nc;
+                    }
+                }
+            }
+        }
+    }
+    return count;
+}
+
+/// Collects the frontier squares that are connected to @a start through
+/// shared numbers.
+/** The squares are appended to @a squares in breadth first order, starting
+    from the square that was found last when starting from @a start. That
+    square lies at one end of the component, and starting there keeps the
+    number of numbers with squares on both sides of any cut through the
+    list low, which is what the cost of EnumerateComponent depends on.
+    @return the number of squares in the component.
+*/
+static unsigned CollectComponent(const JbBitTable* covered,
+                                 JbBitTable* visited,
+                                 size_t start,
+                                 size_t** squares,
+                                 size_t* capacity)
+{
+    unsigned columns = covered->columns;
+    unsigned count = BreadthFirst(covered, visited, start, squares, capacity);
+    if (count <= 2)
+        return count;
+    for (unsigned i = 0; i != count; ++i)
+        JbClearBit(visited, (*squares)[i] / columns, (*squares)[i] % columns);
+    return BreadthFirst(covered, visited, (*squares)[count - 1], squares, capacity);
+}
+
+static void InitStateTable(JbStateTable* table, unsigned keyLength, unsigned width)
+{
+    table->keyLength = keyLength;
+    table->width = width;
+    table->count = 0;
+    table->capacity = 16;
+    table->keys = (uint8_t*)malloc(table->capacity * MAX(keyLength, 1u));
+    table->polynomials = (double*)malloc(table->capacity * width * sizeof(double));
+    table->low = (unsigned*)malloc(table->capacity * sizeof(unsigned));
+    table->high = (unsigned*)malloc(table->capacity * sizeof(unsigned));
+    table->bucketCount = 32;
+    table->buckets = (size_t*)calloc(table->bucketCount, sizeof(size_t));
+    assert(table->keys && table->polynomials && table->low && table->high
+           && table->buckets);
+}
+
+static void FreeStateTable(JbStateTable* table)
+{
+    free(table->keys);
+    free(table->polynomials);
+    free(table->low);
+    free(table->high);
+    free(table->buckets);
+}
+
+static inline size_t HashKey(const uint8_t* key, unsigned length)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (unsigned i = 0; i != length; ++i)
+        hash = (hash ^ key[i]) * 0x100000001B3ULL;
+    return (size_t)(hash ^ (hash >> 32));
+}
+
+static size_t* FindBucket(const JbStateTable* table, const uint8_t* key)
+{
+    size_t mask = table->bucketCount - 1;
+    size_t i = HashKey(key, table->keyLength) & mask;
+    while (table->buckets[i] != 0
+           && memcmp(&table->keys[(table->buckets[i] - 1) * table->keyLength],
+                     key, table->keyLength) != 0)
+        i = (i + 1) & mask;
+    return &table->buckets[i];
+}
+
+/// Returns the index of the state with @a key, or -1 if there is none.
+static ptrdiff_t FindState(const JbStateTable* table, const uint8_t* key)
+{
+    return (ptrdiff_t)*FindBucket(table, key) - 1;
+}
+
+static void GrowStateTable(JbStateTable* table)
+{
+    table->capacity *= 2;
+    table->keys = (uint8_t*)realloc(table->keys, table->capacity * MAX(table->keyLength, 1u));
+    table->polynomials = (double*)realloc(table->polynomials,
+                                          table->capacity * table->width * sizeof(double));
+    table->low = (unsigned*)realloc(table->low, table->capacity * sizeof(unsigned));
+    table->high = (unsigned*)realloc(table->high, table->capacity * sizeof(unsigned));
+    assert(table->keys && table->polynomials && table->low && table->high);
+
+    free(table->buckets);
+    table->bucketCount *= 2;
+    table->buckets = (size_t*)calloc(table->bucketCount, sizeof(size_t));
+    assert(table->buckets != NULL);
+    for (size_t i = 0; i != table->count; ++i)
+        *FindBucket(table, &table->keys[i * table->keyLength]) = i + 1;
+}
+
+/// Adds polynomial @a source, multiplied by x^@a shift, to the state with
+/// @a key, which is created if necessary.
+static void AddToState(JbStateTable* table, const uint8_t* key,
+                       const double* source, unsigned low, unsigned high,
+                       unsigned shift)
+{
+    size_t* bucket = FindBucket(table, key);
+    size_t i;
+    if (*bucket != 0)
+    {
+        i = *bucket - 1;
+    }
+    else
+    {
+        if (table->count == table->capacity)
+        {
+            GrowStateTable(table);
+            bucket = FindBucket(table, key);
+        }
+        i = table->count++;
+        *bucket = i + 1;
+        memcpy(&table->keys[i * table->keyLength], key, table->keyLength);
+        memset(&table->polynomials[i * table->width], 0, table->width * sizeof(double));
+        table->low[i] = low + shift;
+        table->high[i] = high + shift;
+    }
+
+    double* target = &table->polynomials[i * table->width];
+    for (unsigned k = low; k != high; ++k)
+        target[k + shift] += source[k];
+    table->low[i] = MIN(table->low[i], low + shift);
+    table->high[i] = MAX(table->high[i], high + shift);
+}
+
+/// Returns the exponent of the power of two that brings @a largest into
+/// [0.5, 1), or 0 if @a largest is 0.
+static inline int ScaleExponent(double largest)
+{
+    int exponent = 0;
+    if (largest > 0)
+        frexp(largest, &exponent);
+    return exponent;
+}
+
+/// Divides the coefficients from @a low up to, but not including, @a high
+/// by 2^@a exponent.
+static inline void ScalePolynomial(double* polynomial, unsigned low, unsigned high,
+                                   int exponent)
+{
+    for (unsigned k = low; k != high; ++k)
+        polynomial[k] = ldexp(polynomial[k], -exponent);
+}
+
+/// Divides all the polynomials of @a table by the power of two that brings
+/// their largest coefficient into [0.5, 1).
+/** @return the exponent of the power of two.
+*/
+static int NormalizeStateTable(JbStateTable* table)
+{
+    double largest = 0;
+    for (size_t s = 0; s != table->count; ++s)
+    {
+        const double* polynomial = &table->polynomials[s * table->width];
+        for (unsigned k = table->low[s]; k != table->high[s]; ++k)
+            largest = MAX(largest, polynomial[k]);
+    }
+    int exponent = ScaleExponent(largest);
+    for (size_t s = 0; s != table->count; ++s)
+        ScalePolynomial(&table->polynomials[s * table->width],
+                        table->low[s], table->high[s], exponent);
+    return exponent;
+}
+
+/// Computes the key of the state after square @a i in the forward
+/// direction, where the key holds the number of mines placed next to each
+/// active number so far.
+/** @return NO if @a hasMine contradicts the numbers.
+*/
+static BOOL NextForwardKey(const JbComponentConstraints* cc, unsigned i, BOOL hasMine,
+                           const uint8_t* key, uint8_t* nextKey, int* slots)
+{
+    const unsigned* active = &cc->active[cc->activeStart[i]];
+    unsigned activeCount = cc->activeStart[i + 1] - cc->activeStart[i];
+    const unsigned* nextActive = &cc->active[cc->activeStart[i + 1]];
+    unsigned nextCount = cc->activeStart[i + 2] - cc->activeStart[i + 1];
+
+    for (unsigned a = 0; a != activeCount; ++a)
+        slots[active[a]] = (int)key[a];
+    for (unsigned m = 0; m != cc->squareConstraintCounts[i]; ++m)
+    {
+        unsigned j = cc->squareConstraints[i * 8 + m];
+        int placed = (cc->firstMember[j] < i ? slots[j] : 0) + (hasMine ? 1 : 0);
+        int after = (int)(cc->memberCount[j] - cc->squareConstraintPositions[i * 8 + m] - 1);
+        if (placed > cc->need[j] || cc->need[j] - placed > after)
+            return NO;
+        slots[j] = placed;
+    }
+    for (unsigned a = 0; a != nextCount; ++a)
+        nextKey[a] = (uint8_t)slots[nextActive[a]];
+    return YES;
+}
+
+/// Computes the key of the state before square @a i in the backward
+/// direction.
+/** The key holds the number of mines each active number still needs from
+    the squares before the cut, so that matching forward and backward
+    states have equal keys.
+    @return NO if @a hasMine contradicts the numbers.
+*/
+static BOOL NextBackwardKey(const JbComponentConstraints* cc, unsigned i, BOOL hasMine,
+                            const uint8_t* key, uint8_t* nextKey, int* slots)
+{
+    const unsigned* active = &cc->active[cc->activeStart[i + 1]];
+    unsigned activeCount = cc->activeStart[i + 2] - cc->activeStart[i + 1];
+    const unsigned* nextActive = &cc->active[cc->activeStart[i]];
+    unsigned nextCount = cc->activeStart[i + 1] - cc->activeStart[i];
+
+    for (unsigned a = 0; a != activeCount; ++a)
+        slots[active[a]] = (int)key[a];
+    for (unsigned m = 0; m != cc->squareConstraintCounts[i]; ++m)
+    {
+        unsigned j = cc->squareConstraints[i * 8 + m];
+        int needed = (cc->lastMember[j] > i ? slots[j] : cc->need[j]) - (hasMine ? 1 : 0);
+        int before = (int)cc->squareConstraintPositions[i * 8 + m];
+        if (needed < 0 || needed > before)
+            return NO;
+        slots[j] = needed;
+    }
+    for (unsigned a = 0; a != nextCount; ++a)
+        nextKey[a] = (uint8_t)slots[nextActive[a]];
+    return YES;
+}
+
+/// Finds the numbers next to @a component and the numbers that are active
+/// at each cut.
+static void InitComponentConstraints(JbComponentConstraints* cc,
+                                     const JbFrontierComponent* component,
+                                     const JbBitTable* covered,
+                                     const uint8_t* numbers,
+                                     JbBitTable* listed,
+                                     unsigned* localIndices)
+{
+    unsigned columns = covered->columns;
+    unsigned count = component->count;
+    for (unsigned i = 0; i != count; ++i)
+        localIndices[component->squares[i]] = i;
+
+    // Each square has at most 8 numbers next to it, and each number is
+    // listed once.
+    size_t capacity = (size_t)count * 8;
+    size_t* constraintSquares = (size_t*)malloc(capacity * sizeof(size_t));
+    cc->count = count;
+    cc->squareConstraints = (unsigned*)malloc(capacity * sizeof(unsigned));
+    cc->squareConstraintCounts = (unsigned*)calloc(count, sizeof(unsigned));
+    cc->squareConstraintPositions = (unsigned*)malloc(capacity * sizeof(unsigned));
+    cc->need = (int*)malloc(capacity * sizeof(int));
+    cc->firstMember = (unsigned*)malloc(capacity * sizeof(unsigned));
+    cc->lastMember = (unsigned*)malloc(capacity * sizeof(unsigned));
+    cc->memberCount = (unsigned*)calloc(capacity, sizeof(unsigned));
+    assert(constraintSquares && cc->squareConstraints && cc->squareConstraintCounts
+           && cc->squareConstraintPositions && cc->need && cc->firstMember
+           && cc->lastMember && cc->memberCount);
+
+    unsigned constraints = 0;
+    for (unsigned i = 0; i != count; ++i)
+    {
+        unsigned row = component->squares[i] / columns;
+        unsigned col = component->squares[i] % columns;
+        unsigned rowBegin = row != 0 ? row - 1 : 0;
+        unsigned rowEnd = MIN(row + 2, covered->rows);
+        unsigned colBegin = col != 0 ? col - 1 : 0;
+        unsigned colEnd = MIN(col + 2, columns);
+        for (unsigned r = rowBegin; r != rowEnd; ++r)
+        {
+            for (unsigned c = colBegin; c != colEnd; ++c)
+            {
+                if (JbGetBit(covered, r, c) || JbGetBit(listed, r, c))
+                    continue;
+                JbSetBit(listed, r, c);
+                size_t square = (size_t)r * columns + c;
+                constraintSquares[constraints] = square;
+                cc->need[constraints] = (int)JbGetNibble(numbers, square);
+
+                unsigned nRowBegin = r != 0 ? r - 1 : 0;
+                unsigned nRowEnd = MIN(r + 2, covered->rows);
+                unsigned nColBegin = c != 0 ? c - 1 : 0;
+                unsigned nColEnd = MIN(c + 2, columns);
+                unsigned first = count, last = 0;
+                for (unsigned nr = nRowBegin; nr != nRowEnd; ++nr)
+                {
+                    for (unsigned nc = nColBegin; nc != nColEnd; ++nc)
+                    {
+                        if (!JbGetBit(covered, nr, nc))
+                            continue;
+                        unsigned local = localIndices[(size_t)nr * columns + nc];
+                        cc->squareConstraints[local * 8 + cc->squareConstraintCounts[local]++] = constraints;
+                        first = MIN(first, local);
+                        last = MAX(last, local);
+                        ++cc->memberCount[constraints];
+                    }
+                }
+                cc->firstMember[constraints] = first;
+                cc->lastMember[constraints] = last;
+                ++constraints;
+            }
+        }
+    }
+    cc->constraints = constraints;
+    for (unsigned j = 0; j != constraints; ++j)
+        JbClearBit(listed, constraintSquares[j] / columns, constraintSquares[j] % columns);
+    free(constraintSquares);
+
+    // A square's position among the members of a number is the number of
+    // members before it, counted in the order of the squares.
+    unsigned* seen = (unsigned*)calloc(constraints, sizeof(unsigned));
+    assert(seen != NULL);
+    for (unsigned i = 0; i != count; ++i)
+    {
+        for (unsigned m = 0; m != cc->squareConstraintCounts[i]; ++m)
+            cc->squareConstraintPositions[i * 8 + m] = seen[cc->squareConstraints[i * 8 + m]]++;
+    }
+    free(seen);
+
+    // Number j is active at cut t if firstMember[j] < t <= lastMember[j].
+    // Cuts run from 0 to count, and activeStart has an extra entry at the
+    // end.
+    cc->activeStart = (unsigned*)calloc(count + 2, sizeof(unsigned));
+    assert(cc->activeStart != NULL);
+    for (unsigned j = 0; j != constraints; ++j)
+        for (unsigned t = cc->firstMember[j] + 1; t <= cc->lastMember[j]; ++t)
+            ++cc->activeStart[t + 1];
+    for (unsigned t = 0; t <= count; ++t)
+        cc->activeStart[t + 1] += cc->activeStart[t];
+    cc->active = (unsigned*)malloc(MAX(cc->activeStart[count + 1], 1u) * sizeof(unsigned));
+    unsigned* fill = (unsigned*)malloc((count + 1) * sizeof(unsigned));
+    assert(cc->active != NULL && fill != NULL);
+    memcpy(fill, cc->activeStart, (count + 1) * sizeof(unsigned));
+    for (unsigned j = 0; j != constraints; ++j)
+        for (unsigned t = cc->firstMember[j] + 1; t <= cc->lastMember[j]; ++t)
+            cc->active[fill[t]++] = j;
+    free(fill);
+}
+
+static void FreeComponentConstraints(JbComponentConstraints* cc)
+{
+    free(cc->squareConstraints);
+    free(cc->squareConstraintCounts);
+    free(cc->squareConstraintPositions);
+    free(cc->need);
+    free(cc->firstMember);
+    free(cc->lastMember);
+    free(cc->memberCount);
+    free(cc->activeStart);
+    free(cc->active);
+}
+
+/// Counts the mine arrangements of @a component for each number of mines.
+/** Listing the arrangements one by one is out of the question, as long
+    chains of numbers along the frontier have astronomically many. The
+    squares are instead processed in order, and the partial arrangements
+    are grouped by how many mines they place next to the numbers that have
+    squares on both sides of the cut (see JbStateTable). In breadth first
+    order there are only a few such numbers at any cut, so the groups stay
+    few.
+
+    A backward pass stores the groups at every cut. A forward pass then
+    combines the groups before each square with the matching groups after
+    it, which gives the number of arrangements where that square has a
+    mine.
+
+    A component of n squares can have up to 2^n arrangements, which
+    overflows a double when n exceeds 1023. The groups at each cut are
+    therefore divided by a power of two after every square, and the
+    exponents are added up separately. The counts are finally scaled so
+    that the largest is 1, since only their ratios matter.
+*/
+static void EnumerateComponent(JbFrontierComponent* component,
+                               const JbBitTable* covered,
+                               const uint8_t* numbers,
+                               JbBitTable* listed,
+                               unsigned* localIndices)
+{
+    JbComponentConstraints cc;
+    InitComponentConstraints(&cc, component, covered, numbers, listed, localIndices);
+    unsigned count = component->count;
+    unsigned width = count + 1;
+
+    unsigned maxKey = 1;
+    for (unsigned t = 0; t <= count; ++t)
+        maxKey = MAX(maxKey, cc.activeStart[t + 1] - cc.activeStart[t]);
+    uint8_t* nextKey = (uint8_t*)malloc(maxKey);
+    int* slots = (int*)malloc(MAX(cc.constraints, 1u) * sizeof(int));
+    JbStateTable* backward = (JbStateTable*)malloc((count + 1) * sizeof(JbStateTable));
+    // The counts at cut t are backward[t] times 2^backwardExponents[t].
+    int* backwardExponents = (int*)malloc((count + 1) * sizeof(int));
+    assert(nextKey != NULL && slots != NULL && backward != NULL
+           && backwardExponents != NULL);
+
+    double one = 1;
+    for (unsigned t = 0; t <= count; ++t)
+        InitStateTable(&backward[t], cc.activeStart[t + 1] - cc.activeStart[t], width);
+    AddToState(&backward[count], nextKey, &one, 0, 1, 0);
+    backwardExponents[count] = 0;
+    for (unsigned i = count; i-- != 0;)
+    {
+        const JbStateTable* after = &backward[i + 1];
+        for (size_t s = 0; s != after->count; ++s)
+        {
+            const uint8_t* key = &after->keys[s * after->keyLength];
+            const double* polynomial = &after->polynomials[s * width];
+            for (int mine = 0; mine != 2; ++mine)
+            {
+                if (NextBackwardKey(&cc, i, mine, key, nextKey, slots))
+                    AddToState(&backward[i], nextKey, polynomial,
+                               after->low[s], after->high[s], mine);
+            }
+        }
+        backwardExponents[i] = backwardExponents[i + 1] + NormalizeStateTable(&backward[i]);
+    }
+
+    component->solutions = (double*)calloc(width, sizeof(double));
+    component->mineSolutions = (double*)calloc((size_t)count * width, sizeof(double));
+    assert(component->solutions != NULL && component->mineSolutions != NULL);
+    if (backward[0].count != 0)
+        memcpy(component->solutions, backward[0].polynomials, width * sizeof(double));
+
+    // The counts of the solutions are backward[0] times
+    // 2^backwardExponents[0], and the counts before square i are forward
+    // times 2^forwardExponent.
+    JbStateTable forward, next;
+    InitStateTable(&forward, 0, width);
+    AddToState(&forward, nextKey, &one, 0, 1, 0);
+    int forwardExponent = 0;
+    for (unsigned i = 0; i != count; ++i)
+    {
+        const JbStateTable* after = &backward[i + 1];
+        double* mineSolutions = &component->mineSolutions[(size_t)i * width];
+        InitStateTable(&next, cc.activeStart[i + 2] - cc.activeStart[i + 1], width);
+        for (size_t s = 0; s != forward.count; ++s)
+        {
+            const uint8_t* key = &forward.keys[s * forward.keyLength];
+            const double* polynomial = &forward.polynomials[s * width];
+            for (int mine = 0; mine != 2; ++mine)
+            {
+                if (!NextForwardKey(&cc, i, mine, key, nextKey, slots))
+                    continue;
+                ptrdiff_t match = FindState(after, nextKey);
+                if (match < 0)
+                    continue; // No arrangement of the remaining squares fits.
+                AddToState(&next, nextKey, polynomial, forward.low[s], forward.high[s], mine);
+                if (!mine)
+                    continue;
+                const double* rest = &after->polynomials[match * width];
+                for (unsigned a = forward.low[s]; a != forward.high[s]; ++a)
+                    for (unsigned b = after->low[match]; b != after->high[match]; ++b)
+                        mineSolutions[a + 1 + b] += polynomial[a] * rest[b];
+            }
+        }
+        ScalePolynomial(mineSolutions, 0, width,
+                        backwardExponents[0] - forwardExponent - backwardExponents[i + 1]);
+        FreeStateTable(&forward);
+        forward = next;
+        forwardExponent += NormalizeStateTable(&forward);
+    }
+    FreeStateTable(&forward);
+    for (unsigned t = 0; t <= count; ++t)
+        FreeStateTable(&backward[t]);
+    free(backward);
+    free(backwardExponents);
+    free(nextKey);
+    free(slots);
+    FreeComponentConstraints(&cc);
+
+    double largest = 0;
+    for (unsigned k = 0; k != width; ++k)
+        largest = MAX(largest, component->solutions[k]);
+    if (largest > 0)
+    {
+        for (unsigned k = 0; k != width; ++k)
+            component->solutions[k] /= largest;
+        for (size_t i = 0; i != (size_t)count * width; ++i)
+            component->mineSolutions[i] /= largest;
+    }
+}
+
+static void FreeComponent(JbFrontierComponent* component)
+{
+    free(component->squares);
+    free(component->solutions);
+    free(component->mineSolutions);
+    memset(component, 0, sizeof(JbFrontierComponent));
+}
+
+/// Returns log(n choose k), or -INFINITY if there are no such combinations.
+static double LogBinomial(unsigned n, int k)
+{
+    if (k < 0 || (unsigned)k > n)
+        return -INFINITY;
+    return lgamma(n + 1.0) - lgamma(k + 1.0) - lgamma(n - k + 1.0);
+}
+
+/// Sets @a result to the product of polynomials @a a and @a b, truncated
+/// to @a degree.
+static void Convolve(const double* a, const double* b, double* result, unsigned degree)
+{
+    for (unsigned k = 0; k <= degree; ++k)
+    {
+        double sum = 0;
+        for (unsigned j = 0; j <= k; ++j)
+            sum += a[j] * b[k - j];
+        result[k] = sum;
+    }
+}
+
+/// Computes the probabilities of the frontier squares and of the others.
+/** The components' mine counts are independent, except that they must
+    add up to at most @a mines. A total of t mines in the frontier is
+    weighted by the number of ways to place the remaining mines among the
+    @a interior covered squares that aren't in the frontier. The weights
+    are scaled by the largest one so they fit in a double, and the products
+    of the components' counts are divided by a power of two for every
+    component, like in EnumerateComponent.
+
+    @return the probability of the interior squares, or a negative value
+            if no arrangement of mines fits the numbers.
+*/
+static double CombineComponents(const JbFrontierComponent* components,
+                                size_t n,
+                                unsigned interior,
+                                unsigned mines,
+                                double* probabilities)
+{
+    unsigned degree = 0;
+    for (size_t c = 0; c != n; ++c)
+        degree += components[c].count;
+    degree = MIN(degree, mines);
+    size_t width = degree + 1;
+
+    // prefix[c] times 2^prefixExponents[c] is the product of the first c
+    // components' polynomials, suffix[c] times 2^suffixExponents[c] of the
+    // components from c onwards.
+    double* prefix = (double*)calloc((n + 1) * width, sizeof(double));
+    double* suffix = (double*)calloc((n + 1) * width, sizeof(double));
+    int* prefixExponents = (int*)malloc((n + 1) * sizeof(int));
+    int* suffixExponents = (int*)malloc((n + 1) * sizeof(int));
+    double* padded = (double*)calloc(width, sizeof(double));
+    double* rest = (double*)malloc(width * sizeof(double));
+    double* weights = (double*)malloc(width * sizeof(double));
+    double* restWeights = (double*)malloc(width * sizeof(double));
+    assert(prefix && suffix && prefixExponents && suffixExponents
+           && padded && rest && weights && restWeights);
+
+    prefix[0] = 1;
+    prefixExponents[0] = 0;
+    for (size_t c = 0; c != n; ++c)
+    {
+        memset(padded, 0, width * sizeof(double));
+        memcpy(padded, components[c].solutions,
+               MIN(components[c].count + 1, width) * sizeof(double));
+        double* product = &prefix[(c + 1) * width];
+        Convolve(&prefix[c * width], padded, product, degree);
+        double largest = 0;
+        for (unsigned k = 0; k <= degree; ++k)
+            largest = MAX(largest, product[k]);
+        int exponent = ScaleExponent(largest);
+        ScalePolynomial(product, 0, degree + 1, exponent);
+        prefixExponents[c + 1] = prefixExponents[c] + exponent;
+    }
+    suffix[n * width] = 1;
+    suffixExponents[n] = 0;
+    for (size_t c = n; c-- != 0;)
+    {
+        memset(padded, 0, width * sizeof(double));
+        memcpy(padded, components[c].solutions,
+               MIN(components[c].count + 1, width) * sizeof(double));
+        double* product = &suffix[c * width];
+        Convolve(&suffix[(c + 1) * width], padded, product, degree);
+        double largest = 0;
+        for (unsigned k = 0; k <= degree; ++k)
+            largest = MAX(largest, product[k]);
+        int exponent = ScaleExponent(largest);
+        ScalePolynomial(product, 0, degree + 1, exponent);
+        suffixExponents[c] = suffixExponents[c + 1] + exponent;
+    }
+
+    double largest = -INFINITY;
+    for (unsigned t = 0; t <= degree; ++t)
+    {
+        weights[t] = LogBinomial(interior, (int)mines - (int)t);
+        largest = MAX(largest, weights[t]);
+    }
+    for (unsigned t = 0; t <= degree; ++t)
+        weights[t] = largest != -INFINITY ? exp(weights[t] - largest) : 0;
+
+    const double* total = &prefix[n * width];
+    double sum = 0, interiorMines = 0;
+    for (unsigned t = 0; t <= degree; ++t)
+    {
+        sum += total[t] * weights[t];
+        interiorMines += total[t] * weights[t] * (mines - t);
+    }
+
+    double interiorProbability = -1;
+    if (sum > 0)
+    {
+        interiorProbability = interior != 0 ? interiorMines / sum / interior : 0;
+        for (size_t c = 0; c != n; ++c)
+        {
+            const JbFrontierComponent* component = &components[c];
+            Convolve(&prefix[c * width], &suffix[(c + 1) * width], rest, degree);
+            int exponent = prefixExponents[c] + suffixExponents[c + 1]
+                           - prefixExponents[n];
+            for (unsigned k = 0; k <= degree; ++k)
+            {
+                double w = 0;
+                for (unsigned j = 0; j + k <= degree; ++j)
+                    w += rest[j] * weights[j + k];
+                restWeights[k] = w;
+            }
+            unsigned maxK = MIN(component->count, degree);
+            for (unsigned i = 0; i != component->count; ++i)
+            {
+                const double* mineSolutions = &component->mineSolutions[i * (component->count + 1)];
+                double p = 0;
+                for (unsigned k = 1; k <= maxK; ++k)
+                    p += mineSolutions[k] * restWeights[k];
+                probabilities[component->squares[i]] = ldexp(p / sum, exponent);
+            }
+        }
+    }
+
+    free(prefix);
+    free(suffix);
+    free(prefixExponents);
+    free(suffixExponents);
+    free(padded);
+    free(rest);
+    free(weights);
+    free(restWeights);
+    return interiorProbability;
+}
+
+@implementation JbMineProbabilities
+
+- (id)init
+{
+    self = [super init];
+    if (self != nil)
+    {
+        memset(&mCovered, 0, sizeof(mCovered));
+        memset(&mFrontier, 0, sizeof(mFrontier));
+        memset(&mDirty, 0, sizeof(mDirty));
+        memset(&mVisited, 0, sizeof(mVisited));
+        memset(&mListed, 0, sizeof(mListed));
+        memset(&mScratch, 0, sizeof(mScratch));
+        mNumbers = NULL;
+        mLocalIndices = NULL;
+        mProbabilities = NULL;
+        mComponents = NULL;
+        mNumberOfComponents = 0;
+        mComponentCapacity = 0;
+        mSize = JbMakeTableSize(0, 0);
+        mNumberOfMines = 0;
+        mIsUpToDate = NO;
+        mNumberOfEnumerations = 0;
+    }
+    return self;
+}
+
+- (id)initWithSize:(JbTableSize)size numberOfMines:(unsigned)mines
+{
+    assert(size.rows > 0 && size.columns > 0);
+    self = [self init];
+    if (self)
+    {
+        mSize = size;
+        mNumberOfMines = mines;
+        size_t squares = (size_t)size.rows * size.columns;
+        BOOL success = JbInitBitTable(&mCovered, size.rows, size.columns)
+                       && JbInitBitTable(&mFrontier, size.rows, size.columns)
+                       && JbInitBitTable(&mDirty, size.rows, size.columns)
+                       && JbInitBitTable(&mVisited, size.rows, size.columns)
+                       && JbInitBitTable(&mListed, size.rows, size.columns)
+                       && JbInitBitTable(&mScratch, size.rows, size.columns);
+        mNumbers = (uint8_t*)calloc(JbNibbleArraySize(squares), 1);
+        mLocalIndices = (unsigned*)malloc(squares * sizeof(unsigned));
+        mProbabilities = (double*)malloc(squares * sizeof(double));
+        NSAssert(success && mNumbers != NULL && mLocalIndices != NULL
+                 && mProbabilities != NULL,
+                 @"Unable to allocate memory for the mine probabilities");
+        [self clear];
+    }
+    return self;
+}
+
+- (void)freeComponents
+{
+    for (size_t i = 0; i != mNumberOfComponents; ++i)
+        FreeComponent(&mComponents[i]);
+    mNumberOfComponents = 0;
+}
+
+- (void)dealloc
+{
+    [self freeComponents];
+    free(mComponents);
+    JbFreeBitTable(&mCovered);
+    JbFreeBitTable(&mFrontier);
+    JbFreeBitTable(&mDirty);
+    JbFreeBitTable(&mVisited);
+    JbFreeBitTable(&mListed);
+    JbFreeBitTable(&mScratch);
+    if (mNumbers != NULL)
+        free(mNumbers);
+    if (mLocalIndices != NULL)
+        free(mLocalIndices);
+    if (mProbabilities != NULL)
+        free(mProbabilities);
+    [super dealloc];
+}
+
+- (void)clear
+{
+    assert(mProbabilities != NULL);
+    [self freeComponents];
+    // An empty copy makes the next update start from scratch, since the
+    // minefield will have covered squares that the copy doesn't.
+    JbFillBitTable(&mCovered, NO);
+    JbFillBitTable(&mDirty, NO);
+    mIsUpToDate = NO;
+}
+
+- (JbTableSize)size
+{
+    return mSize;
+}
+
+- (unsigned)numberOfMines
+{
+    return mNumberOfMines;
+}
+
+- (void)markDirtyAround:(size_t)square
+{
+    unsigned row = square / mSize.columns, col = square % mSize.columns;
+    unsigned rowBegin = row >= 2 ? row - 2 : 0;
+    unsigned rowEnd = MIN(row + 3, mSize.rows);
+    unsigned colBegin = col >= 2 ? col - 2 : 0;
+    unsigned colEnd = MIN(col + 3, mSize.columns);
+    for (unsigned r = rowBegin; r != rowEnd; ++r)
+        for (unsigned c = colBegin; c != colEnd; ++c)
+            JbSetBit(&mDirty, r, c);
+}
+
+/// Copies @a covered and the numbers of the squares that have been
+/// uncovered since the last update.
+/** Squares within two rows and columns of a newly uncovered square are
+    marked as dirty: their numbers or their neighbors' numbers have
+    changed. If squares have been covered again, i.e. a new game has been
+    started, all cached components are discarded.
+    @return NO if nothing has changed.
+*/
+- (BOOL)copyCovered:(const JbBitTable*)covered
+     minedNeighbors:(const uint8_t*)minedNeighbors
+{
+    assert(covered->rows == mSize.rows && covered->columns == mSize.columns);
+    size_t words = (size_t)mSize.rows * mCovered.wordsPerRow;
+    BOOL restart = NO;
+    for (size_t i = 0; i != words && !restart; ++i)
+        restart = (covered->words[i] & ~mCovered.words[i]) != 0;
+
+    if (restart)
+    {
+        [self freeComponents];
+        memcpy(mCovered.words, covered->words, words * sizeof(uint64_t));
+        memcpy(mNumbers, minedNeighbors,
+               JbNibbleArraySize((size_t)mSize.rows * mSize.columns));
+        return YES;
+    }
+
+    BOOL changed = NO;
+    for (size_t i = 0; i != words; ++i)
+    {
+        uint64_t uncovered = mCovered.words[i] & ~covered->words[i];
+        if (uncovered == 0)
+            continue;
+        changed = YES;
+        mCovered.words[i] = covered->words[i];
+        size_t row = i / mCovered.wordsPerRow;
+        size_t firstColumn = (i % mCovered.wordsPerRow) * 64;
+        while (uncovered != 0)
+        {
+            size_t square = row * mSize.columns + firstColumn + __builtin_ctzll(uncovered);
+            uncovered &= uncovered - 1;
+            JbSetNibble(mNumbers, square, JbGetNibble(minedNeighbors, square));
+            [self markDirtyAround:square];
+        }
+    }
+    return changed;
+}
+
+- (BOOL)isDirty:(const JbFrontierComponent*)component
+{
+    for (unsigned i = 0; i != component->count; ++i)
+    {
+        size_t square = component->squares[i];
+        if (JbGetBit(&mDirty, square / mSize.columns, square % mSize.columns))
+            return YES;
+    }
+    return NO;
+}
+
+/// Splits the frontier into components, reusing the previous update's
+/// components where nothing around them has changed.
+/** Components are found in the order of their first square, which is
+    also the order of the previous list, so the two lists can be merged.
+*/
+- (void)updateComponents
+{
+    JbFrontierComponent* oldComponents = mComponents;
+    size_t oldCount = mNumberOfComponents, old = 0;
+    size_t capacity = MAX(mComponentCapacity, (size_t)16);
+    JbFrontierComponent* components = (JbFrontierComponent*)malloc(capacity * sizeof(JbFrontierComponent));
+    size_t count = 0;
+    assert(components != NULL);
+
+    JbFillBitTable(&mVisited, NO);
+    size_t squaresCapacity = 64;
+    size_t* squares = (size_t*)malloc(squaresCapacity * sizeof(size_t));
+    assert(squares != NULL);
+    for (unsigned row = 0; row != mSize.rows; ++row)
+    {
+        const uint64_t* frontier = JbBitTableRow(&mFrontier, row);
+        const uint64_t* visited = JbBitTableRow(&mVisited, row);
+        for (unsigned w = 0; w != mFrontier.wordsPerRow; ++w)
+        {
+            // visited is updated by CollectComponent, so it must be read
+            // again for every bit.
+            uint64_t bits;
+            while ((bits = frontier[w] & ~visited[w]) != 0)
+            {
+                size_t start = (size_t)row * mSize.columns + w * 64 + __builtin_ctzll(bits);
+                JbFrontierComponent component;
+                component.firstSquare = start;
+                component.count = CollectComponent(&mCovered, &mVisited, start,
+                                                   &squares, &squaresCapacity);
+                component.squares = squares;
+
+                while (old != oldCount && oldComponents[old].firstSquare < start)
+                    FreeComponent(&oldComponents[old++]);
+                if (old != oldCount
+                    && oldComponents[old].firstSquare == start
+                    && oldComponents[old].count == component.count
+                    && ![self isDirty:&component])
+                {
+                    component = oldComponents[old++];
+                }
+                else
+                {
+                    component.squares = (size_t*)malloc(component.count * sizeof(size_t));
+                    assert(component.squares != NULL);
+                    memcpy(component.squares, squares, component.count * sizeof(size_t));
+                    EnumerateComponent(&component, &mCovered, mNumbers, &mListed,
+                                       mLocalIndices);
+                    ++mNumberOfEnumerations;
+                }
+
+                if (count == capacity)
+                {
+                    capacity *= 2;
+                    components = (JbFrontierComponent*)realloc(components, capacity * sizeof(JbFrontierComponent));
+                    assert(components != NULL);
+                }
+                components[count++] = component;
+            }
+        }
+    }
+    free(squares);
+    while (old != oldCount)
+        FreeComponent(&oldComponents[old++]);
+    free(oldComponents);
+
+    mComponents = components;
+    mNumberOfComponents = count;
+    mComponentCapacity = capacity;
+}
+
+- (void)updateWithCovered:(const JbBitTable*)covered
+           minedNeighbors:(const uint8_t*)minedNeighbors
+{
+    assert(mProbabilities != NULL);
+    if (![self copyCovered:covered minedNeighbors:minedNeighbors] && mIsUpToDate)
+        return;
+
+    ComputeFrontier(&mCovered, &mScratch, &mFrontier);
+    [self updateComponents];
+    JbFillBitTable(&mDirty, NO);
+
+    size_t coveredSquares = JbCountBits(&mCovered);
+    size_t interior = coveredSquares - JbCountBits(&mFrontier);
+    double interiorProbability = CombineComponents(mComponents, mNumberOfComponents,
+                                                   (unsigned)interior, mNumberOfMines,
+                                                   mProbabilities);
+    if (interiorProbability < 0)
+    {
+        // The numbers contradict the number of mines. This can't happen in
+        // a real minefield; fall back to an even spread.
+        interiorProbability = coveredSquares != 0 ? (double)mNumberOfMines / coveredSquares : 0;
+        for (unsigned row = 0; row != mSize.rows; ++row)
+            for (unsigned col = 0; col != mSize.columns; ++col)
+                if (JbGetBit(&mFrontier, row, col))
+                    mProbabilities[(size_t)row * mSize.columns + col] = interiorProbability;
+    }
+
+    for (unsigned row = 0; row != mSize.rows; ++row)
+    {
+        double* probabilities = &mProbabilities[(size_t)row * mSize.columns];
+        for (unsigned col = 0; col != mSize.columns; ++col)
+        {
+            if (!JbGetBit(&mCovered, row, col))
+                probabilities[col] = 0;
+            else if (!JbGetBit(&mFrontier, row, col))
+                probabilities[col] = interiorProbability;
+        }
+    }
+    mIsUpToDate = YES;
+}
+
+- (void)updateWithMines:(const JbBitTable*)mines
+{
+    assert(mProbabilities != NULL);
+    assert(mines->rows == mSize.rows && mines->columns == mSize.columns);
+    for (unsigned row = 0; row != mSize.rows; ++row)
+        for (unsigned col = 0; col != mSize.columns; ++col)
+            mProbabilities[(size_t)row * mSize.columns + col] = JbGetBit(mines, row, col) ? 1 : 0;
+    [self clear];
+}
+
+- (double)probabilityAt:(JbTableIndex)idx
+{
+    assert(idx.row < mSize.rows && idx.column < mSize.columns);
+    return mProbabilities[(size_t)idx.row * mSize.columns + idx.column];
+}
+
+- (const double*)probabilities
+{
+    return mProbabilities;
+}
+
+- (unsigned long)numberOfEnumerations
+{
+    return mNumberOfEnumerations;
+}
+
+@end
@@ -0,0 +1,203 @@
+//
+//  MineProbabilitiesUnitTest.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MineProbabilitiesUnitTest.h"
+#import <SenTestingKit/SenTestCase.h>
+#import "MineProbabilities.h"
+#import "Random.h"
+
+enum {SmallRows = 5, SmallColumns = 6, SmallMines = 5};
+
+/// The state of a brute-force count of mine arrangements.
+typedef struct
+{
+    const JbBitTable* covered;
+    const uint8_t* numbers;
+    JbBitTable mines;
+    uint8_t* minedNeighbors;
+    /// counts[i] is the number of arrangements with a mine in square i.
+    double* counts;
+    double total;
+} BruteForceCount;
+
+/// Places @a mines mines in the covered squares from @a square onwards in
+/// every possible way, and counts the arrangements that fit the numbers of
+/// the uncovered squares.
+static void CountArrangements(BruteForceCount* count, size_t square, unsigned mines)
+{
+    unsigned columns = count->covered->columns;
+    size_t squares = (size_t)count->covered->rows * columns;
+    if (mines == 0)
+    {
+        JbCountNeighborBits(&count->mines, count->minedNeighbors);
+        for (size_t i = 0; i != squares; ++i)
+        {
+            if (!JbGetBit(count->covered, i / columns, i % columns)
+                && JbGetNibble(count->minedNeighbors, i) != JbGetNibble(count->numbers, i))
+                return;
+        }
+        count->total += 1;
+        for (size_t i = 0; i != squares; ++i)
+        {
+            if (JbGetBit(&count->mines, i / columns, i % columns))
+                count->counts[i] += 1;
+        }
+        return;
+    }
+
+    for (size_t i = square; i != squares; ++i)
+    {
+        if (!JbGetBit(count->covered, i / columns, i % columns))
+            continue;
+        JbSetBit(&count->mines, i / columns, i % columns);
+        CountArrangements(count, i + 1, mines - 1);
+        JbClearBit(&count->mines, i / columns, i % columns);
+    }
+}
+
+@implementation JbMineProbabilitiesUnitTest
+
+- (void)testMatchesBruteForceOnSmallBoards
+{
+    JbTableSize size = JbMakeTableSize(SmallRows, SmallColumns);
+    size_t squares = SmallRows * SmallColumns;
+    JbBitTable mines, covered;
+    BruteForceCount count;
+    BOOL success = JbInitBitTable(&mines, SmallRows, SmallColumns)
+                   && JbInitBitTable(&covered, SmallRows, SmallColumns)
+                   && JbInitBitTable(&count.mines, SmallRows, SmallColumns);
+    uint8_t* numbers = calloc(JbNibbleArraySize(squares), 1);
+    count.minedNeighbors = calloc(JbNibbleArraySize(squares), 1);
+    count.counts = malloc(squares * sizeof(double));
+    STAssertTrue(success && numbers != NULL && count.minedNeighbors != NULL
+                 && count.counts != NULL, @"Unable to allocate memory");
+    count.covered = &covered;
+    count.numbers = numbers;
+
+    JbRandom random;
+    JbSeedRandom(&random, 6);
+    for (unsigned board = 0; board != 50; ++board)
+    {
+        JbFillBitTable(&mines, NO);
+        for (unsigned placed = 0; placed != SmallMines;)
+        {
+            unsigned row = (unsigned)JbRandomBelow(&random, SmallRows);
+            unsigned col = (unsigned)JbRandomBelow(&random, SmallColumns);
+            if (!JbGetBit(&mines, row, col))
+            {
+                JbSetBit(&mines, row, col);
+                ++placed;
+            }
+        }
+        JbCountNeighborBits(&mines, numbers);
+        JbFillBitTable(&covered, YES);
+        for (unsigned i = 0; i != 4; ++i)
+        {
+            unsigned row = (unsigned)JbRandomBelow(&random, SmallRows);
+            unsigned col = (unsigned)JbRandomBelow(&random, SmallColumns);
+            if (!JbGetBit(&mines, row, col))
+                JbClearBit(&covered, row, col);
+        }
+
+        JbMineProbabilities* probabilities = [[JbMineProbabilities alloc]
+                                              initWithSize:size
+                                              numberOfMines:SmallMines];
+        [probabilities updateWithCovered:&covered minedNeighbors:numbers];
+        JbFillBitTable(&count.mines, NO);
+        memset(count.counts, 0, squares * sizeof(double));
+        count.total = 0;
+        CountArrangements(&count, 0, SmallMines);
+
+        for (unsigned row = 0; row != SmallRows; ++row)
+        {
+            for (unsigned col = 0; col != SmallColumns; ++col)
+            {
+                double expected = 0;
+                if (JbGetBit(&covered, row, col))
+                    expected = count.counts[row * SmallColumns + col] / count.total;
+                STAssertEqualsWithAccuracy([probabilities probabilityAt:JbMakeTableIndex(row, col)],
+                                           expected, 1e-9,
+                                           @"Wrong probability at (%u, %u) on board %u",
+                                           row, col, board);
+            }
+        }
+        [probabilities release];
+    }
+
+    free(count.counts);
+    free(count.minedNeighbors);
+    free(numbers);
+    JbFreeBitTable(&count.mines);
+    JbFreeBitTable(&covered);
+    JbFreeBitTable(&mines);
+}
+
+- (void)testLongComponentDoesNotOverflow
+{
+    // Row 1 is uncovered and every column has one mine, in row 0 or row 2.
+    // That gives 2^1100 arrangements, more than a double can hold. The
+    // remaining mines are in row 3, which isn't next to any number.
+    enum {Rows = 4, Columns = 1100, InteriorMines = 110};
+    JbBitTable covered;
+    BOOL success = JbInitBitTable(&covered, Rows, Columns);
+    uint8_t* numbers = calloc(JbNibbleArraySize(Rows * Columns), 1);
+    STAssertTrue(success && numbers != NULL, @"Unable to allocate memory");
+    JbFillBitTable(&covered, YES);
+    for (unsigned col = 0; col != Columns; ++col)
+    {
+        JbClearBit(&covered, 1, col);
+        JbSetNibble(numbers, Columns + col, col == 0 || col == Columns - 1 ? 2 : 3);
+    }
+
+    JbMineProbabilities* probabilities = [[JbMineProbabilities alloc]
+                                          initWithSize:JbMakeTableSize(Rows, Columns)
+                                          numberOfMines:Columns + InteriorMines];
+    [probabilities updateWithCovered:&covered minedNeighbors:numbers];
+    for (unsigned row = 0; row != Rows; ++row)
+    {
+        double expected = 0.5;
+        if (row == 1)
+            expected = 0;
+        else if (row == 3)
+            expected = (double)InteriorMines / Columns;
+        for (unsigned col = 0; col != Columns; ++col)
+        {
+            STAssertEqualsWithAccuracy([probabilities probabilityAt:JbMakeTableIndex(row, col)],
+                                       expected, 1e-9,
+                                       @"Wrong probability at (%u, %u)", row, col);
+        }
+    }
+
+    [probabilities release];
+    free(numbers);
+    JbFreeBitTable(&covered);
+}
+
+@end
@@ -28,9 +28,17 @@
 //  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 //  OTHER DEALINGS IN THE SOFTWARE.
 
-#import <Cocoa/Cocoa.h>
-#import "Minefield.h"
+#import <Foundation/Foundation.h>
+#import "BitTable.h"
+#import "Random.h"
 #import "TableIndexList.h"
+#import "TableSpanList.h"
+
+@class JbBoardPool;
+@class JbMineProbabilities;
+@class JbMinefieldSnapshot;
+@class JbMoveJournal;
+struct JbMinefieldCheckpointStruct;
 
 typedef enum 
 {
@@ -48,9 +56,94 @@ typedef enum
     JbBlownUp
 } JbMinefieldState;
 
+/// The bit planes the squares are stored in.
+typedef enum
+{
+    JbMinefieldMinePlane,
+    JbMinefieldCoveredPlane,
+    JbMinefieldMarkedPlane,
+    JbMinefieldQuestionMarkedPlane,
+    JbMinefieldNumberOfPlanes
+} JbMinefieldPlane;
+
+/// What the player sees in a square.
+typedef struct JbMinefieldSquareStruct
+{
+    JbMinefieldSquareState state;
+    BOOL hasMine;
+    uint8_t minedNeighbors;
+} JbMinefieldSquare;
+
+/// Measures of how much work it takes to clear a minefield.
+typedef struct JbMinefieldMetricsStruct
+{
+    /// The number of openings, i.e. connected regions of squares without
+    /// mined neighbors.
+    unsigned openings;
+    /// The number of squares without mines that aren't uncovered by any
+    /// opening.
+    unsigned isolatedNumbers;
+    /// The 3BV: the least number of clicks that uncovers the minefield
+    /// without marking, one per opening and one per isolated number.
+    unsigned bbbv;
+    /// An estimate of the least number of clicks with marking and smart
+    /// uncover (ZiNi). Never more than the 3BV.
+    unsigned zini;
+} JbMinefieldMetrics;
+
+/// The state of a minefield and the rules for uncovering and marking it.
+/** Squares are stored as bit planes, one bit per square for mines, covered
+    squares, marks and question marks. The numbers of mined, covered, marked
+    and question-marked neighbors are stored in a nibble per square each.
+    The last three are updated for the eight neighbors whenever a square
+    changes, so the rules that look at a square's surroundings never need to
+    visit them.
+
+    The mined, marked and question-marked squares are also kept in lists, so
+    that revealing the minefield, marking the remaining mines and removing
+    all question marks only visit the squares concerned. A square is in at
+    most one of the mark lists, and its position there is stored in a
+    shared array, so a mark is removed in constant time. A square needs
+    about six and a half bytes in total.
+
+    When the mines are placed, the openings (connected regions of squares
+    without mined neighbors) are found with union-find, along with the
+    minefield's 3BV. The first time an opening is uncovered, the squares
+    each of them uncovers are stored in one array. Uncovering an empty
+    square then opens its whole region in one pass over that array, unless
+    some of its squares have been marked or uncovered already. This takes
+    another four bytes per square, plus the regions.
+
+    Minefields have no state in common: each has its own random number
+    generator, buffers and lists, and the board pool is thread-safe.
+    Different minefields can therefore be used by different threads at the
+    same time, but each minefield must only be used by one thread at a
+    time. The methods that take a collector of affected squares don't
+    autorelease their results. JbSessionManager hosts many games this way.
+*/
 @interface JbMinefield : NSObject
 {
-    struct JbMinefieldSquareStruct** mSquares;
+    JbBitTable mMines;
+    JbBitTable mCovered;
+    JbBitTable mMarked;
+    JbBitTable mQuestionMarked;
+    uint8_t* mMinedNeighbors;
+    uint8_t* mCoveredNeighbors;
+    uint8_t* mMarkedNeighbors;
+    uint8_t* mQuestionMarkedNeighbors;
+    JbTableIndexList* mMineSquares;
+    JbTableIndexList* mMarkedSquares;
+    JbTableIndexList* mQuestionMarkedSquares;
+    uint32_t* mSquarePositions;
+    uint32_t* mOpeningLabels;
+    uint32_t* mOpeningStarts;
+    size_t mOpeningStartsCapacity;
+    JbTableIndex* mOpeningSquares;
+    size_t mOpeningSquaresCapacity;
+    uint32_t mNumberOfOpenings;
+    BOOL mHasOpeningSquares;
+    JbMinefieldMetrics mMetrics;
+    BOOL mIsZiniEstimated;
     JbTableSize mSize;
     unsigned mNumberOfMines;
     unsigned mNumberOfCoveredSquares;
@@ -60,7 +153,23 @@ typedef enum
     BOOL mUsesSmartMark;
     BOOL mUsesQuestionMarks;
     JbMinefieldState mState;
-    // JbTableIndexList mAffectedSquares;
+    JbTableIndex* mFrontier;
+    size_t mFrontierCapacity;
+    uint64_t mSeed;
+    JbRandom mSeedGenerator;
+    JbMineProbabilities* mMineProbabilities;
+    BOOL mUsesNoGuessBoards;
+    double mGenerationTime;
+    uint64_t mNumberOfGenerationAttempts;
+    JbTableIndex mPlacementSquare;
+    JbBoardPool* mBoardPool;
+    JbMoveJournal* mJournal;
+    uint64_t* mUndoLog;
+    size_t mUndoLogSize;
+    size_t mUndoLogCapacity;
+    struct JbMinefieldCheckpointStruct* mCheckpoints;
+    unsigned mNumberOfCheckpoints;
+    size_t mCheckpointsCapacity;
 }
 
 - (id)initWithSize:(JbTableSize)size numberOfMines:(unsigned)mines;
@@ -70,11 +179,59 @@ typedef enum
 - (void)setSize:(JbTableSize)size numberOfMines:(unsigned)mines;
 
 - (unsigned)numberOfMines;
+
+/// The seed the mines of the current game are placed with.
+/** A new seed is drawn from the minefield's own generator every time the
+    minefield is cleared. Mines are placed when the first square is
+    uncovered, and the minefield is fully determined by its size, number of
+    mines, easy start setting, seed and placementSquare.
+*/
+- (uint64_t)seed;
+/// Replaces the seed of a game that hasn't been started yet.
+- (void)setSeed:(uint64_t)seed;
+/// The square the mines were placed around.
+/** This is the first uncovered square, unless the game was started with
+    placeMinesAroundSquare:.
+*/
+- (JbTableIndex)placementSquare;
+/// Places the mines with the current seed, leaving the square at @a idx
+/// (and its neighbors if easy start is enabled) without mines.
+/** This starts the game without uncovering anything. uncoverAt: calls it
+    for the first square unless the game has already been started.
+*/
+- (void)placeMinesAroundSquare:(JbTableIndex)idx;
+
+/// The pool the minefield is taken from when the first square is uncovered.
+/** If the pool has no suitable minefield, the minefield is generated as
+    usual. The default is nil.
+*/
+- (JbBoardPool*)boardPool;
+- (void)setBoardPool:(JbBoardPool*)boardPool;
+/// The journal the moves are recorded in.
+/** The journal is cleared when the minefield is, and started when the
+    mines are placed. The default is nil.
+*/
+- (JbMoveJournal*)journal;
+- (void)setJournal:(JbMoveJournal*)journal;
 /** True if the squares surrounding the first uncovered square are
     guaranteed to be without mines.
 */
 - (BOOL)usesEasyStart;
 - (void)setUsesEasyStart:(BOOL)newUsesEasyStart;
+
+/// True if the mines are placed so the game can be won without guessing.
+/** The seed is then replaced by the seed of the first candidate minefield
+    JbMinefieldSolver could complete from the first uncovered square (see
+    JbNoGuessGenerator). If no such minefield is found, the mines are
+    placed as usual.
+*/
+- (BOOL)usesNoGuessBoards;
+- (void)setUsesNoGuessBoards:(BOOL)newUsesNoGuessBoards;
+/// The time it took to find a minefield without guessing for the current
+/// game, or 0.
+- (double)generationTime;
+/// The number of candidate minefields that were tried for the current game.
+- (uint64_t)numberOfGenerationAttempts;
 - (BOOL)usesSmartUncover;
 - (void)setUsesSmartUncover:(BOOL)newUsesSmartUncover;
 - (BOOL)usesSmartMark;
@@ -86,17 +243,119 @@ typedef enum
 */
 - (BOOL)usesQuestionMarks;
 - (JbTableIndexList*)setUsesQuestionMarks:(BOOL)newUsesQuestionMarks;
+- (void)setUsesQuestionMarks:(BOOL)newUsesQuestionMarks
+             affectedSquares:(id<JbTableIndexCollector>)affectedSquares;
 
 - (JbMinefieldState)state;
 
 - (unsigned)numberOfCoveredSquares;
 - (unsigned)numberOfMarkedSquares;
 
+/// The minefield's 3BV, openings and other metrics.
+/** They are computed when the mines are placed, except the ZiNi estimate,
+    which is made the first time the metrics are read. They are all 0 until
+    the game has been started.
+*/
+- (JbMinefieldMetrics)metrics;
+
+/// The mined squares, in no particular order.
+/** The list is empty until the game has been started, and must not be
+    modified.
+*/
+- (JbTableIndexList*)mineSquares;
+/// The marked squares, in no particular order. The list must not be
+/// modified.
+- (JbTableIndexList*)markedSquares;
+/// The question-marked squares, in no particular order. The list must not
+/// be modified.
+- (JbTableIndexList*)questionMarkedSquares;
+
+/// One of the bit planes the squares are stored in. The table must not be
+/// modified.
+- (const JbBitTable*)plane:(JbMinefieldPlane)plane;
+
+/// Replaces the current game with the one in @a snapshot.
+/** The minefield takes the snapshot's size, number of mines, seed and
+    placement square, but keeps its settings, as they only matter for
+    games that are started later. The neighbor counts, lists and openings
+    are derived from the planes.
+    @return NO, leaving the minefield cleared, if the snapshot's planes
+            contradict each other or its number of mines.
+*/
+- (BOOL)restoreFromSnapshot:(JbMinefieldSnapshot*)snapshot;
+
+/// Starts a sequence of moves that can be undone with rollBack.
+/** Solvers and hints use checkpoints to try moves and throw them away.
+    While there is a checkpoint, every square that changes is appended to
+    an undo log, and rolling back undoes the log's entries in reverse, so
+    a checkpoint and its rollback cost time in proportion to the number of
+    squares that changed, not to the size of the minefield. Once the log
+    has grown, neither allocates any memory.
+
+    Checkpoints nest: rollBack returns to the last one, and popCheckpoint
+    keeps the moves since the last one, which are then undone by the
+    previous checkpoint's rollback. The squares, the counts, the game's
+    state, the journal's moves and the smart uncover, smart mark and
+    question mark settings are rolled back. The game must have been
+    started, and clearing the minefield, changing its size or restoring a
+    snapshot removes all checkpoints.
+*/
+- (void)pushCheckpoint;
+/// Undoes the changes since the last checkpoint, and removes it.
+- (JbTableIndexList*)rollBack;
+/// Undoes the changes since the last checkpoint, and removes it.
+/** @a affectedSquares gets the squares that changed, possibly more than
+    once.
+*/
+- (void)rollBackWithAffectedSquares:(id<JbTableIndexCollector>)affectedSquares;
+/// Removes the last checkpoint without undoing the changes since it.
+- (void)popCheckpoint;
+- (unsigned)numberOfCheckpoints;
+
 - (BOOL)hasMineAt:(JbTableIndex)index;
 - (JbMinefieldSquareState)stateAt:(JbTableIndex)index;
 - (unsigned)countNeighborsWithMinesAt:(JbTableIndex)index;
+/// The number of covered neighbors of the square at @a index, including
+/// the marked and question-marked ones.
+- (unsigned)countCoveredNeighborsAt:(JbTableIndex)index;
+- (unsigned)countMarkedNeighborsAt:(JbTableIndex)index;
+- (unsigned)countQuestionMarkedNeighborsAt:(JbTableIndex)index;
+/// Gets the squares in @a span, one per column.
+/** A view that updates the squares affected by a move from a
+    JbTableSpanList gets all the squares of a span with one message.
+*/
+- (void)getSquares:(JbMinefieldSquare*)squares inSpan:(JbTableSpan)span;
 - (JbTableIndexList*)uncoverableAt:(JbTableIndex)index;
+- (void)uncoverableAt:(JbTableIndex)index
+      affectedSquares:(id<JbTableIndexCollector>)affectedSquares;
 
+/// The probability that the square at @a index has a mine, given what the
+/// player can see.
+/** The probability is exact, and computed from the uncovered squares, their
+    numbers and the number of mines. Marks are ignored, as they may be
+    wrong. Uncovered squares have probability 0, and when the game is over
+    the probabilities are 0 or 1.
+*/
+- (double)mineProbabilityAt:(JbTableIndex)index;
+/// The probabilities of all squares, row by row.
+/** The probabilities are recomputed when squares have been uncovered since
+    the last call, but only around those squares. The returned array is
+    valid until the next move.
+*/
+- (const double*)mineProbabilities;
+
+/** The methods that return a JbTableIndexList of affected squares create a
+    new list every time. Each has a variant that instead appends the squares
+    to @a affectedSquares, a list owned by the caller. A caller that empties
+    its list with removeAllValues before every move makes moves without
+    allocating any memory once the list has grown large enough. A
+    JbTableSpanList stores an opening as one span per row instead of one
+    index per square.
+*/
 - (JbTableIndexList*)markAt:(JbTableIndex)index;
+- (void)markAt:(JbTableIndex)index
+    affectedSquares:(id<JbTableIndexCollector>)affectedSquares;
 - (JbTableIndexList*)uncoverAt:(JbTableIndex)index;
+- (void)uncoverAt:(JbTableIndex)index
+  affectedSquares:(id<JbTableIndexCollector>)affectedSquares;
 @end
@@ -29,14 +29,14 @@
 //  OTHER DEALINGS IN THE SOFTWARE.
 
 #import "Minefield.h"
+#import "BoardPool.h"
+#import "MineProbabilities.h"
+#import "MinefieldSnapshot.h"
+#import "MoveJournal.h"
+#import "NoGuessGenerator.h"
+#import <assert.h>
 #import <stdlib.h>
-
-typedef struct JbMinefieldSquareStruct
-{
-    BOOL hasMine;
-    unsigned minedNeighbors;
-    JbMinefieldSquareState state;
-} JbMinefieldSquare;
+#import <string.h>
 
 typedef struct
 {
@@ -47,23 +47,261 @@ typedef struct
     unsigned minedNeighbors;
 } JbNeighborStatistics;
 
-static JbMinefieldSquare** AllocMinefieldSquareTable(JbTableSize size);
+/// The changes to a square that the undo log records.
+typedef enum
+{
+    JbUncoverChange,
+    JbSetMarkChange,
+    JbClearMarkChange,
+    JbSetQuestionMarkChange,
+    JbClearQuestionMarkChange
+} JbSquareChange;
+
+/// An undo log entry is a square's position, row by row, shifted left by
+/// this many bits, or'ed with the change.
+enum {SquareChangeBits = 3};
+
+struct JbMinefieldCheckpointStruct
+{
+    size_t undoLogSize;
+    size_t numberOfJournalMoves;
+    unsigned numberOfCoveredSquares;
+    unsigned numberOfMarkedSquares;
+    JbMinefieldState state;
+    BOOL usesSmartUncover;
+    BOOL usesSmartMark;
+    BOOL usesQuestionMarks;
+};
+typedef struct JbMinefieldCheckpointStruct JbMinefieldCheckpoint;
+
+static void GrowFrontier(JbTableIndex** frontier, size_t* capacity);
+static void* GrowArray(void* array, size_t* capacity, size_t count, size_t elementSize);
+
+/// Returns the root of the square with linear index @a i in a union-find
+/// forest where parents[i] is the parent's index plus one.
+static inline uint32_t FindOpeningRoot(uint32_t* parents, uint32_t i)
+{
+    while (parents[i] - 1 != i)
+    {
+        parents[i] = parents[parents[i] - 1];
+        i = parents[i] - 1;
+    }
+    return i;
+}
+
+/// Joins the trees of @a a and @a b, making the smaller root the root of
+/// both, so every parent has a smaller index than its children.
+static inline void UniteOpenings(uint32_t* parents, uint32_t a, uint32_t b)
+{
+    a = FindOpeningRoot(parents, a);
+    b = FindOpeningRoot(parents, b);
+    if (a < b)
+        parents[b] = a + 1;
+    else if (b < a)
+        parents[a] = b + 1;
+}
+
+/// Maps @a i, an index that counts only the squares that are not in
+/// @a excluded, to the linear index of the corresponding square.
+/** @a excluded must be sorted in ascending order.
+*/
+static inline size_t SkipExcludedSquares(size_t i,
+                                         const size_t* excluded,
+                                         unsigned excludedCount)
+{
+    for (unsigned k = 0; k != excludedCount && excluded[k] <= i; ++k)
+        ++i;
+    return i;
+}
+
+/// Adds @a delta to the nibbles in @a counts of the neighbors of the square
+/// at @a idx.
+static inline void AddToNeighborCounts(uint8_t* counts,
+                                       JbTableSize size,
+                                       JbTableIndex idx,
+                                       int delta)
+{
+    unsigned rowBegin = idx.row != 0 ? idx.row - 1 : 0;
+    unsigned rowEnd = MIN(idx.row + 2, size.rows);
+    unsigned colBegin = idx.column != 0 ? idx.column - 1 : 0;
+    unsigned colEnd = MIN(idx.column + 2, size.columns);
+    for (unsigned row = rowBegin; row != rowEnd; ++row)
+    {
+        size_t rowStart = (size_t)row * size.columns;
+        for (unsigned col = colBegin; col != colEnd; ++col)
+        {
+            if (row == idx.row && col == idx.column)
+                continue;
+            JbSetNibble(counts, rowStart + col,
+                        JbGetNibble(counts, rowStart + col) + delta);
+        }
+    }
+}
+
+static inline unsigned CountNeighbors(JbTableSize size, JbTableIndex idx)
+{
+    unsigned rows = MIN(idx.row + 2, size.rows) - (idx.row != 0 ? idx.row - 1 : 0);
+    unsigned cols = MIN(idx.column + 2, size.columns) - (idx.column != 0 ? idx.column - 1 : 0);
+    return rows * cols - 1;
+}
+
+static inline JbTableIterator NeighborIterator(JbTableSize size, JbTableIndex idx)
+{
+    unsigned rowBegin = idx.row - 1;
+    unsigned colBegin = idx.column - 1;
+    unsigned rowEnd = idx.row + 2;
+    unsigned colEnd = idx.column + 2;
+
+    if (rowBegin >= size.rows) rowBegin = 0;
+    if (colBegin >= size.columns) colBegin = 0;
+    if (rowEnd > size.rows) rowEnd = size.rows;
+    if (colEnd > size.columns) colEnd = size.columns;
+
+    return JbMakeTableIterator(rowBegin, colBegin, rowEnd, colEnd);
+}
+
+/// Puts the distinct opening labels of the square at @a idx and its
+/// neighbors in @a found and returns how many there are.
+static inline unsigned FindAdjacentOpenings(const uint32_t* labels,
+                                            JbTableSize size,
+                                            JbTableIndex idx,
+                                            uint32_t found[9])
+{
+    const uint32_t* square = labels + (size_t)idx.row * size.columns + idx.column;
+    // An empty square's neighbors are all in its own opening.
+    if (*square != 0)
+    {
+        found[0] = *square;
+        return 1;
+    }
+
+    unsigned rowBegin = idx.row != 0 ? idx.row - 1 : 0;
+    unsigned rowEnd = MIN(idx.row + 2, size.rows);
+    unsigned colBegin = idx.column != 0 ? idx.column - 1 : 0;
+    unsigned colEnd = MIN(idx.column + 2, size.columns);
+    unsigned foundCount = 0;
+    for (unsigned row = rowBegin; row != rowEnd; ++row)
+    {
+        const uint32_t* rowLabels = labels + (size_t)row * size.columns;
+        for (unsigned col = colBegin; col != colEnd; ++col)
+        {
+            uint32_t label = rowLabels[col];
+            if (label == 0)
+                continue;
+            unsigned k = 0;
+            while (k != foundCount && found[k] != label)
+                ++k;
+            if (k == foundCount)
+                found[foundCount++] = label;
+        }
+    }
+    return foundCount;
+}
+
+/// Returns word @a w of @a row in @a table, or 0 outside the table.
+static inline uint64_t GetWordOrZero(const JbBitTable* table, unsigned row, unsigned w)
+{
+    if (row >= table->rows || w >= table->wordsPerRow)
+        return 0;
+    return JbBitTableRow(table, row)[w];
+}
+
+/// Returns word @a w of @a row with the bits of the squares that are in
+/// @a table or have a neighbor in it. Bits past the last column may be set.
+static inline uint64_t GetDilatedWord(const JbBitTable* table, unsigned row, unsigned w)
+{
+    uint64_t result = 0;
+    for (unsigned r = row - 1; r != row + 2; ++r)
+    {
+        uint64_t word = GetWordOrZero(table, r, w);
+        result |= word | (word << 1) | (word >> 1)
+                  | (GetWordOrZero(table, r, w - 1) >> 63)
+                  | (GetWordOrZero(table, r, w + 1) << 63);
+    }
+    return result;
+}
+
+/// Returns word @a w of @a row with the bits past the last column cleared.
+static inline uint64_t MaskColumns(const JbBitTable* table, unsigned w, uint64_t word)
+{
+    unsigned columnsInWord = MIN(64, table->columns - w * 64);
+    return columnsInWord != 64 ? word & (((uint64_t)1 << columnsInWord) - 1) : word;
+}
+
+/// The empty squares (neither mined nor next to a mine) in word @a w of
+/// @a row, or 0 outside the table.
+static inline uint64_t GetEmptyWord(const JbBitTable* mines, unsigned row, unsigned w)
+{
+    if (row >= mines->rows || w >= mines->wordsPerRow)
+        return 0;
+    return MaskColumns(mines, w, ~GetDilatedWord(mines, row, w));
+}
+
+/// The squares in the openings' regions, i.e. the empty squares and their
+/// neighbors, in word @a w of @a row.
+static inline uint64_t GetRegionWord(const JbBitTable* mines, unsigned row, unsigned w)
+{
+    uint64_t result = 0;
+    for (unsigned r = row - 1; r != row + 2; ++r)
+    {
+        uint64_t word = GetEmptyWord(mines, r, w);
+        result |= word | (word << 1) | (word >> 1)
+                  | (GetEmptyWord(mines, r, w - 1) >> 63)
+                  | (GetEmptyWord(mines, r, w + 1) << 63);
+    }
+    return MaskColumns(mines, w, result);
+}
 
 static inline BOOL NextNeighbor(JbTableIterator* it, JbTableIndex idx)
 {
     if (!JbTableIteratorNext(it))
         return NO;
-    
+
     if (!JbEqualTableIndexes(it->index, idx))
         return YES;
-    
-    return JbTableIteratorNext(it); 
+
+    return JbTableIteratorNext(it);
+}
+
+static inline JbMinefieldSquareState GetSquareState(const JbBitTable* covered,
+                                                    const JbBitTable* marked,
+                                                    const JbBitTable* questionMarked,
+                                                    JbTableIndex idx)
+{
+    if (!JbGetBit(covered, idx.row, idx.column))
+        return JbUncovered;
+    else if (JbGetBit(marked, idx.row, idx.column))
+        return JbMarked;
+    else if (JbGetBit(questionMarked, idx.row, idx.column))
+        return JbQuestionMarked;
+    else
+        return JbUnmarked;
 }
 
-static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
-                                           JbTableIterator* it)
+/// Returns YES if no square is both marked and question-marked, no
+/// uncovered square is marked, and the bits past the last column are 0.
+static BOOL HasConsistentStates(const JbBitTable* covered,
+                                const JbBitTable* marked,
+                                const JbBitTable* questionMarked,
+                                const JbBitTable* mines)
 {
-    return &table[it->index.row][it->index.column];
+    unsigned lastBits = covered->columns & 63;
+    uint64_t lastMask = lastBits == 0 ? ~(uint64_t)0 : ((uint64_t)1 << lastBits) - 1;
+    for (unsigned row = 0; row != covered->rows; ++row)
+    {
+        const uint64_t* c = JbBitTableRow(covered, row);
+        const uint64_t* m = JbBitTableRow(marked, row);
+        const uint64_t* q = JbBitTableRow(questionMarked, row);
+        const uint64_t* x = JbBitTableRow(mines, row);
+        for (unsigned w = 0; w != covered->wordsPerRow; ++w)
+        {
+            uint64_t mask = w + 1 == covered->wordsPerRow ? lastMask : ~(uint64_t)0;
+            if ((m[w] & q[w]) != 0 || ((m[w] | q[w]) & ~c[w]) != 0
+                || ((c[w] | x[w]) & ~mask) != 0)
+                return NO;
+        }
+    }
+    return YES;
 }
 
 @implementation JbMinefield
@@ -73,7 +311,27 @@ static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
     self = [super init];
     if (self != nil)
     {
-        mSquares = nil;
+        memset(&mMines, 0, sizeof(mMines));
+        memset(&mCovered, 0, sizeof(mCovered));
+        memset(&mMarked, 0, sizeof(mMarked));
+        memset(&mQuestionMarked, 0, sizeof(mQuestionMarked));
+        mMinedNeighbors = NULL;
+        mCoveredNeighbors = NULL;
+        mMarkedNeighbors = NULL;
+        mQuestionMarkedNeighbors = NULL;
+        mMineSquares = [[JbTableIndexList alloc] init];
+        mMarkedSquares = [[JbTableIndexList alloc] init];
+        mQuestionMarkedSquares = [[JbTableIndexList alloc] init];
+        mSquarePositions = NULL;
+        mOpeningLabels = NULL;
+        mOpeningStarts = NULL;
+        mOpeningStartsCapacity = 0;
+        mOpeningSquares = NULL;
+        mOpeningSquaresCapacity = 0;
+        mNumberOfOpenings = 0;
+        mHasOpeningSquares = NO;
+        memset(&mMetrics, 0, sizeof(mMetrics));
+        mIsZiniEstimated = YES;
         mSize = JbMakeTableSize(0, 0);
         mNumberOfMines = 0;
         mNumberOfCoveredSquares = 0;
@@ -83,10 +341,67 @@ static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
         mUsesSmartMark = YES;
         mUsesQuestionMarks = YES;
         mState = JbNotStarted;
+        mFrontier = NULL;
+        mFrontierCapacity = 0;
+        mMineProbabilities = nil;
+        mUsesNoGuessBoards = NO;
+        mGenerationTime = 0;
+        mNumberOfGenerationAttempts = 0;
+        mPlacementSquare = JbMakeTableIndex(0, 0);
+        mBoardPool = nil;
+        mJournal = nil;
+        mUndoLog = NULL;
+        mUndoLogSize = 0;
+        mUndoLogCapacity = 0;
+        mCheckpoints = NULL;
+        mNumberOfCheckpoints = 0;
+        mCheckpointsCapacity = 0;
+        JbSeedRandom(&mSeedGenerator, JbMakeRandomSeed());
+        mSeed = JbNextRandom(&mSeedGenerator);
     }
     return self;
 }
 
+- (void)freeSquares
+{
+    JbFreeBitTable(&mMines);
+    JbFreeBitTable(&mCovered);
+    JbFreeBitTable(&mMarked);
+    JbFreeBitTable(&mQuestionMarked);
+    free(mMinedNeighbors);
+    free(mCoveredNeighbors);
+    free(mMarkedNeighbors);
+    free(mQuestionMarkedNeighbors);
+    free(mSquarePositions);
+    free(mOpeningLabels);
+    mSquarePositions = NULL;
+    mOpeningLabels = NULL;
+    mMinedNeighbors = NULL;
+    mCoveredNeighbors = NULL;
+    mMarkedNeighbors = NULL;
+    mQuestionMarkedNeighbors = NULL;
+}
+
+- (void)allocSquares:(JbTableSize)size
+{
+    assert(size.rows != 0 && size.columns != 0);
+    BOOL success = JbInitBitTable(&mMines, size.rows, size.columns)
+                   && JbInitBitTable(&mCovered, size.rows, size.columns)
+                   && JbInitBitTable(&mMarked, size.rows, size.columns)
+                   && JbInitBitTable(&mQuestionMarked, size.rows, size.columns);
+    size_t nibbleArraySize = JbNibbleArraySize((size_t)size.rows * size.columns);
+    mMinedNeighbors = (uint8_t*)malloc(nibbleArraySize);
+    mCoveredNeighbors = (uint8_t*)malloc(nibbleArraySize);
+    mMarkedNeighbors = (uint8_t*)malloc(nibbleArraySize);
+    mQuestionMarkedNeighbors = (uint8_t*)malloc(nibbleArraySize);
+    mSquarePositions = (uint32_t*)malloc((size_t)size.rows * size.columns * sizeof(uint32_t));
+    mOpeningLabels = (uint32_t*)malloc((size_t)size.rows * size.columns * sizeof(uint32_t));
+    NSAssert(success && mMinedNeighbors != NULL && mCoveredNeighbors != NULL
+             && mMarkedNeighbors != NULL && mQuestionMarkedNeighbors != NULL
+             && mSquarePositions != NULL && mOpeningLabels != NULL,
+             @"Unable to allocate memory for the minefield");
+}
+
 - (id)initWithSize:(JbTableSize)size numberOfMines:(unsigned)mines
 {
     assert(size.rows > 0 && size.columns > 0);
@@ -94,7 +409,7 @@ static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
     if (self)
     {
         mSize = size;
-        mSquares = AllocMinefieldSquareTable(size);
+        [self allocSquares:size];
         mNumberOfMines = mines;
         [self clear];
     }
@@ -103,24 +418,53 @@ static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
 
 - (void)dealloc
 {
-    if (mSquares != nil)
-        free(mSquares);
+    [self freeSquares];
+    if (mFrontier != NULL)
+        free(mFrontier);
+    free(mOpeningStarts);
+    free(mOpeningSquares);
+    free(mUndoLog);
+    free(mCheckpoints);
+    [mMineProbabilities release];
+    [mBoardPool release];
+    [mJournal release];
+    [mMineSquares release];
+    [mMarkedSquares release];
+    [mQuestionMarkedSquares release];
     [super dealloc];
 }
 
 - (void)clear
 {
-    assert(mSquares != nil);
-    JbMinefieldSquare* end = &mSquares[mSize.rows - 1][mSize.columns];
-    for (JbMinefieldSquare* it = &mSquares[0][0]; it != end; ++it)
-    {
-        it->hasMine = NO;
-        it->minedNeighbors = 0;
-        it->state = JbUnmarked;
-    }
+    assert(mMinedNeighbors != NULL);
+    JbFillBitTable(&mMines, NO);
+    JbFillBitTable(&mCovered, YES);
+    JbFillBitTable(&mMarked, NO);
+    JbFillBitTable(&mQuestionMarked, NO);
+    size_t nibbleArraySize = JbNibbleArraySize((size_t)mSize.rows * mSize.columns);
+    memset(mMinedNeighbors, 0, nibbleArraySize);
+    JbCountNeighborBits(&mCovered, mCoveredNeighbors);
+    memset(mMarkedNeighbors, 0, nibbleArraySize);
+    memset(mQuestionMarkedNeighbors, 0, nibbleArraySize);
+    [mMineSquares removeAllValues];
+    [mMarkedSquares removeAllValues];
+    [mQuestionMarkedSquares removeAllValues];
+    mNumberOfOpenings = 0;
+    mHasOpeningSquares = NO;
+    memset(&mMetrics, 0, sizeof(mMetrics));
+    mIsZiniEstimated = YES;
     mNumberOfCoveredSquares = mSize.rows * mSize.columns;
     mNumberOfMarkedSquares = 0;
     mState = JbNotStarted;
+    mSeed = JbNextRandom(&mSeedGenerator);
+    mGenerationTime = 0;
+    mNumberOfGenerationAttempts = 0;
+    mNumberOfCheckpoints = 0;
+    mUndoLogSize = 0;
+    // The cached probabilities belong to the previous game, and its covered
+    // squares may be the same as the next game's after the first move.
+    [mMineProbabilities clear];
+    [mJournal clear];
 }
 
 - (JbTableSize)size
@@ -132,11 +476,12 @@ static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
 {
     if (!JbEqualTableSizes(size, mSize) || mines != mNumberOfMines)
     {
-        if (mSquares != nil)
-            free(mSquares);
-        mSquares = AllocMinefieldSquareTable(size);
+        [self freeSquares];
+        [self allocSquares:size];
         mSize = size;
         mNumberOfMines = mines;
+        [mMineProbabilities release];
+        mMineProbabilities = nil;
         [self clear];
     }
     else if (mState != JbNotStarted)
@@ -148,76 +493,432 @@ static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
     return mNumberOfMines;
 }
 
-- (JbTableIterator)neighborIteratorAt:(JbTableIndex)idx
+- (uint64_t)seed
 {
-    unsigned rowBegin = idx.row - 1;
-    unsigned colBegin = idx.column - 1;
-    unsigned rowEnd = idx.row + 2;
-    unsigned colEnd = idx.column + 2;
+    return mSeed;
+}
 
-    if (rowBegin >= mSize.rows) rowBegin = 0;
-    if (colBegin >= mSize.columns) colBegin = 0;
-    if (rowEnd > mSize.rows) rowEnd = mSize.rows;
-    if (colEnd > mSize.columns) colEnd = mSize.columns;
-    
-    return JbMakeTableIterator(rowBegin, colBegin, rowEnd, colEnd);
+- (void)setSeed:(uint64_t)seed
+{
+    assert(mState == JbNotStarted);
+    mSeed = seed;
+}
+
+- (JbTableIndex)placementSquare
+{
+    return mPlacementSquare;
+}
+
+- (JbBoardPool*)boardPool
+{
+    return mBoardPool;
 }
 
-- (void)setHasMine:(BOOL)hasMine aroundFirstUncoveredSquareAt:(JbTableIndex)idx
+- (void)setBoardPool:(JbBoardPool*)boardPool
 {
-    if (mUsesEasyStart)
+    [boardPool retain];
+    [mBoardPool release];
+    mBoardPool = boardPool;
+}
+
+- (JbMoveJournal*)journal
+{
+    return mJournal;
+}
+
+- (void)setJournal:(JbMoveJournal*)journal
+{
+    [journal retain];
+    [mJournal release];
+    mJournal = journal;
+}
+
+/// Records a change of the settings that affect moves in a game that has
+/// been started.
+- (void)recordSettings
+{
+    if (mState == JbNotCompleted)
+        [mJournal recordSettingsOfMinefield:self];
+}
+
+/// Appends a change to the square at @a idx to the undo log. Must only be
+/// called while there is a checkpoint.
+- (void)logChange:(JbSquareChange)change at:(JbTableIndex)idx
+{
+    if (mUndoLogSize == mUndoLogCapacity)
+        mUndoLog = GrowArray(mUndoLog, &mUndoLogCapacity,
+                             MAX(mUndoLogSize + 1, 256), sizeof(uint64_t));
+    uint64_t square = (uint64_t)idx.row * mSize.columns + idx.column;
+    mUndoLog[mUndoLogSize++] = square << SquareChangeBits | change;
+}
+
+- (JbTableIterator)neighborIteratorAt:(JbTableIndex)idx
+{
+    return NeighborIterator(mSize, idx);
+}
+
+/// Finds the openings: the connected regions of empty squares, i.e. squares
+/// without mines or mined neighbors, and the minefield's 3BV.
+/** The empty squares are found a word at a time from the mine bits. Each
+    run of empty squares in a row is joined with union-find to the runs it
+    touches in the row above, and in a second pass each empty square is
+    given the number of its opening, plus one, in mOpeningLabels. As every
+    parent comes before its children, the second pass finds each parent
+    already labeled.
+
+    An opening's region is the squares that are uncovered when it is opened:
+    the empty squares and the squares around them. Squares that are in no
+    region are the isolated numbers. The regions themselves are only stored
+    by computeOpeningSquares.
+*/
+- (void)computeOpenings
+{
+    uint32_t* labels = mOpeningLabels;
+    unsigned columns = mSize.columns;
+    unsigned wordsPerRow = mMines.wordsPerRow;
+    size_t squares = (size_t)mSize.rows * columns;
+    memset(labels, 0, squares * sizeof(uint32_t));
+
+    // Give every run of empty squares in a row its first square as parent,
+    // and unite it with the runs it touches in the row above.
+    for (unsigned row = 0; row != mSize.rows; ++row)
+    {
+        size_t rowStart = (size_t)row * columns;
+        for (unsigned w = 0; w != wordsPerRow; ++w)
+        {
+            uint64_t empty = GetEmptyWord(&mMines, row, w);
+            while (empty != 0)
+            {
+                // Adding the lowest bit clears the lowest run of bits.
+                uint64_t run = empty & ~(empty + (empty & -empty));
+                empty &= ~run;
+                unsigned begin = w * 64 + __builtin_ctzll(run);
+                unsigned end = w * 64 + 64 - __builtin_clzll(run);
+                size_t first = rowStart + begin;
+                // A run that starts a word may continue the run that ends
+                // the previous one.
+                if (begin != 0 && begin % 64 == 0 && labels[first - 1] != 0)
+                    first = labels[first - 1] - 1;
+                for (size_t i = rowStart + begin; i != rowStart + end; ++i)
+                    labels[i] = (uint32_t)first + 1;
+
+                if (row == 0)
+                    continue;
+                const uint32_t* above = labels + rowStart - columns;
+                unsigned colBegin = begin != 0 ? begin - 1 : 0;
+                unsigned colEnd = MIN(end + 1, columns);
+                for (unsigned col = colBegin; col != colEnd; ++col)
+                {
+                    if (above[col] != 0 && (col == colBegin || above[col - 1] == 0))
+                        UniteOpenings(labels, (uint32_t)first,
+                                      (uint32_t)(rowStart - columns + col));
+                }
+            }
+        }
+    }
+
+    // Number the openings in the order of their first squares. Every parent
+    // comes before its children, so its label is final when they are reached.
+    mNumberOfOpenings = 0;
+    for (unsigned row = 0; row != mSize.rows; ++row)
     {
-        JbTableIterator it = [self neighborIteratorAt:idx];
-        while (JbTableIteratorNext(&it))
-            mSquares[it.index.row][it.index.column].hasMine = hasMine;
+        size_t rowStart = (size_t)row * columns;
+        for (unsigned w = 0; w != wordsPerRow; ++w)
+        {
+            for (uint64_t empty = GetEmptyWord(&mMines, row, w); empty != 0; empty &= empty - 1)
+            {
+                size_t i = rowStart + w * 64 + __builtin_ctzll(empty);
+                if (labels[i] - 1 == i)
+                    labels[i] = ++mNumberOfOpenings;
+                else
+                    labels[i] = labels[labels[i] - 1];
+            }
+        }
     }
-    else
+
+    // The squares that are neither mined nor in a region are the isolated
+    // numbers.
+    size_t regionSquares = 0;
+    for (unsigned row = 0; row != mSize.rows; ++row)
     {
-        mSquares[idx.row][idx.column].hasMine = hasMine;
+        for (unsigned w = 0; w != wordsPerRow; ++w)
+            regionSquares += __builtin_popcountll(GetRegionWord(&mMines, row, w));
     }
+    unsigned isolatedNumbers = (unsigned)(squares - JbCountBits(&mMines) - regionSquares);
+    mMetrics.openings = mNumberOfOpenings;
+    mMetrics.isolatedNumbers = isolatedNumbers;
+    mMetrics.bbbv = mNumberOfOpenings + isolatedNumbers;
+    mHasOpeningSquares = NO;
 }
 
-- (void)computeMinedNeighborCounts
+/// Stores the openings' regions one after the other in mOpeningSquares,
+/// each in row order. Region k starts at mOpeningStarts[k].
+/** This takes several times longer than finding the openings, and is done
+    the first time the regions are needed rather than when the mines are
+    placed. Must be called after computeOpenings.
+*/
+- (void)computeOpeningSquares
+{
+    unsigned wordsPerRow = mMines.wordsPerRow;
+    mOpeningStarts = GrowArray(mOpeningStarts, &mOpeningStartsCapacity,
+                               mNumberOfOpenings + 1, sizeof(uint32_t));
+    memset(mOpeningStarts, 0, (mNumberOfOpenings + 1) * sizeof(uint32_t));
+
+    // Count the squares in each region, then fill the regions. A square
+    // belongs to the regions of the empty squares around it, and to the
+    // region of the square itself.
+    for (int pass = 0; pass != 2; ++pass)
+    {
+        JbTableIndex idx;
+        for (idx.row = 0; idx.row != mSize.rows; ++idx.row)
+        {
+            for (unsigned w = 0; w != wordsPerRow; ++w)
+            {
+                for (uint64_t region = GetRegionWord(&mMines, idx.row, w);
+                     region != 0; region &= region - 1)
+                {
+                    idx.column = w * 64 + __builtin_ctzll(region);
+                    uint32_t found[9];
+                    unsigned foundCount = FindAdjacentOpenings(mOpeningLabels, mSize, idx, found);
+                    for (unsigned k = 0; k != foundCount; ++k)
+                    {
+                        if (pass == 0)
+                            ++mOpeningStarts[found[k]];
+                        else
+                            mOpeningSquares[mOpeningStarts[found[k] - 1]++] = idx;
+                    }
+                }
+            }
+        }
+
+        if (pass == 0)
+        {
+            // mOpeningStarts[k + 1] holds the size of region k. Turn the
+            // sizes into the starts. The fill pass then uses
+            // mOpeningStarts[k] as the position to write region k's next
+            // square at.
+            for (uint32_t k = 0; k != mNumberOfOpenings; ++k)
+                mOpeningStarts[k + 1] += mOpeningStarts[k];
+            mOpeningSquares = GrowArray(mOpeningSquares, &mOpeningSquaresCapacity,
+                                        mOpeningStarts[mNumberOfOpenings],
+                                        sizeof(JbTableIndex));
+        }
+    }
+    // Each mOpeningStarts[k] has been advanced to the start of region
+    // k + 1, so shift them back one step.
+    memmove(mOpeningStarts + 1, mOpeningStarts, mNumberOfOpenings * sizeof(uint32_t));
+    mOpeningStarts[0] = 0;
+    mHasOpeningSquares = YES;
+}
+
+enum {InRegionFlag = 1, UncoveredFlag = 2, MarkedFlag = 4};
+
+/// Estimates the least number of clicks with marking and smart uncover.
+/** This is the ZiNi estimate made in a single pass over the rows. A number
+    is used if smart uncovering it opens more openings and isolated numbers
+    than the clicks it costs: uncovering it, marking the mined neighbors
+    that aren't marked yet and the smart uncover itself. Whatever remains
+    afterwards takes a click each, as for the 3BV, so the estimate is never
+    more than the 3BV. Versions that pick the best number first can find
+    fewer clicks, but need a pass per number they use.
+
+    Must be called after computeOpenings.
+*/
+- (unsigned)estimateClicksWithMarking
 {
-    JbTableIndex idx;
-    for (idx.row = 0; idx.row != mSize.rows; ++idx.row)
-        for (idx.column = 0; idx.column != mSize.columns; ++idx.column)
+    if (!mHasOpeningSquares)
+        [self computeOpeningSquares];
+    uint32_t* labels = mOpeningLabels;
+    unsigned columns = mSize.columns;
+    size_t squares = (size_t)mSize.rows * columns;
+    uint8_t* flags = calloc(squares, 1);
+    uint8_t* isOpened = calloc(mNumberOfOpenings + 1, 1);
+    NSAssert(flags != NULL && isOpened != NULL,
+             @"Unable to allocate memory for the minefield metrics");
+    uint32_t regionSquares = mOpeningStarts[mNumberOfOpenings];
+    for (uint32_t k = 0; k != regionSquares; ++k)
+        flags[(size_t)mOpeningSquares[k].row * columns + mOpeningSquares[k].column] = InRegionFlag;
+
+    unsigned clicks = 0;
+    for (unsigned row = 0; row != mSize.rows; ++row)
+    {
+        unsigned rowBegin = row != 0 ? row - 1 : 0;
+        unsigned rowEnd = MIN(row + 2, mSize.rows);
+        for (unsigned col = 0; col != columns; ++col)
         {
-            unsigned mines = 0;
-            JbTableIterator it = [self neighborIteratorAt:idx];
-            while (NextNeighbor(&it, idx))
+            size_t i = (size_t)row * columns + col;
+            if (JbGetNibble(mMinedNeighbors, i) == 0 || JbGetBit(&mMines, row, col))
+                continue;
+
+            unsigned colBegin = col != 0 ? col - 1 : 0;
+            unsigned colEnd = MIN(col + 2, columns);
+            unsigned cost = (flags[i] & UncoveredFlag) ? 1 : 2;
+            unsigned gain = (flags[i] & (InRegionFlag | UncoveredFlag)) ? 0 : 1;
+            uint32_t found[8];
+            unsigned foundCount = 0;
+            for (unsigned r = rowBegin; r != rowEnd; ++r)
             {
-                if (GetSquare(mSquares, &it)->hasMine)
-                    ++mines;
+                for (unsigned c = colBegin; c != colEnd; ++c)
+                {
+                    size_t n = (size_t)r * columns + c;
+                    if (JbGetBit(&mMines, r, c))
+                    {
+                        if (!(flags[n] & MarkedFlag))
+                            ++cost;
+                    }
+                    else if (n == i || (flags[n] & UncoveredFlag))
+                    {
+                        continue;
+                    }
+                    else if (labels[n] != 0)
+                    {
+                        unsigned k = 0;
+                        while (k != foundCount && found[k] != labels[n])
+                            ++k;
+                        if (k == foundCount)
+                            found[foundCount++] = labels[n];
+                    }
+                    else if (!(flags[n] & InRegionFlag))
+                    {
+                        ++gain;
+                    }
+                }
+            }
+            gain += foundCount;
+            if (gain <= cost)
+                continue;
+
+            clicks += cost;
+            for (unsigned r = rowBegin; r != rowEnd; ++r)
+            {
+                for (unsigned c = colBegin; c != colEnd; ++c)
+                {
+                    size_t n = (size_t)r * columns + c;
+                    flags[n] |= JbGetBit(&mMines, r, c) ? MarkedFlag : UncoveredFlag;
+                }
             }
-            mSquares[idx.row][idx.column].minedNeighbors = mines;
+            for (unsigned k = 0; k != foundCount; ++k)
+            {
+                uint32_t opening = found[k] - 1;
+                isOpened[opening] = 1;
+                for (uint32_t j = mOpeningStarts[opening]; j != mOpeningStarts[opening + 1]; ++j)
+                    flags[(size_t)mOpeningSquares[j].row * columns
+                          + mOpeningSquares[j].column] |= UncoveredFlag;
+            }
+        }
+    }
+
+    for (uint32_t k = 0; k != mNumberOfOpenings; ++k)
+    {
+        if (!isOpened[k])
+            ++clicks;
+    }
+    for (unsigned row = 0; row != mSize.rows; ++row)
+    {
+        for (unsigned col = 0; col != columns; ++col)
+        {
+            if (flags[(size_t)row * columns + col] == 0 && !JbGetBit(&mMines, row, col))
+                ++clicks;
         }
+    }
+
+    free(isOpened);
+    free(flags);
+    return clicks;
 }
 
-- (void)createMinefieldAroundFirstUncoveredSquareAt:(JbTableIndex)idx
+- (void)computeMinedNeighborCounts
 {
-    assert(mSquares != nil);
+    JbCountNeighborBits(&mMines, mMinedNeighbors);
+    [self computeOpenings];
+    // The ZiNi estimate takes longer than the rest of the metrics together,
+    // and is made the first time the metrics are read.
+    mMetrics.zini = 0;
+    mIsZiniEstimated = NO;
+}
+
+/// Places the mines so that the square at @a idx (and its neighbors if easy
+/// start is enabled) is left without mines.
+/** This is Floyd's variant of a partial Fisher-Yates shuffle: it picks an
+    exact uniform sample of mNumberOfMines squares among the available ones
+    with one random number per mine, using the mine plane itself to tell
+    which squares have already been taken. The squares that must be left
+    open are skipped by SkipExcludedSquares, so they never need to be placed
+    and then removed again.
+*/
+- (void)placeMinesAroundSquare:(JbTableIndex)idx
+{
+    assert(mMinedNeighbors != NULL);
     assert(mState == JbNotStarted);
+    assert(idx.row < mSize.rows && idx.column < mSize.columns);
     NSAssert(mNumberOfMines < mSize.rows * mSize.columns - (mUsesEasyStart ? 9 : 1),
              @"The number of mines is as great or greater than the number of available squares");
-    
-    [self setHasMine:YES aroundFirstUncoveredSquareAt:idx];
-    
-    JbMinefieldSquare* squares = &mSquares[0][0];
-    unsigned mines = 0;
-    while (mines < mNumberOfMines)
-    {
-        unsigned i = random() % (mSize.rows * mSize.columns);
-        if (!squares[i].hasMine)
-        {
-            squares[i].hasMine = YES;
-            ++mines;
-        }
+
+    size_t excluded[9];
+    unsigned excludedCount = 0;
+    JbTableIterator it = mUsesEasyStart
+                         ? [self neighborIteratorAt:idx]
+                         : JbMakeTableIterator(idx.row, idx.column,
+                                               idx.row + 1, idx.column + 1);
+    while (JbTableIteratorNext(&it))
+        excluded[excludedCount++] = (size_t)it.index.row * mSize.columns + it.index.column;
+
+    JbRandom random;
+    JbSeedRandom(&random, mSeed);
+    size_t available = (size_t)mSize.rows * mSize.columns - excludedCount;
+    for (size_t i = available - mNumberOfMines; i != available; ++i)
+    {
+        size_t square = SkipExcludedSquares(JbRandomBelow(&random, i + 1),
+                                            excluded, excludedCount);
+        if (JbGetBit(&mMines, square / mSize.columns, square % mSize.columns))
+            square = SkipExcludedSquares(i, excluded, excludedCount);
+        JbSetBit(&mMines, square / mSize.columns, square % mSize.columns);
+        [mMineSquares addValue:JbMakeTableIndex((unsigned)(square / mSize.columns),
+                                                (unsigned)(square % mSize.columns))];
     }
-    
-    [self setHasMine:NO aroundFirstUncoveredSquareAt:idx];
+
     [self computeMinedNeighborCounts];
+    mPlacementSquare = idx;
     mState = JbNotCompleted;
+    [mJournal startWithMinefield:self];
+}
+
+/// Chooses the seed and placement square for a game that starts at @a idx
+/// and places the mines.
+/** A minefield from the board pool is preferred. Otherwise, with no-guess
+    boards the seed is replaced by one that JbNoGuessGenerator has verified.
+*/
+- (void)createMinefieldAroundFirstUncoveredSquareAt:(JbTableIndex)idx
+{
+    assert(mState == JbNotStarted);
+
+    if (mBoardPool != nil
+        && [mBoardPool takeBoardWithSize:mSize
+                           numberOfMines:mNumberOfMines
+                           usesEasyStart:mUsesEasyStart
+                       usesNoGuessBoards:mUsesNoGuessBoards
+                             firstSquare:idx
+                                    seed:&mSeed])
+    {
+        [self placeMinesAroundSquare:idx];
+        return;
+    }
+
+    if (mUsesNoGuessBoards)
+    {
+        JbNoGuessGenerator* generator = [[JbNoGuessGenerator alloc] initWithSize:mSize
+                                                                   numberOfMines:mNumberOfMines
+                                                                   usesEasyStart:mUsesEasyStart
+                                                                     firstSquare:idx
+                                                                        baseSeed:mSeed];
+        if ([generator run])
+            mSeed = [generator seed];
+        mGenerationTime = [generator seconds];
+        mNumberOfGenerationAttempts = [generator numberOfAttempts];
+        [generator release];
+    }
+
+    [self placeMinesAroundSquare:idx];
 }
 
 - (BOOL)usesEasyStart
@@ -230,6 +931,26 @@ static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
     mUsesEasyStart = newUsesEasyStart;
 }
 
+- (BOOL)usesNoGuessBoards
+{
+    return mUsesNoGuessBoards;
+}
+
+- (void)setUsesNoGuessBoards:(BOOL)newUsesNoGuessBoards
+{
+    mUsesNoGuessBoards = newUsesNoGuessBoards;
+}
+
+- (double)generationTime
+{
+    return mGenerationTime;
+}
+
+- (uint64_t)numberOfGenerationAttempts
+{
+    return mNumberOfGenerationAttempts;
+}
+
 - (BOOL)usesSmartUncover
 {
     return mUsesSmartUncover;
@@ -237,7 +958,10 @@ static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
 
 - (void)setUsesSmartUncover:(BOOL)newUsesSmartUncover
 {
+    BOOL isChanged = newUsesSmartUncover != mUsesSmartUncover;
     mUsesSmartUncover = newUsesSmartUncover;
+    if (isChanged)
+        [self recordSettings];
 }
 
 - (BOOL)usesSmartMark
@@ -247,7 +971,10 @@ static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
 
 - (void)setUsesSmartMark:(BOOL)newUsesSmartMark
 {
+    BOOL isChanged = newUsesSmartMark != mUsesSmartMark;
     mUsesSmartMark = newUsesSmartMark;
+    if (isChanged)
+        [self recordSettings];
 }
 
 - (BOOL)usesQuestionMarks
@@ -258,20 +985,34 @@ static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
 - (JbTableIndexList*)setUsesQuestionMarks:(BOOL)newUsesQuestionMarks
 {
     JbTableIndexList* affectedSquares = [JbTableIndexList listWithCapacity:10];
-    if (mSquares && mUsesQuestionMarks && !newUsesQuestionMarks)
+    [self setUsesQuestionMarks:newUsesQuestionMarks affectedSquares:affectedSquares];
+    return affectedSquares;
+}
+
+- (void)setUsesQuestionMarks:(BOOL)newUsesQuestionMarks
+             affectedSquares:(id<JbTableIndexCollector>)affectedSquares
+{
+    if (mMinedNeighbors && mUsesQuestionMarks && !newUsesQuestionMarks)
     {
-        // Remove existing question marks.
-        JbTableIndex idx;
-        for (idx.row = 0; idx.row != mSize.rows; ++idx.row)
-            for (idx.column = 0; idx.column != mSize.columns; ++idx.column)
-                if (mSquares[idx.row][idx.column].state == JbQuestionMarked)
-                {
-                    mSquares[idx.row][idx.column].state = JbUnmarked;
-                    [affectedSquares addValue:idx];
-                }
+        // Remove existing question marks. The list is emptied in one go
+        // rather than a square at a time.
+        JbTableIndex* it = [mQuestionMarkedSquares begin];
+        JbTableIndex* end = [mQuestionMarkedSquares end];
+        for (; it != end; ++it)
+        {
+            JbClearBit(&mQuestionMarked, it->row, it->column);
+            AddToNeighborCounts(mQuestionMarkedNeighbors, mSize, *it, -1);
+            if (mNumberOfCheckpoints != 0)
+                [self logChange:JbClearQuestionMarkChange at:*it];
+        }
+        [affectedSquares addValues:[mQuestionMarkedSquares begin]
+                             count:[mQuestionMarkedSquares count]];
+        [mQuestionMarkedSquares removeAllValues];
     }
+    BOOL isChanged = newUsesQuestionMarks != mUsesQuestionMarks;
     mUsesQuestionMarks = newUsesQuestionMarks;
-    return affectedSquares;
+    if (isChanged)
+        [self recordSettings];
 }
 
 - (JbMinefieldState)state
@@ -289,198 +1030,575 @@ static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
     return mNumberOfMarkedSquares;
 }
 
+- (JbMinefieldMetrics)metrics
+{
+    if (!mIsZiniEstimated)
+    {
+        mMetrics.zini = [self estimateClicksWithMarking];
+        mIsZiniEstimated = YES;
+    }
+    return mMetrics;
+}
+
+- (JbTableIndexList*)mineSquares
+{
+    return mMineSquares;
+}
+
+- (JbTableIndexList*)markedSquares
+{
+    return mMarkedSquares;
+}
+
+- (JbTableIndexList*)questionMarkedSquares
+{
+    return mQuestionMarkedSquares;
+}
+
+- (const JbBitTable*)plane:(JbMinefieldPlane)plane
+{
+    switch (plane)
+    {
+    case JbMinefieldMinePlane: return &mMines;
+    case JbMinefieldCoveredPlane: return &mCovered;
+    case JbMinefieldMarkedPlane: return &mMarked;
+    case JbMinefieldQuestionMarkedPlane: return &mQuestionMarked;
+    default: assert(NO); return NULL;
+    }
+}
+
+/// Adds the squares whose bits are set in @a plane to @a list, and to
+/// mSquarePositions if @a list is one of the mark lists.
+- (void)addSquaresInPlane:(const JbBitTable*)plane
+                   toList:(JbTableIndexList*)list
+             hasPositions:(BOOL)hasPositions
+{
+    for (unsigned row = 0; row != plane->rows; ++row)
+    {
+        const uint64_t* words = JbBitTableRow(plane, row);
+        for (unsigned w = 0; w != plane->wordsPerRow; ++w)
+        {
+            for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1)
+            {
+                JbTableIndex idx = JbMakeTableIndex(row, w * 64 + __builtin_ctzll(bits));
+                if (hasPositions)
+                    [self addSquare:idx toList:list];
+                else
+                    [list addValue:idx];
+            }
+        }
+    }
+}
+
+- (BOOL)restoreFromSnapshot:(JbMinefieldSnapshot*)snapshot
+{
+    [self setSize:[snapshot size] numberOfMines:[snapshot numberOfMines]];
+    mSeed = [snapshot seed];
+    mPlacementSquare = [snapshot placementSquare];
+    JbMinefieldState state = [snapshot state];
+    if (state == JbNotStarted)
+        return YES;
+
+    size_t planeSize = (size_t)mMines.rows * mMines.wordsPerRow * sizeof(uint64_t);
+    for (unsigned p = 0; p != JbMinefieldNumberOfPlanes; ++p)
+        memcpy(((JbBitTable*)[self plane:p])->words, [snapshot plane:p]->words, planeSize);
+    if (!HasConsistentStates(&mCovered, &mMarked, &mQuestionMarked, &mMines)
+        || JbCountBits(&mMines) != mNumberOfMines)
+    {
+        [self clear];
+        return NO;
+    }
+
+    [self addSquaresInPlane:&mMines toList:mMineSquares hasPositions:NO];
+    [self addSquaresInPlane:&mMarked toList:mMarkedSquares hasPositions:YES];
+    [self addSquaresInPlane:&mQuestionMarked toList:mQuestionMarkedSquares hasPositions:YES];
+    [self computeMinedNeighborCounts];
+    JbCountNeighborBits(&mCovered, mCoveredNeighbors);
+    JbCountNeighborBits(&mMarked, mMarkedNeighbors);
+    JbCountNeighborBits(&mQuestionMarked, mQuestionMarkedNeighbors);
+    mNumberOfCoveredSquares = (unsigned)JbCountBits(&mCovered);
+    mNumberOfMarkedSquares = (unsigned)[mMarkedSquares count];
+    mState = state;
+    return YES;
+}
+
 - (BOOL)hasMineAt:(JbTableIndex)idx
 {
-    assert(mSquares != nil);
+    assert(mMinedNeighbors != NULL);
     assert(idx.row < mSize.rows && idx.column < mSize.columns);
-    return mSquares[idx.row][idx.column].hasMine;
+    return JbGetBit(&mMines, idx.row, idx.column);
 }
 
 - (JbMinefieldSquareState)stateAt:(JbTableIndex)idx
 {
-    assert(mSquares != nil);
+    assert(mMinedNeighbors != NULL);
     assert(idx.row < mSize.rows && idx.column < mSize.columns);
-    return mSquares[idx.row][idx.column].state;
+    return GetSquareState(&mCovered, &mMarked, &mQuestionMarked, idx);
 }
 
 - (unsigned)countNeighborsWithMinesAt:(JbTableIndex)idx
 {
-    assert(mSquares != nil);
+    assert(mMinedNeighbors != NULL);
     assert(idx.row < mSize.rows && idx.column < mSize.columns);
-    return mSquares[idx.row][idx.column].minedNeighbors;
+    return JbGetNibble(mMinedNeighbors, (size_t)idx.row * mSize.columns + idx.column);
 }
 
-- (JbNeighborStatistics)neighborStatisticsAt:(JbTableIndex)idx
+- (unsigned)countCoveredNeighborsAt:(JbTableIndex)idx
 {
-    JbNeighborStatistics stats = {0, 0, 0, 0, 0};
-    JbTableIterator it = [self neighborIteratorAt:idx];
-    while (NextNeighbor(&it, idx))
+    assert(mMinedNeighbors != NULL);
+    assert(idx.row < mSize.rows && idx.column < mSize.columns);
+    return JbGetNibble(mCoveredNeighbors, (size_t)idx.row * mSize.columns + idx.column);
+}
+
+- (unsigned)countMarkedNeighborsAt:(JbTableIndex)idx
+{
+    assert(mMinedNeighbors != NULL);
+    assert(idx.row < mSize.rows && idx.column < mSize.columns);
+    return JbGetNibble(mMarkedNeighbors, (size_t)idx.row * mSize.columns + idx.column);
+}
+
+- (unsigned)countQuestionMarkedNeighborsAt:(JbTableIndex)idx
+{
+    assert(mMinedNeighbors != NULL);
+    assert(idx.row < mSize.rows && idx.column < mSize.columns);
+    return JbGetNibble(mQuestionMarkedNeighbors, (size_t)idx.row * mSize.columns + idx.column);
+}
+
+- (void)getSquares:(JbMinefieldSquare*)squares inSpan:(JbTableSpan)span
+{
+    assert(span.row < mSize.rows && span.columnEnd <= mSize.columns);
+    size_t rowStart = (size_t)span.row * mSize.columns;
+    for (unsigned col = span.columnBegin; col != span.columnEnd; ++col)
     {
-        ++stats.neighbors;
-        switch (GetSquare(mSquares, &it)->state)
-        {
-        case JbUnmarked:
-            ++stats.coveredNeighbors;
-            break;
-        case JbMarked:
-            ++stats.coveredNeighbors;
-            ++stats.markedNeighbors;
-            break;
-        case JbQuestionMarked:
-            ++stats.coveredNeighbors;
-            ++stats.questionMarkedNeighbors;
-            break;
-        default:
-            break;
-        }
+        JbMinefieldSquare* square = &squares[col - span.columnBegin];
+        square->state = GetSquareState(&mCovered, &mMarked, &mQuestionMarked,
+                                       JbMakeTableIndex(span.row, col));
+        square->hasMine = JbGetBit(&mMines, span.row, col);
+        square->minedNeighbors = (uint8_t)JbGetNibble(mMinedNeighbors, rowStart + col);
     }
-    stats.minedNeighbors = mSquares[idx.row][idx.column].minedNeighbors;
+}
+
+- (JbNeighborStatistics)neighborStatisticsAt:(JbTableIndex)idx
+{
+    size_t i = (size_t)idx.row * mSize.columns + idx.column;
+    JbNeighborStatistics stats;
+    stats.neighbors = CountNeighbors(mSize, idx);
+    stats.markedNeighbors = JbGetNibble(mMarkedNeighbors, i);
+    stats.questionMarkedNeighbors = JbGetNibble(mQuestionMarkedNeighbors, i);
+    stats.coveredNeighbors = JbGetNibble(mCoveredNeighbors, i);
+    stats.minedNeighbors = JbGetNibble(mMinedNeighbors, i);
     return stats;
 }
 
-- (JbTableIndexList*)uncoverableAt:(JbTableIndex)idx;
+- (JbTableIndexList*)uncoverableAt:(JbTableIndex)idx
+{
+    JbTableIndexList* affectedSquares = [JbTableIndexList listWithCapacity:8];
+    [self uncoverableAt:idx affectedSquares:affectedSquares];
+    return affectedSquares;
+}
+
+- (void)uncoverableAt:(JbTableIndex)idx
+      affectedSquares:(id<JbTableIndexCollector>)affectedSquares
 {
-    assert(mSquares != nil);
+    assert(mMinedNeighbors != NULL);
     assert(idx.row < mSize.rows && idx.column < mSize.columns);
 
-    JbTableIndexList* affectedSquares = [JbTableIndexList listWithCapacity:8];
-    if (mSquares[idx.row][idx.column].state != JbUncovered)
+    JbMinefieldSquareState state = GetSquareState(&mCovered, &mMarked, &mQuestionMarked, idx);
+    if (state != JbUncovered)
     {
-        JbMinefieldSquareState state = mSquares[idx.row][idx.column].state;
         if (state != JbMarked && state != JbQuestionMarked)
             [affectedSquares addValue:idx];
-        return affectedSquares;
+        return;
     }
     else if (!mUsesSmartUncover)
-        return affectedSquares;
+        return;
 
     JbNeighborStatistics stats = [self neighborStatisticsAt:idx];
     if (stats.coveredNeighbors == stats.markedNeighbors
         || stats.questionMarkedNeighbors != 0
         || stats.markedNeighbors < stats.minedNeighbors)
-        return affectedSquares;
+        return;
 
     JbTableIterator it = [self neighborIteratorAt:idx];
     while (NextNeighbor(&it, idx))
-        if (GetSquare(mSquares, &it)->state == JbUnmarked)
+        if (GetSquareState(&mCovered, &mMarked, &mQuestionMarked, it.index) == JbUnmarked)
             [affectedSquares addValue:it.index];
-    return affectedSquares;
 }
 
-- (JbTableIndexList*)smartMarkAt:(JbTableIndex)idx
+- (const double*)mineProbabilities
+{
+    assert(mMinedNeighbors != NULL);
+    if (mMineProbabilities == nil)
+        mMineProbabilities = [[JbMineProbabilities alloc] initWithSize:mSize
+                                                         numberOfMines:mNumberOfMines];
+    if (mState == JbNotStarted || mState == JbNotCompleted)
+        [mMineProbabilities updateWithCovered:&mCovered minedNeighbors:mMinedNeighbors];
+    else
+        [mMineProbabilities updateWithMines:&mMines];
+    return [mMineProbabilities probabilities];
+}
+
+- (double)mineProbabilityAt:(JbTableIndex)idx
+{
+    assert(idx.row < mSize.rows && idx.column < mSize.columns);
+    return [self mineProbabilities][(size_t)idx.row * mSize.columns + idx.column];
+}
+
+/// Appends the square at @a idx to @a list, which must be mMarkedSquares or
+/// mQuestionMarkedSquares.
+- (void)addSquare:(JbTableIndex)idx toList:(JbTableIndexList*)list
+{
+    mSquarePositions[(size_t)idx.row * mSize.columns + idx.column] = (uint32_t)[list count];
+    [list addValue:idx];
+}
+
+/// Removes the square at @a idx from @a list by moving the last square in
+/// the list to its position.
+- (void)removeSquare:(JbTableIndex)idx fromList:(JbTableIndexList*)list
+{
+    uint32_t position = mSquarePositions[(size_t)idx.row * mSize.columns + idx.column];
+    JbTableIndex last = [list valueAtIndex:[list count] - 1];
+    assert(JbEqualTableIndexes([list valueAtIndex:position], idx));
+    [list setValue:last atIndex:position];
+    mSquarePositions[(size_t)last.row * mSize.columns + last.column] = position;
+    [list removeLastValue];
+}
+
+- (void)setMarkAt:(JbTableIndex)idx
+{
+    JbSetBit(&mMarked, idx.row, idx.column);
+    AddToNeighborCounts(mMarkedNeighbors, mSize, idx, 1);
+    [self addSquare:idx toList:mMarkedSquares];
+    if (mNumberOfCheckpoints != 0)
+        [self logChange:JbSetMarkChange at:idx];
+}
+
+- (void)clearMarkAt:(JbTableIndex)idx
+{
+    JbClearBit(&mMarked, idx.row, idx.column);
+    AddToNeighborCounts(mMarkedNeighbors, mSize, idx, -1);
+    [self removeSquare:idx fromList:mMarkedSquares];
+    if (mNumberOfCheckpoints != 0)
+        [self logChange:JbClearMarkChange at:idx];
+}
+
+- (void)setQuestionMarkAt:(JbTableIndex)idx
+{
+    JbSetBit(&mQuestionMarked, idx.row, idx.column);
+    AddToNeighborCounts(mQuestionMarkedNeighbors, mSize, idx, 1);
+    [self addSquare:idx toList:mQuestionMarkedSquares];
+    if (mNumberOfCheckpoints != 0)
+        [self logChange:JbSetQuestionMarkChange at:idx];
+}
+
+- (void)clearQuestionMarkAt:(JbTableIndex)idx
+{
+    JbClearBit(&mQuestionMarked, idx.row, idx.column);
+    AddToNeighborCounts(mQuestionMarkedNeighbors, mSize, idx, -1);
+    [self removeSquare:idx fromList:mQuestionMarkedSquares];
+    if (mNumberOfCheckpoints != 0)
+        [self logChange:JbClearQuestionMarkChange at:idx];
+}
+
+- (void)pushCheckpoint
+{
+    assert(mMinedNeighbors != NULL);
+    assert(mState != JbNotStarted);
+    mCheckpoints = GrowArray(mCheckpoints, &mCheckpointsCapacity,
+                             mNumberOfCheckpoints + 1, sizeof(JbMinefieldCheckpoint));
+    JbMinefieldCheckpoint* checkpoint = &mCheckpoints[mNumberOfCheckpoints++];
+    checkpoint->undoLogSize = mUndoLogSize;
+    checkpoint->numberOfJournalMoves = [mJournal numberOfMoves];
+    checkpoint->numberOfCoveredSquares = mNumberOfCoveredSquares;
+    checkpoint->numberOfMarkedSquares = mNumberOfMarkedSquares;
+    checkpoint->state = mState;
+    checkpoint->usesSmartUncover = mUsesSmartUncover;
+    checkpoint->usesSmartMark = mUsesSmartMark;
+    checkpoint->usesQuestionMarks = mUsesQuestionMarks;
+}
+
+- (JbTableIndexList*)rollBack
 {
     JbTableIndexList* affectedSquares = [JbTableIndexList listWithCapacity:10];
-    
+    [self rollBackWithAffectedSquares:affectedSquares];
+    return affectedSquares;
+}
+
+- (void)rollBackWithAffectedSquares:(id<JbTableIndexCollector>)affectedSquares
+{
+    assert(mNumberOfCheckpoints != 0);
+    JbMinefieldCheckpoint checkpoint = mCheckpoints[mNumberOfCheckpoints - 1];
+    // The marks are undone by the methods that make them, which mustn't
+    // log the changes they undo.
+    unsigned numberOfCheckpoints = mNumberOfCheckpoints - 1;
+    mNumberOfCheckpoints = 0;
+    while (mUndoLogSize != checkpoint.undoLogSize)
+    {
+        uint64_t entry = mUndoLog[--mUndoLogSize];
+        size_t square = (size_t)(entry >> SquareChangeBits);
+        JbTableIndex idx = JbMakeTableIndex((unsigned)(square / mSize.columns),
+                                            (unsigned)(square % mSize.columns));
+        switch ((JbSquareChange)(entry & ((1 << SquareChangeBits) - 1)))
+        {
+        case JbUncoverChange:
+            JbSetBit(&mCovered, idx.row, idx.column);
+            AddToNeighborCounts(mCoveredNeighbors, mSize, idx, 1);
+            break;
+        case JbSetMarkChange:
+            [self clearMarkAt:idx];
+            break;
+        case JbClearMarkChange:
+            [self setMarkAt:idx];
+            break;
+        case JbSetQuestionMarkChange:
+            [self clearQuestionMarkAt:idx];
+            break;
+        case JbClearQuestionMarkChange:
+            [self setQuestionMarkAt:idx];
+            break;
+        }
+        [affectedSquares addValue:idx];
+    }
+    mNumberOfCoveredSquares = checkpoint.numberOfCoveredSquares;
+    mNumberOfMarkedSquares = checkpoint.numberOfMarkedSquares;
+    mState = checkpoint.state;
+    // The question marks that were removed when they were turned off have
+    // been put back, and the journal's settings moves since the checkpoint
+    // are removed, so the settings must be rolled back too.
+    mUsesSmartUncover = checkpoint.usesSmartUncover;
+    mUsesSmartMark = checkpoint.usesSmartMark;
+    mUsesQuestionMarks = checkpoint.usesQuestionMarks;
+    [mJournal removeMovesAfter:checkpoint.numberOfJournalMoves];
+    mNumberOfCheckpoints = numberOfCheckpoints;
+}
+
+- (void)popCheckpoint
+{
+    assert(mNumberOfCheckpoints != 0);
+    if (--mNumberOfCheckpoints == 0)
+        mUndoLogSize = 0;
+}
+
+- (unsigned)numberOfCheckpoints
+{
+    return mNumberOfCheckpoints;
+}
+
+- (void)smartMarkAt:(JbTableIndex)idx
+    affectedSquares:(id<JbTableIndexCollector>)affectedSquares
+{
     if (!mUsesSmartMark)
-        return affectedSquares;
+        return;
 
     JbNeighborStatistics stats = [self neighborStatisticsAt:idx];
     if (stats.coveredNeighbors > stats.minedNeighbors
         || stats.markedNeighbors == stats.minedNeighbors)
-        return affectedSquares;
+        return;
 
     JbTableIterator it = [self neighborIteratorAt:idx];
     while (NextNeighbor(&it, idx))
     {
-        JbMinefieldSquareState* state = &GetSquare(mSquares, &it)->state;
-        if (*state != JbUncovered && *state != JbMarked)
+        JbMinefieldSquareState state = GetSquareState(&mCovered, &mMarked,
+                                                      &mQuestionMarked, it.index);
+        if (state != JbUncovered && state != JbMarked)
         {
-            *state = JbMarked;
+            if (state == JbQuestionMarked)
+                [self clearQuestionMarkAt:it.index];
+            [self setMarkAt:it.index];
             [affectedSquares addValue:it.index];
             ++mNumberOfMarkedSquares;
         }
     }
-    return affectedSquares;
 }
 
-- (void)markAllUnmarked:(JbTableIndexList*)affectedSquares
+- (void)markAllUnmarked:(id<JbTableIndexCollector>)affectedSquares
 {
-    JbTableIndex idx;
-    for (idx.row = 0; idx.row != mSize.rows; ++idx.row)
+    size_t count = [mMineSquares count];
+    for (size_t i = 0; i != count; ++i)
     {
-        for (idx.column = 0; idx.column != mSize.columns; ++idx.column)
+        JbTableIndex idx = [mMineSquares valueAtIndex:i];
+        if (GetSquareState(&mCovered, &mMarked, &mQuestionMarked, idx) == JbUnmarked)
         {
-            JbMinefieldSquare* square = &mSquares[idx.row][idx.column];
-            if (square->hasMine && square->state == JbUnmarked)
-            {
-                square->state = JbMarked;
-                [affectedSquares addValue:idx];
-            }
+            [self setMarkAt:idx];
+            [affectedSquares addValue:idx];
         }
     }
 }
 
 - (JbTableIndexList*)markAt:(JbTableIndex)idx
 {
-    assert(mSquares != nil);
+    JbTableIndexList* affectedSquares = [JbTableIndexList listWithCapacity:10];
+    [self markAt:idx affectedSquares:affectedSquares];
+    return affectedSquares;
+}
+
+- (void)markAt:(JbTableIndex)idx
+    affectedSquares:(id<JbTableIndexCollector>)affectedSquares
+{
+    assert(mMinedNeighbors != NULL);
     assert(idx.row < mSize.rows && idx.column < mSize.columns);
     assert(mState != JbBlownUp && mState != JbCompleted);
 
-    if (mSquares[idx.row][idx.column].state == JbUncovered)
-        return [self smartMarkAt:idx];
-    
-    switch (mSquares[idx.row][idx.column].state)
+    [mJournal recordMove:JbMarkMove atIndex:idx];
+    switch (GetSquareState(&mCovered, &mMarked, &mQuestionMarked, idx))
     {
+    case JbUncovered:
+        [self smartMarkAt:idx affectedSquares:affectedSquares];
+        return;
     case JbUnmarked:
         {
             JbNeighborStatistics stats = [self neighborStatisticsAt:idx];
             if (stats.coveredNeighbors != stats.neighbors)
             {
-                mSquares[idx.row][idx.column].state = JbMarked;
+                [self setMarkAt:idx];
                 ++mNumberOfMarkedSquares;
             }
         }
         break;
     case JbMarked:
-        mSquares[idx.row][idx.column].state =
-                            mUsesQuestionMarks ? JbQuestionMarked : JbUnmarked;
+        [self clearMarkAt:idx];
+        if (mUsesQuestionMarks)
+            [self setQuestionMarkAt:idx];
         --mNumberOfMarkedSquares;
         break;
     case JbQuestionMarked:
-        mSquares[idx.row][idx.column].state = JbUnmarked;
+        [self clearQuestionMarkAt:idx];
         break;
     default:
         break;
     }
-    return [JbTableIndexList listWithValues:&idx count:1];
+    [affectedSquares addValue:idx];
 }
 
-- (void)uncoverRecursivelyAt:(JbTableIndex)idx
-             affectedSquares:(JbTableIndexList*)affectedSquares
+/// Uncovers the region of the opening that the empty square at @a idx
+/// belongs to.
+/** @return NO, without changing anything, if any square in the region is
+    uncovered, marked or question-marked, as the flood fill must then decide
+    where the opening stops.
+*/
+- (BOOL)uncoverOpeningAt:(JbTableIndex)idx
+         affectedSquares:(id<JbTableIndexCollector>)affectedSquares
 {
-    mSquares[idx.row][idx.column].state = JbUncovered;
-    [affectedSquares addValue:idx];
-    --mNumberOfCoveredSquares;
+    uint32_t label = mOpeningLabels[(size_t)idx.row * mSize.columns + idx.column];
+    assert(label != 0);
+    if (!mHasOpeningSquares)
+        [self computeOpeningSquares];
+    const JbTableIndex* begin = mOpeningSquares + mOpeningStarts[label - 1];
+    const JbTableIndex* end = mOpeningSquares + mOpeningStarts[label];
+    for (const JbTableIndex* it = begin; it != end; ++it)
+    {
+        if (GetSquareState(&mCovered, &mMarked, &mQuestionMarked, *it) != JbUnmarked)
+            return NO;
+    }
 
-    if (mSquares[idx.row][idx.column].hasMine)
+    for (const JbTableIndex* it = begin; it != end; ++it)
     {
+        JbClearBit(&mCovered, it->row, it->column);
+        AddToNeighborCounts(mCoveredNeighbors, mSize, *it, -1);
+        if (mNumberOfCheckpoints != 0)
+            [self logChange:JbUncoverChange at:*it];
+    }
+    mNumberOfCoveredSquares -= (unsigned)(end - begin);
+    [affectedSquares addValues:begin count:end - begin];
+    return YES;
+}
+
+/// Uncovers the square at @a idx, and the whole region around it if it has
+/// no mined neighbors, one square at a time.
+/** The region is filled breadth first, using mFrontier as the queue. Every
+    square that is uncovered is appended to the queue exactly once, so when
+    the fill is done the queue holds all the affected squares and is added to
+    @a affectedSquares in one go. mFrontier is kept between moves and only
+    grows when a larger region is opened.
+*/
+- (void)floodUncoverAt:(JbTableIndex)idx
+       affectedSquares:(id<JbTableIndexCollector>)affectedSquares
+{
+    JbClearBit(&mCovered, idx.row, idx.column);
+    AddToNeighborCounts(mCoveredNeighbors, mSize, idx, -1);
+    --mNumberOfCoveredSquares;
+    if (mNumberOfCheckpoints != 0)
+        [self logChange:JbUncoverChange at:idx];
+
+    BOOL hasMine = JbGetBit(&mMines, idx.row, idx.column);
+    if (hasMine)
         mState = JbBlownUp;
+
+    if (hasMine || JbGetNibble(mMinedNeighbors,
+                               (size_t)idx.row * mSize.columns + idx.column) != 0)
+    {
+        [affectedSquares addValue:idx];
+        return;
     }
-    else if (mSquares[idx.row][idx.column].minedNeighbors == 0)
+
+    if (mFrontierCapacity == 0)
+        GrowFrontier(&mFrontier, &mFrontierCapacity);
+
+    size_t head = 0, tail = 0;
+    mFrontier[tail++] = idx;
+    while (head != tail)
     {
-        JbTableIterator it = [self neighborIteratorAt:idx];
-        while (NextNeighbor(&it, idx))
-            if (GetSquare(mSquares, &it)->state == JbUnmarked)
-                [self uncoverRecursivelyAt:it.index
-                           affectedSquares:affectedSquares];
+        JbTableIndex current = mFrontier[head++];
+        if (JbGetNibble(mMinedNeighbors,
+                        (size_t)current.row * mSize.columns + current.column) != 0)
+            continue;
+
+        unsigned rowBegin = current.row != 0 ? current.row - 1 : 0;
+        unsigned rowEnd = MIN(current.row + 2, mSize.rows);
+        unsigned colBegin = current.column != 0 ? current.column - 1 : 0;
+        unsigned colEnd = MIN(current.column + 2, mSize.columns);
+        for (unsigned row = rowBegin; row != rowEnd; ++row)
+        {
+            for (unsigned col = colBegin; col != colEnd; ++col)
+            {
+                if (!JbGetBit(&mCovered, row, col)
+                    || JbGetBit(&mMarked, row, col)
+                    || JbGetBit(&mQuestionMarked, row, col))
+                    continue;
+                JbClearBit(&mCovered, row, col);
+                AddToNeighborCounts(mCoveredNeighbors, mSize,
+                                    JbMakeTableIndex(row, col), -1);
+                --mNumberOfCoveredSquares;
+                if (mNumberOfCheckpoints != 0)
+                    [self logChange:JbUncoverChange at:JbMakeTableIndex(row, col)];
+                if (tail == mFrontierCapacity)
+                    GrowFrontier(&mFrontier, &mFrontierCapacity);
+                mFrontier[tail].row = row;
+                mFrontier[tail].column = col;
+                ++tail;
+            }
+        }
     }
+
+    [affectedSquares addValues:mFrontier count:tail];
 }
 
-- (JbTableIndexList*)smartUncoverAt:(JbTableIndex)idx
+/// Uncovers the square at @a idx, and the whole region around it if it has
+/// no mined neighbors.
+- (void)uncoverRegionAt:(JbTableIndex)idx
+        affectedSquares:(id<JbTableIndexCollector>)affectedSquares
+{
+    if (mOpeningLabels[(size_t)idx.row * mSize.columns + idx.column] != 0
+        && [self uncoverOpeningAt:idx affectedSquares:affectedSquares])
+        return;
+
+    [self floodUncoverAt:idx affectedSquares:affectedSquares];
+}
+
+- (void)smartUncoverAt:(JbTableIndex)idx
+      affectedSquares:(id<JbTableIndexCollector>)affectedSquares
 {
-    JbTableIndexList* affectedSquares = [JbTableIndexList listWithCapacity:10];
-    
     JbNeighborStatistics stats = [self neighborStatisticsAt:idx];
     if (stats.coveredNeighbors == stats.markedNeighbors
         || stats.questionMarkedNeighbors != 0
         || stats.markedNeighbors < stats.minedNeighbors)
-        return affectedSquares;
+        return;
 
     JbTableIterator it = [self neighborIteratorAt:idx];
     while (NextNeighbor(&it, idx))
-        if (GetSquare(mSquares, &it)->state == JbUnmarked)
-            [self uncoverRecursivelyAt:it.index
-                       affectedSquares:affectedSquares];
+        if (GetSquareState(&mCovered, &mMarked, &mQuestionMarked, it.index) == JbUnmarked)
+            [self uncoverRegionAt:it.index
+                  affectedSquares:affectedSquares];
 
     if (stats.markedNeighbors > stats.minedNeighbors)
         mState = JbBlownUp;
@@ -489,44 +1607,67 @@ static inline JbMinefieldSquare* GetSquare(JbMinefieldSquare** table,
         mState = JbCompleted;
         [self markAllUnmarked:affectedSquares];
     }
+}
 
+- (JbTableIndexList*)uncoverAt:(JbTableIndex)idx
+{
+    JbTableIndexList* affectedSquares = [JbTableIndexList listWithCapacity:10];
+    [self uncoverAt:idx affectedSquares:affectedSquares];
     return affectedSquares;
 }
 
-- (JbTableIndexList*)uncoverAt:(JbTableIndex)idx
+- (void)uncoverAt:(JbTableIndex)idx
+  affectedSquares:(id<JbTableIndexCollector>)affectedSquares
 {
-    assert(mSquares != nil);
+    assert(mMinedNeighbors != NULL);
     assert(idx.row < mSize.rows && idx.column < mSize.columns);
     assert(mState != JbBlownUp && mState != JbCompleted);
-    
+
     if (mState == JbNotStarted)
         [self createMinefieldAroundFirstUncoveredSquareAt:idx];
+    [mJournal recordMove:JbUncoverMove atIndex:idx];
 
-    if (mUsesSmartUncover && mSquares[idx.row][idx.column].state == JbUncovered)
-        return [self smartUncoverAt:idx];
+    JbMinefieldSquareState state = GetSquareState(&mCovered, &mMarked,
+                                                  &mQuestionMarked, idx);
+    if (mUsesSmartUncover && state == JbUncovered)
+    {
+        [self smartUncoverAt:idx affectedSquares:affectedSquares];
+        return;
+    }
 
-    JbTableIndexList* affectedSquares = [JbTableIndexList listWithCapacity:10];
+    if (state != JbUnmarked)
+        return;
 
-    if (mSquares[idx.row][idx.column].state != JbUnmarked)
-        return affectedSquares;
-        
-    [self uncoverRecursivelyAt:idx affectedSquares:affectedSquares];
+    [self uncoverRegionAt:idx affectedSquares:affectedSquares];
 
     if (mState != JbBlownUp && mNumberOfCoveredSquares == mNumberOfMines)
     {
         mState = JbCompleted;
         [self markAllUnmarked:affectedSquares];
     }
-
-    return affectedSquares;
 }
 
 @end
 
-static JbMinefieldSquare** AllocMinefieldSquareTable(JbTableSize size)
+/// Returns @a array, reallocated if necessary so it has room for at least
+/// @a count elements.
+static void* GrowArray(void* array, size_t* capacity, size_t count, size_t elementSize)
 {
-    assert(size.rows != 0 && size.columns != 0);
-    return (JbMinefieldSquare**)JbAllocTable(size.rows,
-                                             size.columns,
-                                             sizeof(JbMinefieldSquare));
+    if (count <= *capacity)
+        return array;
+    size_t newCapacity = MAX(count, *capacity + *capacity / 2);
+    void* newArray = realloc(array, newCapacity * elementSize);
+    assert(newArray != NULL);
+    *capacity = newCapacity;
+    return newArray;
+}
+
+static void GrowFrontier(JbTableIndex** frontier, size_t* capacity)
+{
+    size_t newCapacity = *capacity == 0 ? 256 : *capacity * 2;
+    JbTableIndex* newFrontier = realloc(*frontier,
+                                        newCapacity * sizeof(JbTableIndex));
+    assert(newFrontier != NULL);
+    *frontier = newFrontier;
+    *capacity = newCapacity;
 }
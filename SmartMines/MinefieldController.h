@@ -30,10 +30,14 @@
 
 #import <Cocoa/Cocoa.h>
 #import "TableIndexList.h"
+#import "TableSpanList.h"
 #import "Game.h"
 
+@class JbBoardPool;
 @class JbMinefieldView;
 @class JbMinefield;
+@class JbMinefieldSnapshotWriter;
+@class JbMoveJournal;
 @class JbStopwatch;
 
 extern NSString* JbNewHighScoreEntryNotification;
@@ -42,8 +46,10 @@ extern NSString* JbNewHighScoreEntryNotification;
 {
 @private
     JbMinefield* mMinefield;
+    JbBoardPool* mBoardPool;
     IBOutlet JbMinefieldView* minefieldView;
     JbTableIndexList* mLoweredSquares;
+    JbTableSpanList* mAffectedSquares;
     JbGame* mGame;
     NSNumber* mNumberOfUnmarkedMines;
     NSNumber* mElapsedTime;
@@ -55,11 +61,16 @@ extern NSString* JbNewHighScoreEntryNotification;
     NSImageView* mineImageView;
     int mCurrentHighScoreTimeToBeat;
     JbStopwatch* mStopwatch;
+    JbMinefieldSnapshotWriter* mSnapshotWriter;
+    NSTimer* mAutosaveTimer;
+    JbMoveJournal* mJournal;
     NSNumber* mIsRunning;
     NSNumber* mIsPaused;
     NSMenuItem* keyboardMenuItem;
 }
 - (void)applicationDidFinishLaunching:(NSNotification*)notification;
+/// Saves the game in progress, so it can be resumed at the next launch.
+- (void)applicationWillTerminate:(NSNotification*)notification;
 
 - (NSNumber*)numberOfUnmarkedMines;
 - (void)setNumberOfUnmarkedMines:(NSNumber*)numberOfUnmarkedMines;
@@ -85,6 +96,7 @@ extern NSString* JbNewHighScoreEntryNotification;
 - (IBAction)usesSmartMarkChanged:(id)sender;
 - (IBAction)usesSmartUncoverChanged:(id)sender;
 - (IBAction)usesEasyStartChanged:(id)sender;
+- (IBAction)usesNoGuessBoardsChanged:(id)sender;
 - (IBAction)usesSafeUncoverChanged:(id)sender;
 - (IBAction)addHighScoreEntry:(id)sender;
 @end
@@ -30,10 +30,14 @@
 
 #import "MinefieldController.h"
 
+#import "BoardPool.h"
 #import "BoolToStringTransformer.h"
+#import "GameCollection.h"
 #import "HighScores.h"
 #import "Minefield.h"
+#import "MinefieldSnapshot.h"
 #import "MinefieldView.h"
+#import "MoveJournal.h"
 #import "Stopwatch.h"
 
 NSString* JbNewHighScoreEntryNotification = @"JbNewHighScoreEntryNotification";
@@ -46,6 +50,9 @@ static NSString* PlayerNameKey = @"PlayerName";
 static NSString* SafeUncoverKey = @"SafeUncover";
 static NSString* EnableKeyboardKey = @"EnableKeyboard";
 
+/// The number of seconds between the saves of a game in progress.
+static const NSTimeInterval AutosaveInterval = 15.0;
+
 @implementation JbMinefieldController
 + (void)initialize
 {
@@ -54,6 +61,7 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
     [defaultDict setObject:[NSNumber numberWithBool:YES] forKey:SmartMarkKey];
     [defaultDict setObject:[NSNumber numberWithBool:YES] forKey:SmartUncoverKey];
     [defaultDict setObject:[NSNumber numberWithBool:YES] forKey:EasyStartKey];
+    [defaultDict setObject:[NSNumber numberWithBool:NO] forKey:JbNoGuessBoardsKey];
     [defaultDict setObject:[NSNumber numberWithBool:YES] forKey:SafeUncoverKey];
     [defaultDict setObject:[NSNumber numberWithBool:NO] forKey:EnableKeyboardKey];
     [defaultDict setObject:NSFullUserName() forKey:PlayerNameKey];
@@ -69,8 +77,11 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
     if (self != nil)
     {
         mMinefield = [[JbMinefield alloc] init];
+        mBoardPool = [[JbBoardPool alloc] initWithCapacity:8];
+        [mMinefield setBoardPool:mBoardPool];
         minefieldView = nil;
-        mLoweredSquares = nil;
+        mLoweredSquares = [[JbTableIndexList alloc] initWithCapacity:16];
+        mAffectedSquares = [[JbTableSpanList alloc] initWithCapacity:64];
         mNumberOfUnmarkedMines = nil;
         mElapsedTime = nil;
         mElapsedTimeTimer = nil;
@@ -81,6 +92,12 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
         watchImageView = nil;
         mineImageView = nil;
         mStopwatch = [[JbStopwatch alloc] init];
+        mSnapshotWriter = [[JbMinefieldSnapshotWriter alloc]
+                           initWithPath:[JbGameCollection savedGamePath]];
+        mAutosaveTimer = nil;
+        mJournal = [[JbMoveJournal alloc] init];
+        [mJournal setStopwatch:mStopwatch];
+        [mMinefield setJournal:mJournal];
         mIsRunning = [[NSNumber numberWithBool:NO] retain];
         mIsPaused = [[NSNumber numberWithBool:NO] retain];
     }
@@ -91,11 +108,18 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
 {
     [mGame release];
     [mMinefield release];
+    [mBoardPool stop];
+    [mBoardPool release];
     [mLoweredSquares release];
+    [mAffectedSquares release];
     [mNumberOfUnmarkedMines release];
     [mElapsedTime release];
     [mElapsedTimeTimer release];
     [mStopwatch release];
+    [mAutosaveTimer invalidate];
+    [mAutosaveTimer release];
+    [mSnapshotWriter release];
+    [mJournal release];
     [mIsRunning release];
     [mIsPaused release];
     [super dealloc];
@@ -106,6 +130,9 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
     [mElapsedTimeTimer invalidate];
     [mElapsedTimeTimer release];
     mElapsedTimeTimer = nil;
+    [mAutosaveTimer invalidate];
+    [mAutosaveTimer release];
+    mAutosaveTimer = nil;
     [self setValue:[NSNumber numberWithInt:[mStopwatch stop]] forKey:@"elapsedTime"];
     [self setValue:[NSNumber numberWithBool:NO] forKey:@"isRunning"];
 }
@@ -135,6 +162,18 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
     }
 }
 
+/// Makes the board pool generate minefields for the current game and
+/// settings, and discards the ones it has if they have changed.
+- (void)updateBoardPool
+{
+    if (mGame == nil)
+        return;
+    [mBoardPool setSize:[mMinefield size]
+          numberOfMines:[mMinefield numberOfMines]
+          usesEasyStart:[mMinefield usesEasyStart]
+      usesNoGuessBoards:[mMinefield usesNoGuessBoards]];
+}
+
 - (IBAction)newGame:(id)sender
 {
     if (mElapsedTimeTimer != nil)
@@ -142,7 +181,10 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
         [self stopTimer];
     }
     [self setValue:[NSNumber numberWithInt:0] forKey:@"elapsedTime"];
+    if ([mMinefield state] != JbNotStarted)
+        [mSnapshotWriter removeFile];
     [mMinefield clear];
+    [self updateBoardPool];
     [minefieldView clear];
     [self setValue:[NSNumber numberWithInt:[mGame mines]]
             forKey:@"numberOfUnmarkedMines"];
@@ -165,41 +207,58 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
     else
     {
         [mStopwatch stop];
+        [self saveGame:self];
         [minefieldView setEnabled:NO];
         [minefieldView setBackgroundImage:JbVictoryBackgroundImage];
         [self setValue:[NSNumber numberWithBool:YES] forKey:@"isPaused"];
     }
 }
 
-- (void)updateViewWithAffectedSquares:(JbTableIndexList*)affected
+/// Updates the squares in @a affected, one span at a time.
+- (void)updateViewWithAffectedSquares:(JbTableSpanList*)affected
 {
-    JbTableIndex* it = [affected begin];
-    JbTableIndex* end = [affected end];
-    for (; it != end; ++it)
+    [affected normalize];
+    [minefieldView beginUpdates];
+    JbMinefieldSquare squares[64];
+    JbTableSpan* span = [affected begin];
+    JbTableSpan* end = [affected end];
+    for (; span != end; ++span)
     {
-        switch ([mMinefield stateAt:*it])
+        unsigned columnBegin = span->columnBegin;
+        while (columnBegin != span->columnEnd)
         {
-        case JbUncovered:
-            [minefieldView setLowered:YES atIndex:*it];
-            if ([mMinefield hasMineAt:*it])
-                [minefieldView setSymbol:JbMinefieldExplosion atIndex:*it];
-            else
+            unsigned columnEnd = MIN(span->columnEnd, columnBegin + 64);
+            [mMinefield getSquares:squares
+                            inSpan:JbMakeTableSpan(span->row, columnBegin, columnEnd)];
+            for (unsigned col = columnBegin; col != columnEnd; ++col)
             {
-                unsigned mines = [mMinefield countNeighborsWithMinesAt:*it];
-                [minefieldView setSymbol:(JbMinefieldSymbol)mines atIndex:*it];
+                JbTableIndex idx = JbMakeTableIndex(span->row, col);
+                JbMinefieldSquare* square = &squares[col - columnBegin];
+                switch (square->state)
+                {
+                case JbUncovered:
+                    [minefieldView setLowered:YES atIndex:idx];
+                    if (square->hasMine)
+                        [minefieldView setSymbol:JbMinefieldExplosion atIndex:idx];
+                    else
+                        [minefieldView setSymbol:(JbMinefieldSymbol)square->minedNeighbors
+                                         atIndex:idx];
+                    break;
+                case JbUnmarked:
+                    [minefieldView setSymbol:JbMinefieldEmpty atIndex:idx];
+                    break;
+                case JbMarked:
+                    [minefieldView setSymbol:JbMinefieldMark atIndex:idx];
+                    break;
+                case JbQuestionMarked:
+                    [minefieldView setSymbol:JbMinefieldQuestionMark atIndex:idx];
+                    break;
+                }
             }
-            break;
-        case JbUnmarked:
-            [minefieldView setSymbol:JbMinefieldEmpty atIndex:*it];
-            break;
-        case JbMarked:
-            [minefieldView setSymbol:JbMinefieldMark atIndex:*it];
-            break;
-        case JbQuestionMarked:
-            [minefieldView setSymbol:JbMinefieldQuestionMark atIndex:*it];
-            break;
+            columnBegin = columnEnd;
         }
     }
+    [minefieldView endUpdates];
 }
 
 - (void)setPlayerNameDialog:(NSWindow*)window
@@ -210,8 +269,10 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
 - (IBAction)usesQuestionMarksChanged:(id)sender
 {
     NSUserDefaults* ud = [NSUserDefaults standardUserDefaults];
-    JbTableIndexList* affected = [mMinefield setUsesQuestionMarks:[[ud valueForKey:QuestionMarksKey] boolValue]];
-    [self updateViewWithAffectedSquares:affected];
+    [mAffectedSquares removeAllValues];
+    [mMinefield setUsesQuestionMarks:[[ud valueForKey:QuestionMarksKey] boolValue]
+                     affectedSquares:mAffectedSquares];
+    [self updateViewWithAffectedSquares:mAffectedSquares];
 }
 
 - (IBAction)usesSmartMarkChanged:(id)sender
@@ -230,6 +291,18 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
 {
     NSUserDefaults* ud = [NSUserDefaults standardUserDefaults];
     [mMinefield setUsesEasyStart:[[ud valueForKey:EasyStartKey] boolValue]];
+    [self updateBoardPool];
+}
+
+/// Applies the no-guess setting to the current game. The board that is
+/// being played isn't affected, only the ones that are generated later.
+- (IBAction)usesNoGuessBoardsChanged:(id)sender
+{
+    NSUserDefaults* ud = [NSUserDefaults standardUserDefaults];
+    BOOL usesNoGuessBoards = [[ud valueForKey:JbNoGuessBoardsKey] boolValue];
+    [mGame setUsesNoGuessBoards:usesNoGuessBoards];
+    [mMinefield setUsesNoGuessBoards:usesNoGuessBoards];
+    [self updateBoardPool];
 }
 
 - (IBAction)usesSafeUncoverChanged:(id)sender
@@ -277,6 +350,11 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
     }
     mGame = [newGame retain];
     [mMinefield setSize:[mGame size] numberOfMines:[mGame mines]];
+    [mMinefield setUsesNoGuessBoards:[mGame usesNoGuessBoards]];
+    // The menu item shows the game's own setting, which new games inherit.
+    NSUserDefaults* ud = [NSUserDefaults standardUserDefaults];
+    [ud setValue:[NSNumber numberWithBool:[mGame usesNoGuessBoards]]
+          forKey:JbNoGuessBoardsKey];
     [minefieldView setMinefieldSize:[mGame size]];
     [minefieldView setUsesContentResizeIncrement:NO];
     if (![[minefieldView window] setFrameUsingName:[mGame sizeDescription]])
@@ -291,6 +369,7 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
     [self usesSmartMarkChanged:self];
     [self usesSmartUncoverChanged:self];
     [self usesEasyStartChanged:self];
+    [self usesNoGuessBoardsChanged:self];
     [self usesSafeUncoverChanged:self];
     // Disabling the cache is a workaround that prevent images from becoming
     // pixellated when the window is resized. I know of no other way.
@@ -304,6 +383,57 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
 
     [keyboardMenuItem setState:keyboardCursorState ? NSOnState : NSOffState];
     [minefieldView setShowKeyboardCursor:keyboardCursorState];
+
+    [self resumeSavedGame];
+}
+
+/// Writes the game in progress to the saved game file, or removes the file
+/// if the game is over.
+/** Only the parts of the file that have changed since the last save are
+    written.
+*/
+- (void)saveGame:(id)sender
+{
+    if ([mMinefield state] == JbNotCompleted)
+        [mSnapshotWriter writeMinefield:mMinefield elapsedSeconds:[mStopwatch seconds]];
+    else if ([mMinefield state] != JbNotStarted)
+        [mSnapshotWriter removeFile];
+}
+
+/// Resumes the game that was saved when the application quit, if it was a
+/// game of the current size. The game starts paused.
+- (void)resumeSavedGame
+{
+    JbMinefieldSnapshot* snapshot = [JbMinefieldSnapshot snapshotWithContentsOfFile:
+                                        [mSnapshotWriter path]];
+    if (snapshot == nil
+        || [snapshot state] != JbNotCompleted
+        || !JbEqualTableSizes([snapshot size], [mGame size])
+        || [snapshot numberOfMines] != [mGame mines]
+        || ![mMinefield restoreFromSnapshot:snapshot])
+        return;
+
+    JbTableSize size = [mMinefield size];
+    [mAffectedSquares removeAllValues];
+    for (unsigned row = 0; row != size.rows; ++row)
+        [mAffectedSquares addSpan:JbMakeTableSpan(row, 0, size.columns)];
+    [self updateViewWithAffectedSquares:mAffectedSquares];
+    [mAffectedSquares removeAllValues];
+    [self setValue:[NSNumber numberWithInt:[mMinefield numberOfMines] - [mMinefield numberOfMarkedSquares]]
+            forKey:@"numberOfUnmarkedMines"];
+
+    [self startTimer];
+    [mStopwatch resetToSeconds:[snapshot elapsedSeconds]];
+    [self updateTimer:self];
+    [self setValue:[NSNumber numberWithBool:NO] forKey:@"isPaused"];
+    [self pauseGame:self];
+}
+
+- (void)applicationWillTerminate:(NSNotification*)notification
+{
+    if ([mIsRunning boolValue] && ![mIsPaused boolValue])
+        [mStopwatch stop];
+    [self saveGame:self];
 }
 
 - (void)windowWillMiniaturize:(NSNotification*)notification
@@ -324,36 +454,43 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
     }
 }
 
+/// Shows the mines that weren't found and the incorrect marks.
+/** Only the mined, marked and question-marked squares are visited.
+*/
 - (void)revealMinefield
 {
     [minefieldView setNeedsDisplay:YES];
-    JbTableSize size = [mMinefield size];
-    for (unsigned row = 0; row != size.rows; ++row)
+    [minefieldView beginUpdates];
+    JbTableIndexList* squares = [mMinefield mineSquares];
+    for (JbTableIndex* it = [squares begin]; it != [squares end]; ++it)
     {
-        for (unsigned col = 0; col != size.columns; ++col)
+        switch ([mMinefield stateAt:*it])
         {
-            JbTableIndex index = JbMakeTableIndex(row, col);
-            switch ([mMinefield stateAt:index])
-            {
-            case JbUnmarked:
-                if ([mMinefield hasMineAt:index])
-                    [minefieldView setSymbol:JbMinefieldUnmarkedMine atIndex:index];
-                break;
-            case JbMarked:
-                if (![mMinefield hasMineAt:index])
-                    [minefieldView setSymbol:JbMinefieldIncorrectMark atIndex:index];
-                break;
-            case JbQuestionMarked:
-                if ([mMinefield hasMineAt:index])
-                    [minefieldView setSymbol:JbMinefieldQuestionMarkedMine atIndex:index];
-                else
-                    [minefieldView setSymbol:JbMinefieldIncorrectQuestionMark atIndex:index];
-                break;
-            default:
-                break;
-            }
+        case JbUnmarked:
+            [minefieldView setSymbol:JbMinefieldUnmarkedMine atIndex:*it];
+            break;
+        case JbQuestionMarked:
+            [minefieldView setSymbol:JbMinefieldQuestionMarkedMine atIndex:*it];
+            break;
+        default:
+            break;
         }
-    };
+    }
+
+    squares = [mMinefield markedSquares];
+    for (JbTableIndex* it = [squares begin]; it != [squares end]; ++it)
+    {
+        if (![mMinefield hasMineAt:*it])
+            [minefieldView setSymbol:JbMinefieldIncorrectMark atIndex:*it];
+    }
+
+    squares = [mMinefield questionMarkedSquares];
+    for (JbTableIndex* it = [squares begin]; it != [squares end]; ++it)
+    {
+        if (![mMinefield hasMineAt:*it])
+            [minefieldView setSymbol:JbMinefieldIncorrectQuestionMark atIndex:*it];
+    }
+    [minefieldView endUpdates];
 }
 
 - (NSNumber*)numberOfUnmarkedMines
@@ -394,11 +531,12 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
 
 - (BOOL)tryMarkAtIndex:(JbTableIndex)index
 {
-    JbTableIndexList* affected = [mMinefield markAt:index];
-    if ([affected count] == 0)
+    [mAffectedSquares removeAllValues];
+    [mMinefield markAt:index affectedSquares:mAffectedSquares];
+    if ([mAffectedSquares count] == 0)
         return NO;
 
-    [self updateViewWithAffectedSquares:affected];
+    [self updateViewWithAffectedSquares:mAffectedSquares];
     [self setValue:[NSNumber numberWithInt:[mMinefield numberOfMines] - [mMinefield numberOfMarkedSquares]]
             forKey:@"numberOfUnmarkedMines"];
 
@@ -407,7 +545,8 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
 
 - (void)lowerSquaresAtIndex:(JbTableIndex)index
 {
-    mLoweredSquares = [[mMinefield uncoverableAt:index] retain];
+    [mLoweredSquares removeAllValues];
+    [mMinefield uncoverableAt:index affectedSquares:mLoweredSquares];
     JbTableIndex* it = [mLoweredSquares begin];
     JbTableIndex* end = [mLoweredSquares end];
     for (; it != end; ++it)
@@ -433,7 +572,9 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
     NSUserDefaults* ud = [NSUserDefaults standardUserDefaults];
     JbHighScores* highScores = [mGame highScores];
     [highScores addElapsedTime:mElapsedTime
-                     forPlayer:[ud objectForKey:PlayerNameKey]];
+                     forPlayer:[ud objectForKey:PlayerNameKey]
+                    boardValue:[mMinefield metrics].bbbv
+                       journal:[mJournal isStarted] ? [mJournal data] : nil];
     [[NSNotificationCenter defaultCenter] postNotificationName:JbNewHighScoreEntryNotification
                                                         object:mGame];
 }
@@ -454,6 +595,11 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
                                                         selector:@selector(updateTimer:)
                                                         userInfo:nil
                                                          repeats:YES] retain];
+    mAutosaveTimer = [[NSTimer scheduledTimerWithTimeInterval:AutosaveInterval
+                                                       target:self
+                                                     selector:@selector(saveGame:)
+                                                     userInfo:nil
+                                                      repeats:YES] retain];
     [self setValue:[NSNumber numberWithBool:YES] forKey:@"isRunning"];
 }
 
@@ -491,7 +637,6 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
 {
     JbMinefieldState state = [mMinefield state];
     if ((state != JbNotStarted && state != JbNotCompleted)
-        || !mLoweredSquares
         || [mLoweredSquares count] == 0)
         return;
     JbTableIndex* it = [mLoweredSquares begin];
@@ -513,11 +658,7 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
         return;
     }
 
-    if (mLoweredSquares != nil)
-    {
-        [mLoweredSquares release];
-        mLoweredSquares = nil;
-    }
+    [mLoweredSquares removeAllValues];
 
     JbMinefieldState state = [mMinefield state];
     if (state == JbNotStarted)
@@ -533,11 +674,14 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
         return;
     }
 
-    JbTableIndexList* affected = [mMinefield uncoverAt:index];
+    JbTableSpanList* affected = mAffectedSquares;
+    [affected removeAllValues];
+    [mMinefield uncoverAt:index affectedSquares:affected];
     state = [mMinefield state];
     if (state == JbCompleted)
     {
         [self stopTimer];
+        [mSnapshotWriter removeFile];
         [mGame gameWon];
         [minefieldView setBackgroundImage:JbVictoryBackgroundImage];
         [self updateViewWithAffectedSquares:affected];
@@ -563,6 +707,7 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
     else if (state == JbBlownUp)
     {
         [self stopTimer];
+        [mSnapshotWriter removeFile];
         [mGame gameLost];
         [minefieldView setBackgroundImage:JbDefeatBackgroundImage];
         [self updateViewWithAffectedSquares:affected];
@@ -585,7 +730,7 @@ static NSString* EnableKeyboardKey = @"EnableKeyboard";
 {
     JbMinefieldState state = [mMinefield state];
     if ((state == JbBlownUp || state == JbCompleted)
-        || (mLoweredSquares && [mLoweredSquares count] != 0)
+        || [mLoweredSquares count] != 0
         || [mIsPaused boolValue])
     {
         [self commitMouseDownInView:view atIndex:index];
@@ -0,0 +1,143 @@
+//
+//  MinefieldSnapshot.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "BitTable.h"
+#import "Minefield.h"
+
+/// The current version of the snapshot format.
+enum {JbMinefieldSnapshotVersion = 1};
+
+enum
+{
+    JbSnapshotUsesEasyStart = 1,
+    JbSnapshotUsesNoGuessBoards = 2
+};
+
+/// The start of a snapshot file.
+/** The header is followed by the four bit planes in the order of
+    JbMinefieldPlane, each laid out exactly as JbBitTable's words: @a rows
+    rows of @a wordsPerRow 64-bit words. The file is written in the host's
+    byte order, and @a magic doesn't match on a host with the other byte
+    order.
+*/
+typedef struct JbMinefieldSnapshotHeaderStruct
+{
+    uint32_t magic;
+    uint32_t version;
+    /// The offset of the first plane. Later versions may add fields.
+    uint32_t headerSize;
+    uint32_t rows;
+    uint32_t columns;
+    uint32_t wordsPerRow;
+    uint32_t numberOfMines;
+    /// A JbMinefieldState.
+    uint32_t state;
+    /// JbSnapshotUsesEasyStart and JbSnapshotUsesNoGuessBoards.
+    uint32_t flags;
+    uint32_t placementRow;
+    uint32_t placementColumn;
+    /// The number of times the file has been saved.
+    uint32_t numberOfSaves;
+    uint64_t seed;
+    /// The time on the game's stopwatch.
+    double elapsedSeconds;
+} JbMinefieldSnapshotHeader;
+
+/// A minefield snapshot that has been mapped into memory.
+/** The file is validated when it is opened, but not parsed: the planes are
+    JbBitTables whose words point straight into the mapping, and pages are
+    only read from disk when they are used. JbMinefield's
+    restoreFromSnapshot: copies the planes with memcpy and derives the rest
+    of its state from them with bit-parallel counts, so resuming a game on
+    a big board costs about as much as placing its mines.
+*/
+@interface JbMinefieldSnapshot : NSObject
+{
+    void* mMapping;
+    size_t mMappingSize;
+    const JbMinefieldSnapshotHeader* mHeader;
+    JbBitTable mPlanes[JbMinefieldNumberOfPlanes];
+}
+
+/// Returns nil if the file doesn't exist or isn't a valid snapshot.
++ (JbMinefieldSnapshot*)snapshotWithContentsOfFile:(NSString*)path;
+- (id)initWithContentsOfFile:(NSString*)path;
+
+- (const JbMinefieldSnapshotHeader*)header;
+- (JbTableSize)size;
+- (unsigned)numberOfMines;
+- (JbMinefieldState)state;
+- (uint64_t)seed;
+- (JbTableIndex)placementSquare;
+- (BOOL)usesEasyStart;
+- (BOOL)usesNoGuessBoards;
+- (double)elapsedSeconds;
+
+/// The plane's bits, which must not be modified. The table is valid as
+/// long as the snapshot is.
+- (const JbBitTable*)plane:(JbMinefieldPlane)plane;
+@end
+
+/// Saves a minefield to a snapshot file, writing only what has changed.
+/** The writer keeps the file open and a copy of the planes it has written.
+    Every save compares the minefield's planes with the copy and only
+    writes the runs of words that differ, followed by the header, so an
+    autosave during play writes a few hundred bytes even on the largest
+    boards. The first save, and the first after the minefield has changed
+    size, writes the whole file.
+
+    The file isn't synced to disk, so a save doesn't wait for the disk.
+*/
+@interface JbMinefieldSnapshotWriter : NSObject
+{
+    NSString* mPath;
+    int mFile;
+    JbMinefieldSnapshotHeader mHeader;
+    uint64_t* mSavedWords;
+    size_t mNumberOfWords;
+    size_t mNumberOfBytesWritten;
+}
+
+- (id)initWithPath:(NSString*)path;
+- (NSString*)path;
+
+/// Saves @a minefield with @a elapsedSeconds on the stopwatch.
+/** @return NO if the file couldn't be written.
+*/
+- (BOOL)writeMinefield:(JbMinefield*)minefield
+        elapsedSeconds:(double)elapsedSeconds;
+/// The number of bytes the last save wrote.
+- (size_t)numberOfBytesWritten;
+
+/// Deletes the file, if the writer has written it or it is still there from
+/// an earlier session.
+- (void)removeFile;
+@end
@@ -0,0 +1,366 @@
+//
+//  MinefieldSnapshot.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MinefieldSnapshot.h"
+#import <assert.h>
+#import <errno.h>
+#import <fcntl.h>
+#import <stdlib.h>
+#import <string.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
+/// "JbMS" when read as bytes on a little-endian host.
+static const uint32_t SnapshotMagic = 0x534D624A;
+
+/// Differences in a plane that are at most this many words apart are
+/// written together, as one write is cheaper than many small ones.
+enum {MaximumRunGap = 8};
+
+static size_t WordsPerPlane(const JbMinefieldSnapshotHeader* header)
+{
+    return (size_t)header->rows * header->wordsPerRow;
+}
+
+static BOOL IsValidHeader(const JbMinefieldSnapshotHeader* header, size_t fileSize)
+{
+    if (header->magic != SnapshotMagic
+        || header->version != JbMinefieldSnapshotVersion
+        || header->headerSize < sizeof(JbMinefieldSnapshotHeader)
+        || header->headerSize % sizeof(uint64_t) != 0
+        || header->headerSize > fileSize
+        || header->rows == 0 || header->columns == 0
+        || header->wordsPerRow != (header->columns + 63) / 64
+        || header->state > JbBlownUp
+        || header->placementRow >= header->rows
+        || header->placementColumn >= header->columns)
+        return NO;
+    size_t availableWords = (fileSize - header->headerSize) / sizeof(uint64_t);
+    return header->rows <= availableWords / header->wordsPerRow / JbMinefieldNumberOfPlanes;
+}
+
+/// Writes all of @a data at @a offset, retrying after partial writes.
+static BOOL WriteAll(int file, const void* data, size_t size, off_t offset)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    while (size != 0)
+    {
+        ssize_t n = pwrite(file, bytes, size, offset);
+        if (n <= 0)
+        {
+            if (n == -1 && errno == EINTR)
+                continue;
+            return NO;
+        }
+        bytes += n;
+        size -= (size_t)n;
+        offset += n;
+    }
+    return YES;
+}
+
+@implementation JbMinefieldSnapshot
+
++ (JbMinefieldSnapshot*)snapshotWithContentsOfFile:(NSString*)path
+{
+    return [[[JbMinefieldSnapshot alloc] initWithContentsOfFile:path] autorelease];
+}
+
+- (id)initWithContentsOfFile:(NSString*)path
+{
+    self = [super init];
+    if (self)
+    {
+        mMapping = NULL;
+        mMappingSize = 0;
+        mHeader = NULL;
+        memset(mPlanes, 0, sizeof(mPlanes));
+
+        int file = open([path fileSystemRepresentation], O_RDONLY);
+        struct stat status;
+        if (file != -1 && fstat(file, &status) == 0
+            && status.st_size >= (off_t)sizeof(JbMinefieldSnapshotHeader))
+        {
+            void* mapping = mmap(NULL, (size_t)status.st_size, PROT_READ,
+                                 MAP_PRIVATE, file, 0);
+            if (mapping != MAP_FAILED)
+            {
+                mMapping = mapping;
+                mMappingSize = (size_t)status.st_size;
+            }
+        }
+        if (file != -1)
+            close(file);
+        if (mMapping == NULL || !IsValidHeader(mMapping, mMappingSize))
+        {
+            [self release];
+            return nil;
+        }
+
+        mHeader = (const JbMinefieldSnapshotHeader*)mMapping;
+        uint64_t* words = (uint64_t*)((uint8_t*)mMapping + mHeader->headerSize);
+        for (unsigned p = 0; p != JbMinefieldNumberOfPlanes; ++p)
+        {
+            mPlanes[p].rows = mHeader->rows;
+            mPlanes[p].columns = mHeader->columns;
+            mPlanes[p].wordsPerRow = mHeader->wordsPerRow;
+            mPlanes[p].words = words + p * WordsPerPlane(mHeader);
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (mMapping != NULL)
+        munmap(mMapping, mMappingSize);
+    [super dealloc];
+}
+
+- (const JbMinefieldSnapshotHeader*)header
+{
+    return mHeader;
+}
+
+- (JbTableSize)size
+{
+    return JbMakeTableSize(mHeader->rows, mHeader->columns);
+}
+
+- (unsigned)numberOfMines
+{
+    return mHeader->numberOfMines;
+}
+
+- (JbMinefieldState)state
+{
+    return (JbMinefieldState)mHeader->state;
+}
+
+- (uint64_t)seed
+{
+    return mHeader->seed;
+}
+
+- (JbTableIndex)placementSquare
+{
+    return JbMakeTableIndex(mHeader->placementRow, mHeader->placementColumn);
+}
+
+- (BOOL)usesEasyStart
+{
+    return (mHeader->flags & JbSnapshotUsesEasyStart) != 0;
+}
+
+- (BOOL)usesNoGuessBoards
+{
+    return (mHeader->flags & JbSnapshotUsesNoGuessBoards) != 0;
+}
+
+- (double)elapsedSeconds
+{
+    return mHeader->elapsedSeconds;
+}
+
+- (const JbBitTable*)plane:(JbMinefieldPlane)plane
+{
+    assert(plane < JbMinefieldNumberOfPlanes);
+    return &mPlanes[plane];
+}
+
+@end
+
+@implementation JbMinefieldSnapshotWriter
+
+- (id)initWithPath:(NSString*)path
+{
+    self = [super init];
+    if (self)
+    {
+        mPath = [path copy];
+        mFile = -1;
+        memset(&mHeader, 0, sizeof(mHeader));
+        mSavedWords = NULL;
+        mNumberOfWords = 0;
+        mNumberOfBytesWritten = 0;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (mFile != -1)
+        close(mFile);
+    free(mSavedWords);
+    [mPath release];
+    [super dealloc];
+}
+
+- (NSString*)path
+{
+    return mPath;
+}
+
+/// Makes the next save write the whole file.
+- (void)forgetSavedWords
+{
+    free(mSavedWords);
+    mSavedWords = NULL;
+    mNumberOfWords = 0;
+}
+
+/// Writes the words of @a words that differ from @a saved, and updates
+/// @a saved.
+- (BOOL)writeChangedWords:(const uint64_t*)words
+                    saved:(uint64_t*)saved
+                    count:(size_t)count
+                   offset:(off_t)offset
+{
+    size_t i = 0;
+    while (i != count)
+    {
+        if (words[i] == saved[i])
+        {
+            ++i;
+            continue;
+        }
+        size_t last = i;
+        for (size_t j = i + 1; j != count && j - last <= MaximumRunGap; ++j)
+        {
+            if (words[j] != saved[j])
+                last = j;
+        }
+        size_t length = (last + 1 - i) * sizeof(uint64_t);
+        memcpy(saved + i, words + i, length);
+        if (!WriteAll(mFile, saved + i, length, offset + (off_t)(i * sizeof(uint64_t))))
+            return NO;
+        mNumberOfBytesWritten += length;
+        i = last + 1;
+    }
+    return YES;
+}
+
+- (BOOL)writeMinefield:(JbMinefield*)minefield
+        elapsedSeconds:(double)elapsedSeconds
+{
+    mNumberOfBytesWritten = 0;
+    if (mFile == -1)
+    {
+        mFile = open([mPath fileSystemRepresentation], O_RDWR | O_CREAT, 0644);
+        if (mFile == -1)
+            return NO;
+        [self forgetSavedWords];
+        mHeader.numberOfSaves = 0;
+    }
+
+    JbTableSize size = [minefield size];
+    const JbBitTable* mines = [minefield plane:JbMinefieldMinePlane];
+    size_t planeWords = (size_t)mines->rows * mines->wordsPerRow;
+    BOOL isFullWrite = mSavedWords == NULL
+                       || mHeader.rows != size.rows
+                       || mHeader.columns != size.columns;
+    if (isFullWrite)
+    {
+        [self forgetSavedWords];
+        mNumberOfWords = JbMinefieldNumberOfPlanes * planeWords;
+        mSavedWords = malloc(mNumberOfWords * sizeof(uint64_t));
+        NSAssert(mSavedWords != NULL, @"Unable to allocate memory for the snapshot");
+        if (ftruncate(mFile, (off_t)(sizeof(JbMinefieldSnapshotHeader)
+                                     + mNumberOfWords * sizeof(uint64_t))) != 0)
+        {
+            [self forgetSavedWords];
+            return NO;
+        }
+    }
+
+    BOOL success = YES;
+    off_t offset = sizeof(JbMinefieldSnapshotHeader);
+    for (unsigned p = 0; success && p != JbMinefieldNumberOfPlanes; ++p)
+    {
+        const uint64_t* words = [minefield plane:p]->words;
+        uint64_t* saved = mSavedWords + p * planeWords;
+        if (isFullWrite)
+        {
+            memcpy(saved, words, planeWords * sizeof(uint64_t));
+            success = WriteAll(mFile, saved, planeWords * sizeof(uint64_t), offset);
+            mNumberOfBytesWritten += planeWords * sizeof(uint64_t);
+        }
+        else
+        {
+            success = [self writeChangedWords:words
+                                        saved:saved
+                                        count:planeWords
+                                       offset:offset];
+        }
+        offset += planeWords * sizeof(uint64_t);
+    }
+
+    JbTableIndex placement = [minefield placementSquare];
+    mHeader.magic = SnapshotMagic;
+    mHeader.version = JbMinefieldSnapshotVersion;
+    mHeader.headerSize = sizeof(JbMinefieldSnapshotHeader);
+    mHeader.rows = size.rows;
+    mHeader.columns = size.columns;
+    mHeader.wordsPerRow = mines->wordsPerRow;
+    mHeader.numberOfMines = [minefield numberOfMines];
+    mHeader.state = [minefield state];
+    mHeader.flags = ([minefield usesEasyStart] ? JbSnapshotUsesEasyStart : 0)
+                    | ([minefield usesNoGuessBoards] ? JbSnapshotUsesNoGuessBoards : 0);
+    mHeader.placementRow = placement.row;
+    mHeader.placementColumn = placement.column;
+    ++mHeader.numberOfSaves;
+    mHeader.seed = [minefield seed];
+    mHeader.elapsedSeconds = elapsedSeconds;
+    success = success && WriteAll(mFile, &mHeader, sizeof(mHeader), 0);
+    mNumberOfBytesWritten += sizeof(mHeader);
+
+    if (!success)
+        [self forgetSavedWords];
+    return success;
+}
+
+- (size_t)numberOfBytesWritten
+{
+    return mNumberOfBytesWritten;
+}
+
+- (void)removeFile
+{
+    if (mFile != -1)
+    {
+        close(mFile);
+        mFile = -1;
+    }
+    [self forgetSavedWords];
+    unlink([mPath fileSystemRepresentation]);
+}
+
+@end
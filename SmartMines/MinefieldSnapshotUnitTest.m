@@ -0,0 +1,173 @@
+//
+//  MinefieldSnapshotUnitTest.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MinefieldSnapshotUnitTest.h"
+#import <SenTestingKit/SenTestCase.h>
+#import "Minefield.h"
+#import "MinefieldSnapshot.h"
+#import "MinefieldTestHelpers.h"
+
+static NSString* GetSnapshotPath(void)
+{
+    return [NSTemporaryDirectory() stringByAppendingPathComponent:@"JbMinefieldSnapshotUnitTest"];
+}
+
+/// Creates an expert minefield with its middle square uncovered and a mine
+/// marked next to the opening.
+static JbMinefield* MakeMarkedMinefield(uint64_t seed)
+{
+    JbMinefield* minefield = JbMakeStartedMinefield(seed, nil);
+    [minefield markAt:JbFindFrontierSquare(minefield, YES) affectedSquares:nil];
+    return minefield;
+}
+
+/// Uncovers the first covered square without a mine.
+static void UncoverSafeSquare(JbMinefield* minefield)
+{
+    JbTableSize size = [minefield size];
+    for (unsigned row = 0; row != size.rows; ++row)
+    {
+        for (unsigned col = 0; col != size.columns; ++col)
+        {
+            JbTableIndex idx = JbMakeTableIndex(row, col);
+            if ([minefield stateAt:idx] == JbUnmarked && ![minefield hasMineAt:idx])
+            {
+                [minefield uncoverAt:idx affectedSquares:nil];
+                return;
+            }
+        }
+    }
+}
+
+@implementation JbMinefieldSnapshotUnitTest
+
+- (void)testWriteAndRestore
+{
+    JbMinefield* minefield = MakeMarkedMinefield(1);
+    STAssertTrue([minefield numberOfMarkedSquares] == 1, @"No mine was marked");
+    JbMinefieldSnapshotWriter* writer = [[JbMinefieldSnapshotWriter alloc]
+                                         initWithPath:GetSnapshotPath()];
+    STAssertTrue([writer writeMinefield:minefield elapsedSeconds:12.5],
+                 @"The snapshot wasn't written");
+
+    JbMinefieldSnapshot* snapshot = [JbMinefieldSnapshot snapshotWithContentsOfFile:GetSnapshotPath()];
+    STAssertNotNil(snapshot, @"The snapshot wasn't read");
+    STAssertTrue(JbEqualTableSizes([snapshot size], [minefield size]), @"Wrong size");
+    STAssertEquals([snapshot numberOfMines], 99u, nil);
+    STAssertEquals([snapshot seed], [minefield seed], nil);
+    STAssertTrue([snapshot state] == JbNotCompleted, @"Wrong state");
+    STAssertEquals([snapshot elapsedSeconds], 12.5, nil);
+
+    JbMinefield* restored = [[JbMinefield alloc] init];
+    STAssertTrue([restored restoreFromSnapshot:snapshot], @"The snapshot wasn't restored");
+    STAssertTrue(JbHaveSameSquares(restored, minefield), @"The squares weren't restored");
+    STAssertEquals([restored state], [minefield state], nil);
+    STAssertEquals([restored numberOfCoveredSquares], [minefield numberOfCoveredSquares], nil);
+    STAssertEquals([restored numberOfMarkedSquares], [minefield numberOfMarkedSquares], nil);
+    STAssertEquals([restored metrics].bbbv, [minefield metrics].bbbv, nil);
+
+    [restored release];
+    [writer removeFile];
+    [writer release];
+    [minefield release];
+}
+
+- (void)testIncrementalSave
+{
+    JbMinefield* minefield = MakeMarkedMinefield(2);
+    JbMinefieldSnapshotWriter* writer = [[JbMinefieldSnapshotWriter alloc]
+                                         initWithPath:GetSnapshotPath()];
+    [writer writeMinefield:minefield elapsedSeconds:1];
+    size_t firstSize = [writer numberOfBytesWritten];
+    UncoverSafeSquare(minefield);
+    STAssertTrue([writer writeMinefield:minefield elapsedSeconds:2],
+                 @"The snapshot wasn't written");
+    STAssertTrue([writer numberOfBytesWritten] < firstSize,
+                 @"The second save wrote the whole file");
+
+    JbMinefield* restored = [[JbMinefield alloc] init];
+    JbMinefieldSnapshot* snapshot = [JbMinefieldSnapshot snapshotWithContentsOfFile:GetSnapshotPath()];
+    STAssertTrue([restored restoreFromSnapshot:snapshot], @"The snapshot wasn't restored");
+    STAssertTrue(JbHaveSameSquares(restored, minefield), @"The changes weren't saved");
+    STAssertEquals([snapshot elapsedSeconds], 2.0, nil);
+
+    [restored release];
+    [writer removeFile];
+    [writer release];
+    [minefield release];
+}
+
+- (void)testRejectsTruncatedFile
+{
+    JbMinefield* minefield = MakeMarkedMinefield(3);
+    JbMinefieldSnapshotWriter* writer = [[JbMinefieldSnapshotWriter alloc]
+                                         initWithPath:GetSnapshotPath()];
+    [writer writeMinefield:minefield elapsedSeconds:0];
+    NSData* data = [NSData dataWithContentsOfFile:GetSnapshotPath()];
+    [[data subdataWithRange:NSMakeRange(0, [data length] - 8)] writeToFile:GetSnapshotPath()
+                                                                atomically:NO];
+    STAssertNil([JbMinefieldSnapshot snapshotWithContentsOfFile:GetSnapshotPath()],
+                @"A truncated snapshot was read");
+
+    [writer removeFile];
+    [writer release];
+    [minefield release];
+}
+
+- (void)testRejectsInconsistentPlanes
+{
+    JbMinefield* minefield = MakeMarkedMinefield(4);
+    JbMinefieldSnapshotWriter* writer = [[JbMinefieldSnapshotWriter alloc]
+                                         initWithPath:GetSnapshotPath()];
+    [writer writeMinefield:minefield elapsedSeconds:0];
+
+    // Mark the middle square, which is uncovered.
+    NSMutableData* data = [NSMutableData dataWithContentsOfFile:GetSnapshotPath()];
+    const JbMinefieldSnapshotHeader* header = [data bytes];
+    size_t planeSize = (size_t)header->rows * header->wordsPerRow * sizeof(uint64_t);
+    uint64_t* marked = (uint64_t*)((uint8_t*)[data mutableBytes] + header->headerSize
+                                   + JbMinefieldMarkedPlane * planeSize);
+    marked[8 * header->wordsPerRow] |= (uint64_t)1 << 15;
+    [data writeToFile:GetSnapshotPath() atomically:NO];
+
+    JbMinefield* restored = [[JbMinefield alloc] init];
+    JbMinefieldSnapshot* snapshot = [JbMinefieldSnapshot snapshotWithContentsOfFile:GetSnapshotPath()];
+    STAssertNotNil(snapshot, @"The snapshot wasn't read");
+    STAssertFalse([restored restoreFromSnapshot:snapshot],
+                  @"A snapshot with an uncovered, marked square was restored");
+    STAssertTrue([restored state] == JbNotStarted, @"The minefield wasn't cleared");
+
+    [restored release];
+    [writer removeFile];
+    [writer release];
+    [minefield release];
+}
+
+@end
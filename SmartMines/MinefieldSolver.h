@@ -0,0 +1,162 @@
+//
+//  MinefieldSolver.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "BitTable.h"
+#import "Minefield.h"
+#import "TableIndexList.h"
+
+/// Squares deduced to be safe and to have mines, as bit masks.
+typedef struct JbDeductionsStruct
+{
+    uint64_t safe;
+    uint64_t mined;
+} JbDeductions;
+
+/// Compares two numbers whose unknown neighbors overlap.
+/** @a a and @a b are the unknown neighbors of the two numbers, and
+    @a minesA and @a minesB the number of mines among them. The shared
+    squares hold at least as many mines as neither number can fit in its
+    own squares, and at most as many as both numbers and the shared squares
+    allow. When those bounds pin down the mines in one of the three groups
+    of squares (only around a, only around b, or shared) to none or to
+    every square in the group, the whole group is deduced. Nothing is
+    deduced if the numbers contradict each other.
+*/
+JbDeductions JbCompareNumbers(uint64_t a, unsigned minesA,
+                              uint64_t b, unsigned minesB);
+
+/// Deduces which covered squares of a minefield are safe and which are mined.
+/** The solver only knows what a player can see: the squares it has been told
+    are uncovered, the number of mined neighbors they show and the total
+    number of mines. It applies the same rules as smart mark and smart
+    uncover (a number that needs no more mines, or as many mines as it has
+    unknown neighbors), and compares pairs of numbers that share unknown
+    squares (the subset and superset rules, e.g. the "1-2" patterns).
+
+    Only numbers whose surroundings have changed are examined again. Every
+    newly uncovered square and every deduction puts the uncovered squares
+    around it on a worklist, and solve runs until the worklist is empty, so
+    a move costs time in proportion to the part of the frontier it affected
+    rather than to the size of the minefield.
+
+    Deductions are the solver's own: it neither reads nor sets the marks in
+    a JbMinefield.
+*/
+@interface JbMinefieldSolver : NSObject
+{
+    JbTableSize mSize;
+    unsigned mNumberOfMines;
+    JbBitTable mUncovered;
+    JbBitTable mMines;
+    JbBitTable mSafe;
+    JbBitTable mQueued;
+    uint8_t* mNumbers;
+    JbTableIndex* mQueue;
+    size_t mQueueHead;
+    size_t mQueueCount;
+    unsigned mNumberOfUnknownSquares;
+    unsigned mNumberOfKnownMines;
+    unsigned long long mNumberOfSteps;
+    unsigned long long mNumberOfMoves;
+    JbTableIndexList* mSafeSquares;
+    JbTableIndexList* mMineSquares;
+    JbTableIndexList* mPendingSquares;
+    JbTableIndexList* mAffectedSquares;
+}
+
+- (id)initWithSize:(JbTableSize)size numberOfMines:(unsigned)mines;
+/// Forgets everything the solver knows about the current minefield.
+- (void)clear;
+
+- (JbTableSize)size;
+- (unsigned)numberOfMines;
+
+/// Tells the solver that the square at @a idx is uncovered and has @a count
+/// mined neighbors.
+- (void)uncoverAt:(JbTableIndex)idx minedNeighbors:(unsigned)count;
+/// Calls uncoverAt:minedNeighbors: for every square in @a squares that is
+/// uncovered in @a minefield.
+/** @a squares is typically the list returned by JbMinefield's uncoverAt:.
+*/
+- (void)addUncoveredSquares:(JbTableIndexList*)squares
+                ofMinefield:(JbMinefield*)minefield;
+/// Calls uncoverAt:minedNeighbors: for every uncovered square in
+/// @a minefield.
+- (void)addUncoveredSquaresOfMinefield:(JbMinefield*)minefield;
+
+/// Applies the rules until nothing more can be deduced.
+/** @return YES if anything new was deduced.
+*/
+- (BOOL)solve;
+
+/// The squares that have been deduced to be safe.
+/** Deductions are appended to the list as they are made. The caller may
+    empty it with removeAllValues once the squares have been dealt with.
+    Squares that have been uncovered since they were deduced to be safe
+    remain in the list.
+*/
+- (JbTableIndexList*)safeSquares;
+/// The squares that have been deduced to have mines.
+/** Like safeSquares, the caller may empty the list.
+*/
+- (JbTableIndexList*)mineSquares;
+
+/// True if the square at @a idx is uncovered or deduced to be safe.
+- (BOOL)isSafeAt:(JbTableIndex)idx;
+/// True if the square at @a idx is deduced to have a mine.
+- (BOOL)hasMineAt:(JbTableIndex)idx;
+/// True if the square at @a idx is neither uncovered nor deduced.
+- (BOOL)isUnknownAt:(JbTableIndex)idx;
+
+- (unsigned)numberOfUnknownSquares;
+- (unsigned)numberOfKnownMines;
+
+/// The number of squares taken off the worklist since the solver was created.
+- (unsigned long long)numberOfSteps;
+
+/// The number of squares solveMinefield: has uncovered since the solver
+/// was created.
+- (unsigned long long)numberOfMoves;
+
+/// Returns the square the solver knows nothing about that is least likely
+/// to have a mine, according to JbMinefield's mineProbabilities.
+/** This is the best guess when solveMinefield: is stuck.
+*/
+- (JbTableIndex)guessSquareOfMinefield:(JbMinefield*)minefield;
+
+/// Uncovers every square in @a minefield that can be deduced to be safe.
+/** @a minefield must have been started and the solver must know about its
+    uncovered squares. The solver and the minefield take turns until the
+    game is completed or the solver gets stuck.
+    @return YES if the game was completed without guessing.
+*/
+- (BOOL)solveMinefield:(JbMinefield*)minefield;
+@end
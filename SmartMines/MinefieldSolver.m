@@ -0,0 +1,549 @@
+//
+//  MinefieldSolver.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MinefieldSolver.h"
+#import <assert.h>
+#import <stdlib.h>
+#import <string.h>
+
+/// The squares around a number are handled as bit masks in a 7x7 frame
+/// centred on the number that is being examined.
+/** Square (r, c), relative to the centre, is bit (r + 3) * 7 + (c + 3). The
+    frame is large enough for the neighbors of every number within two rows
+    and columns of the centre, which are all the numbers whose neighbors can
+    overlap with those of the centre.
+*/
+enum {FrameWidth = 7, FrameCentre = 3};
+
+static inline unsigned CountBits(uint64_t bits)
+{
+    return (unsigned)__builtin_popcountll(bits);
+}
+
+static inline BOOL IsKnown(const JbBitTable* uncovered,
+                           const JbBitTable* mines,
+                           const JbBitTable* safe,
+                           unsigned row, unsigned column)
+{
+    return JbGetBit(uncovered, row, column)
+           || JbGetBit(mines, row, column)
+           || JbGetBit(safe, row, column);
+}
+
+/// Returns the unknown neighbors of the square at @a idx as a frame mask.
+/** @a idx is at (@a rowOffset, @a columnOffset) relative to the centre of
+    the frame. The number of neighbors known to have mines is returned in
+    @a knownMines.
+*/
+static uint64_t UnknownNeighbors(const JbBitTable* uncovered,
+                                 const JbBitTable* mines,
+                                 const JbBitTable* safe,
+                                 JbTableIndex idx,
+                                 int rowOffset, int columnOffset,
+                                 unsigned* knownMines)
+{
+    uint64_t mask = 0;
+    *knownMines = 0;
+    unsigned rowBegin = idx.row != 0 ? idx.row - 1 : 0;
+    unsigned rowEnd = MIN(idx.row + 2, uncovered->rows);
+    unsigned colBegin = idx.column != 0 ? idx.column - 1 : 0;
+    unsigned colEnd = MIN(idx.column + 2, uncovered->columns);
+    for (unsigned row = rowBegin; row != rowEnd; ++row)
+    {
+        int frameRow = (int)row - (int)idx.row + rowOffset + FrameCentre;
+        for (unsigned col = colBegin; col != colEnd; ++col)
+        {
+            if (JbGetBit(mines, row, col))
+                ++*knownMines;
+            else if (!JbGetBit(uncovered, row, col) && !JbGetBit(safe, row, col))
+            {
+                int frameCol = (int)col - (int)idx.column + columnOffset + FrameCentre;
+                mask |= (uint64_t)1 << (frameRow * FrameWidth + frameCol);
+            }
+        }
+    }
+    return mask;
+}
+
+JbDeductions JbCompareNumbers(uint64_t a, unsigned minesA,
+                              uint64_t b, unsigned minesB)
+{
+    JbDeductions result = {0, 0};
+    uint64_t shared = a & b, onlyA = a & ~b, onlyB = b & ~a;
+    unsigned sharedCount = CountBits(shared);
+    unsigned onlyACount = CountBits(onlyA);
+    unsigned onlyBCount = CountBits(onlyB);
+
+    int low = 0;
+    if ((int)minesA - (int)onlyACount > low)
+        low = (int)minesA - (int)onlyACount;
+    if ((int)minesB - (int)onlyBCount > low)
+        low = (int)minesB - (int)onlyBCount;
+    int high = (int)MIN(sharedCount, MIN(minesA, minesB));
+    if (low > high)
+        return result; // The numbers contradict each other.
+
+    if ((int)minesA == low)
+        result.safe |= onlyA;
+    else if ((int)minesA - high == (int)onlyACount)
+        result.mined |= onlyA;
+
+    if ((int)minesB == low)
+        result.safe |= onlyB;
+    else if ((int)minesB - high == (int)onlyBCount)
+        result.mined |= onlyB;
+
+    if (high == 0)
+        result.safe |= shared;
+    else if (low == (int)sharedCount)
+        result.mined |= shared;
+
+    return result;
+}
+
+@implementation JbMinefieldSolver
+
+- (id)init
+{
+    self = [super init];
+    if (self != nil)
+    {
+        memset(&mUncovered, 0, sizeof(mUncovered));
+        memset(&mMines, 0, sizeof(mMines));
+        memset(&mSafe, 0, sizeof(mSafe));
+        memset(&mQueued, 0, sizeof(mQueued));
+        mNumbers = NULL;
+        mQueue = NULL;
+        mSize = JbMakeTableSize(0, 0);
+        mNumberOfMines = 0;
+        mNumberOfSteps = 0;
+        mNumberOfMoves = 0;
+        mSafeSquares = [[JbTableIndexList alloc] initWithCapacity:64];
+        mMineSquares = [[JbTableIndexList alloc] initWithCapacity:64];
+        mPendingSquares = [[JbTableIndexList alloc] initWithCapacity:64];
+        mAffectedSquares = [[JbTableIndexList alloc] initWithCapacity:64];
+    }
+    return self;
+}
+
+- (id)initWithSize:(JbTableSize)size numberOfMines:(unsigned)mines
+{
+    assert(size.rows > 0 && size.columns > 0);
+    self = [self init];
+    if (self)
+    {
+        mSize = size;
+        mNumberOfMines = mines;
+        size_t squares = (size_t)size.rows * size.columns;
+        BOOL success = JbInitBitTable(&mUncovered, size.rows, size.columns)
+                       && JbInitBitTable(&mMines, size.rows, size.columns)
+                       && JbInitBitTable(&mSafe, size.rows, size.columns)
+                       && JbInitBitTable(&mQueued, size.rows, size.columns);
+        mNumbers = (uint8_t*)malloc(JbNibbleArraySize(squares));
+        // A square is never in the queue more than once.
+        mQueue = (JbTableIndex*)malloc(squares * sizeof(JbTableIndex));
+        NSAssert(success && mNumbers != NULL && mQueue != NULL,
+                 @"Unable to allocate memory for the solver");
+        [self clear];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    JbFreeBitTable(&mUncovered);
+    JbFreeBitTable(&mMines);
+    JbFreeBitTable(&mSafe);
+    JbFreeBitTable(&mQueued);
+    if (mNumbers != NULL)
+        free(mNumbers);
+    if (mQueue != NULL)
+        free(mQueue);
+    [mSafeSquares release];
+    [mMineSquares release];
+    [mPendingSquares release];
+    [mAffectedSquares release];
+    [super dealloc];
+}
+
+- (void)clear
+{
+    assert(mNumbers != NULL);
+    JbFillBitTable(&mUncovered, NO);
+    JbFillBitTable(&mMines, NO);
+    JbFillBitTable(&mSafe, NO);
+    JbFillBitTable(&mQueued, NO);
+    memset(mNumbers, 0, JbNibbleArraySize((size_t)mSize.rows * mSize.columns));
+    mQueueHead = 0;
+    mQueueCount = 0;
+    mNumberOfUnknownSquares = mSize.rows * mSize.columns;
+    mNumberOfKnownMines = 0;
+    [mSafeSquares removeAllValues];
+    [mMineSquares removeAllValues];
+}
+
+- (JbTableSize)size
+{
+    return mSize;
+}
+
+- (unsigned)numberOfMines
+{
+    return mNumberOfMines;
+}
+
+- (void)enqueueAt:(JbTableIndex)idx
+{
+    if (JbGetBit(&mQueued, idx.row, idx.column))
+        return;
+    JbSetBit(&mQueued, idx.row, idx.column);
+    size_t squares = (size_t)mSize.rows * mSize.columns;
+    size_t tail = mQueueHead + mQueueCount;
+    mQueue[tail < squares ? tail : tail - squares] = idx;
+    ++mQueueCount;
+}
+
+/// Puts the uncovered squares around (and at) @a idx on the worklist.
+- (void)enqueueNumbersAround:(JbTableIndex)idx
+{
+    unsigned rowBegin = idx.row != 0 ? idx.row - 1 : 0;
+    unsigned rowEnd = MIN(idx.row + 2, mSize.rows);
+    unsigned colBegin = idx.column != 0 ? idx.column - 1 : 0;
+    unsigned colEnd = MIN(idx.column + 2, mSize.columns);
+    for (unsigned row = rowBegin; row != rowEnd; ++row)
+        for (unsigned col = colBegin; col != colEnd; ++col)
+            if (JbGetBit(&mUncovered, row, col))
+                [self enqueueAt:JbMakeTableIndex(row, col)];
+}
+
+- (JbTableIndex)dequeue
+{
+    assert(mQueueCount != 0);
+    JbTableIndex idx = mQueue[mQueueHead];
+    JbClearBit(&mQueued, idx.row, idx.column);
+    if (++mQueueHead == (size_t)mSize.rows * mSize.columns)
+        mQueueHead = 0;
+    --mQueueCount;
+    return idx;
+}
+
+- (void)deduceSafeAt:(JbTableIndex)idx
+{
+    assert(!IsKnown(&mUncovered, &mMines, &mSafe, idx.row, idx.column));
+    JbSetBit(&mSafe, idx.row, idx.column);
+    --mNumberOfUnknownSquares;
+    [mSafeSquares addValue:idx];
+    [self enqueueNumbersAround:idx];
+}
+
+- (void)deduceMineAt:(JbTableIndex)idx
+{
+    assert(!IsKnown(&mUncovered, &mMines, &mSafe, idx.row, idx.column));
+    JbSetBit(&mMines, idx.row, idx.column);
+    --mNumberOfUnknownSquares;
+    ++mNumberOfKnownMines;
+    [mMineSquares addValue:idx];
+    [self enqueueNumbersAround:idx];
+}
+
+/// Applies @a deductions, given as a frame mask centred on @a centre.
+- (void)applyDeductions:(JbDeductions)deductions aroundSquareAt:(JbTableIndex)centre
+{
+    while (deductions.safe != 0)
+    {
+        unsigned bit = (unsigned)__builtin_ctzll(deductions.safe);
+        deductions.safe &= deductions.safe - 1;
+        [self deduceSafeAt:JbMakeTableIndex(centre.row + bit / FrameWidth - FrameCentre,
+                                            centre.column + bit % FrameWidth - FrameCentre)];
+    }
+    while (deductions.mined != 0)
+    {
+        unsigned bit = (unsigned)__builtin_ctzll(deductions.mined);
+        deductions.mined &= deductions.mined - 1;
+        [self deduceMineAt:JbMakeTableIndex(centre.row + bit / FrameWidth - FrameCentre,
+                                            centre.column + bit % FrameWidth - FrameCentre)];
+    }
+}
+
+- (unsigned)numberAt:(JbTableIndex)idx
+{
+    return JbGetNibble(mNumbers, (size_t)idx.row * mSize.columns + idx.column);
+}
+
+/// Applies the rules to the number at @a idx.
+/** First the number is examined on its own, then it is compared with every
+    number within two rows and columns of it. The number is put back on the
+    worklist after a deduction, since the remaining comparisons haven't been
+    made.
+*/
+- (void)examineSquareAt:(JbTableIndex)idx
+{
+    unsigned knownMines;
+    uint64_t a = UnknownNeighbors(&mUncovered, &mMines, &mSafe, idx, 0, 0, &knownMines);
+    if (a == 0)
+        return;
+
+    unsigned number = [self numberAt:idx];
+    assert(knownMines <= number);
+    unsigned minesA = number - knownMines;
+    JbDeductions deductions = {0, 0};
+    if (minesA == 0)
+        deductions.safe = a;
+    else if (minesA == CountBits(a))
+        deductions.mined = a;
+    if (deductions.safe != 0 || deductions.mined != 0)
+    {
+        [self applyDeductions:deductions aroundSquareAt:idx];
+        return;
+    }
+
+    unsigned rowBegin = idx.row >= 2 ? idx.row - 2 : 0;
+    unsigned rowEnd = MIN(idx.row + 3, mSize.rows);
+    unsigned colBegin = idx.column >= 2 ? idx.column - 2 : 0;
+    unsigned colEnd = MIN(idx.column + 3, mSize.columns);
+    for (unsigned row = rowBegin; row != rowEnd; ++row)
+    {
+        for (unsigned col = colBegin; col != colEnd; ++col)
+        {
+            if (!JbGetBit(&mUncovered, row, col)
+                || (row == idx.row && col == idx.column))
+                continue;
+            JbTableIndex other = JbMakeTableIndex(row, col);
+            uint64_t b = UnknownNeighbors(&mUncovered, &mMines, &mSafe, other,
+                                          (int)row - (int)idx.row,
+                                          (int)col - (int)idx.column,
+                                          &knownMines);
+            if ((a & b) == 0)
+                continue;
+            deductions = JbCompareNumbers(a, minesA, b, [self numberAt:other] - knownMines);
+            if (deductions.safe != 0 || deductions.mined != 0)
+            {
+                [self applyDeductions:deductions aroundSquareAt:idx];
+                [self enqueueAt:idx];
+                return;
+            }
+        }
+    }
+}
+
+/// Deduces the remaining squares when the mine count alone decides them.
+/** @return YES if anything was deduced.
+*/
+- (BOOL)applyMineCount
+{
+    if (mNumberOfUnknownSquares == 0)
+        return NO;
+    unsigned remainingMines = mNumberOfMines - mNumberOfKnownMines;
+    BOOL allSafe = remainingMines == 0;
+    if (!allSafe && remainingMines != mNumberOfUnknownSquares)
+        return NO;
+
+    for (unsigned row = 0; row != mSize.rows; ++row)
+    {
+        const uint64_t* uncovered = JbBitTableRow(&mUncovered, row);
+        const uint64_t* mines = JbBitTableRow(&mMines, row);
+        const uint64_t* safe = JbBitTableRow(&mSafe, row);
+        for (unsigned w = 0; w != mUncovered.wordsPerRow; ++w)
+        {
+            uint64_t unknown = ~(uncovered[w] | mines[w] | safe[w]);
+            if (w == mUncovered.wordsPerRow - 1 && mSize.columns % 64 != 0)
+                unknown &= ((uint64_t)1 << (mSize.columns % 64)) - 1;
+            while (unknown != 0)
+            {
+                unsigned col = w * 64 + __builtin_ctzll(unknown);
+                unknown &= unknown - 1;
+                if (allSafe)
+                    [self deduceSafeAt:JbMakeTableIndex(row, col)];
+                else
+                    [self deduceMineAt:JbMakeTableIndex(row, col)];
+            }
+        }
+    }
+    return YES;
+}
+
+- (void)uncoverAt:(JbTableIndex)idx minedNeighbors:(unsigned)count
+{
+    assert(mNumbers != NULL);
+    assert(idx.row < mSize.rows && idx.column < mSize.columns);
+    if (JbGetBit(&mUncovered, idx.row, idx.column))
+        return;
+    assert(!JbGetBit(&mMines, idx.row, idx.column));
+
+    if (JbGetBit(&mSafe, idx.row, idx.column))
+        JbClearBit(&mSafe, idx.row, idx.column);
+    else
+        --mNumberOfUnknownSquares;
+    JbSetBit(&mUncovered, idx.row, idx.column);
+    JbSetNibble(mNumbers, (size_t)idx.row * mSize.columns + idx.column, count);
+    [self enqueueNumbersAround:idx];
+}
+
+- (void)addUncoveredSquares:(JbTableIndexList*)squares
+                ofMinefield:(JbMinefield*)minefield
+{
+    assert(JbEqualTableSizes([minefield size], mSize));
+    for (JbTableIndex* it = [squares begin]; it != [squares end]; ++it)
+    {
+        if ([minefield stateAt:*it] == JbUncovered && ![minefield hasMineAt:*it])
+            [self uncoverAt:*it minedNeighbors:[minefield countNeighborsWithMinesAt:*it]];
+    }
+}
+
+- (void)addUncoveredSquaresOfMinefield:(JbMinefield*)minefield
+{
+    assert(JbEqualTableSizes([minefield size], mSize));
+    if ([minefield state] == JbNotStarted)
+        return;
+    JbTableIterator it = JbMakeTableIterator(0, 0, mSize.rows, mSize.columns);
+    while (JbTableIteratorNext(&it))
+    {
+        if ([minefield stateAt:it.index] == JbUncovered && ![minefield hasMineAt:it.index])
+            [self uncoverAt:it.index
+             minedNeighbors:[minefield countNeighborsWithMinesAt:it.index]];
+    }
+}
+
+- (BOOL)solve
+{
+    size_t deductions = [mSafeSquares count] + [mMineSquares count];
+    do
+    {
+        while (mQueueCount != 0)
+        {
+            ++mNumberOfSteps;
+            [self examineSquareAt:[self dequeue]];
+        }
+    } while ([self applyMineCount]);
+    return [mSafeSquares count] + [mMineSquares count] != deductions;
+}
+
+- (JbTableIndexList*)safeSquares
+{
+    return mSafeSquares;
+}
+
+- (JbTableIndexList*)mineSquares
+{
+    return mMineSquares;
+}
+
+- (BOOL)isSafeAt:(JbTableIndex)idx
+{
+    assert(idx.row < mSize.rows && idx.column < mSize.columns);
+    return JbGetBit(&mUncovered, idx.row, idx.column)
+           || JbGetBit(&mSafe, idx.row, idx.column);
+}
+
+- (BOOL)hasMineAt:(JbTableIndex)idx
+{
+    assert(idx.row < mSize.rows && idx.column < mSize.columns);
+    return JbGetBit(&mMines, idx.row, idx.column);
+}
+
+- (BOOL)isUnknownAt:(JbTableIndex)idx
+{
+    assert(idx.row < mSize.rows && idx.column < mSize.columns);
+    return !IsKnown(&mUncovered, &mMines, &mSafe, idx.row, idx.column);
+}
+
+- (unsigned)numberOfUnknownSquares
+{
+    return mNumberOfUnknownSquares;
+}
+
+- (unsigned)numberOfKnownMines
+{
+    return mNumberOfKnownMines;
+}
+
+- (unsigned long long)numberOfSteps
+{
+    return mNumberOfSteps;
+}
+
+- (unsigned long long)numberOfMoves
+{
+    return mNumberOfMoves;
+}
+
+- (JbTableIndex)guessSquareOfMinefield:(JbMinefield*)minefield
+{
+    assert(JbEqualTableSizes([minefield size], mSize));
+    const double* probabilities = [minefield mineProbabilities];
+    JbTableIndex best = JbMakeTableIndex(0, 0);
+    double bestProbability = 2;
+    JbTableIterator it = JbMakeTableIterator(0, 0, mSize.rows, mSize.columns);
+    while (JbTableIteratorNext(&it))
+    {
+        double p = probabilities[(size_t)it.index.row * mSize.columns + it.index.column];
+        if (p < bestProbability
+            && [minefield stateAt:it.index] == JbUnmarked
+            && [self isUnknownAt:it.index])
+        {
+            best = it.index;
+            bestProbability = p;
+        }
+    }
+    return best;
+}
+
+- (BOOL)solveMinefield:(JbMinefield*)minefield
+{
+    assert(JbEqualTableSizes([minefield size], mSize));
+    assert([minefield state] != JbNotStarted);
+
+    while ([minefield state] == JbNotCompleted)
+    {
+        [self solve];
+        if ([mSafeSquares count] == 0)
+            break;
+
+        [mPendingSquares removeAllValues];
+        [mPendingSquares addValues:[mSafeSquares begin] count:[mSafeSquares count]];
+        [mSafeSquares removeAllValues];
+
+        JbTableIndex* end = [mPendingSquares end];
+        for (JbTableIndex* it = [mPendingSquares begin]; it != end; ++it)
+        {
+            if ([minefield stateAt:*it] != JbUnmarked)
+                continue;
+            [mAffectedSquares removeAllValues];
+            [minefield uncoverAt:*it affectedSquares:mAffectedSquares];
+            ++mNumberOfMoves;
+            [self addUncoveredSquares:mAffectedSquares ofMinefield:minefield];
+            if ([minefield state] != JbNotCompleted)
+                break;
+        }
+    }
+    return [minefield state] == JbCompleted;
+}
+
+@end
@@ -0,0 +1,182 @@
+//
+//  MinefieldSolverUnitTest.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MinefieldSolverUnitTest.h"
+#import <SenTestingKit/SenTestCase.h>
+#import "MinefieldSolver.h"
+
+/// Creates a solver for a minefield drawn as strings, one per row, and
+/// tells it about the uncovered squares.
+/** A digit is an uncovered square with that many mined neighbors, and any
+    other character a covered square.
+*/
+static JbMinefieldSolver* MakeSolver(const char* const* rows, unsigned rowCount,
+                                     unsigned mines)
+{
+    unsigned columns = (unsigned)strlen(rows[0]);
+    JbMinefieldSolver* solver = [[JbMinefieldSolver alloc]
+                                 initWithSize:JbMakeTableSize(rowCount, columns)
+                                 numberOfMines:mines];
+    for (unsigned row = 0; row != rowCount; ++row)
+    {
+        for (unsigned col = 0; col != columns; ++col)
+        {
+            if (rows[row][col] >= '0' && rows[row][col] <= '8')
+                [solver uncoverAt:JbMakeTableIndex(row, col)
+                   minedNeighbors:(unsigned)(rows[row][col] - '0')];
+        }
+    }
+    return solver;
+}
+
+/// True if the solver has deduced exactly the squares in @a rows.
+/** '*' is a square deduced to have a mine, '.' a square deduced to be safe
+    and '-' an unknown square. Digits are uncovered squares.
+*/
+static BOOL HasDeductions(JbMinefieldSolver* solver, const char* const* rows)
+{
+    JbTableSize size = [solver size];
+    size_t safeSquares = 0, mineSquares = 0;
+    for (unsigned row = 0; row != size.rows; ++row)
+    {
+        for (unsigned col = 0; col != size.columns; ++col)
+        {
+            JbTableIndex idx = JbMakeTableIndex(row, col);
+            BOOL isCorrect;
+            switch (rows[row][col])
+            {
+            case '*':
+                isCorrect = [solver hasMineAt:idx];
+                ++mineSquares;
+                break;
+            case '.':
+                isCorrect = [solver isSafeAt:idx];
+                ++safeSquares;
+                break;
+            case '-':
+                isCorrect = [solver isUnknownAt:idx];
+                break;
+            default:
+                isCorrect = [solver isSafeAt:idx];
+                break;
+            }
+            if (!isCorrect)
+                return NO;
+        }
+    }
+    return [[solver safeSquares] count] == safeSquares
+           && [[solver mineSquares] count] == mineSquares;
+}
+
+@implementation JbMinefieldSolverUnitTest
+
+- (void)testCompareNumbers
+{
+    // Squares 0 and 1 are next to both numbers, square 2 only to b.
+    JbDeductions deductions = JbCompareNumbers(0x3, 1, 0x7, 1);
+    STAssertTrue(deductions.safe == 0x4 && deductions.mined == 0,
+                 @"Wrong deductions from 1-1");
+    deductions = JbCompareNumbers(0x3, 1, 0x7, 2);
+    STAssertTrue(deductions.safe == 0 && deductions.mined == 0x4,
+                 @"Wrong deductions from 1-2");
+
+    // Square 1 is shared, square 0 is only next to a and square 2 only to b.
+    deductions = JbCompareNumbers(0x3, 2, 0x6, 1);
+    STAssertTrue(deductions.safe == 0x4 && deductions.mined == 0x3,
+                 @"Wrong deductions from 2-1 sharing one square");
+    deductions = JbCompareNumbers(0x3, 1, 0x6, 1);
+    STAssertTrue(deductions.safe == 0 && deductions.mined == 0,
+                 @"Deduced something from 1-1 sharing one square");
+    deductions = JbCompareNumbers(0x3, 0, 0x6, 1);
+    STAssertTrue(deductions.safe == 0x3 && deductions.mined == 0x4,
+                 @"Wrong deductions from 0-1 sharing one square");
+
+    deductions = JbCompareNumbers(0x1, 1, 0x1, 0);
+    STAssertTrue(deductions.safe == 0 && deductions.mined == 0,
+                 @"Deduced something from contradicting numbers");
+}
+
+- (void)testSolveOneOne
+{
+    static const char* const Minefield[] = {"----",
+                                            "11--"};
+    static const char* const Expected[] = {"--.-",
+                                           "11.-"};
+    JbMinefieldSolver* solver = MakeSolver(Minefield, 2, 2);
+    STAssertTrue([solver solve], @"Nothing was deduced");
+    STAssertTrue(HasDeductions(solver, Expected), @"Wrong deductions");
+    [solver release];
+}
+
+- (void)testSolveOneTwo
+{
+    static const char* const Minefield[] = {"---",
+                                            "121"};
+    static const char* const Expected[] = {"*.*",
+                                           "121"};
+    JbMinefieldSolver* solver = MakeSolver(Minefield, 2, 2);
+    STAssertTrue([solver solve], @"Nothing was deduced");
+    STAssertTrue(HasDeductions(solver, Expected), @"Wrong deductions");
+    [solver release];
+}
+
+- (void)testSolveWithMineCount
+{
+    // Once the only mine has been found, the squares that aren't next to
+    // any number must be safe.
+    static const char* const AllFound[] = {"1----"};
+    static const char* const AllFoundExpected[] = {"1*..."};
+    JbMinefieldSolver* solver = MakeSolver(AllFound, 1, 1);
+    STAssertTrue([solver solve], @"Nothing was deduced");
+    STAssertTrue(HasDeductions(solver, AllFoundExpected), @"Wrong deductions");
+    [solver release];
+
+    // When there are as many mines left as unknown squares, they all have
+    // mines.
+    static const char* const AllMines[] = {"0----"};
+    static const char* const AllMinesExpected[] = {"0.***"};
+    solver = MakeSolver(AllMines, 1, 3);
+    STAssertTrue([solver solve], @"Nothing was deduced");
+    STAssertTrue(HasDeductions(solver, AllMinesExpected), @"Wrong deductions");
+    [solver release];
+}
+
+- (void)testSolveWithoutDeductions
+{
+    // A 50/50 in the corner: either covered square may have the mine.
+    static const char* const Minefield[] = {"--",
+                                            "11"};
+    JbMinefieldSolver* solver = MakeSolver(Minefield, 2, 1);
+    STAssertFalse([solver solve], @"Something was deduced");
+    STAssertTrue(HasDeductions(solver, Minefield), @"Wrong deductions");
+    [solver release];
+}
+
+@end
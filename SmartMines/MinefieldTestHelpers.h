@@ -0,0 +1,57 @@
+//
+//  MinefieldTestHelpers.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "Minefield.h"
+
+@class JbMoveJournal;
+
+/// The size of the minefields made by JbMakeStartedMinefield.
+enum {JbExpertRows = 16, JbExpertColumns = 30, JbExpertMines = 99};
+
+/// Creates an expert minefield with the mines placed from @a seed and
+/// uncovers its middle square.
+/** If @a journal isn't nil, it records the game from the first move. The
+    caller must release the minefield.
+*/
+JbMinefield* JbMakeStartedMinefield(uint64_t seed, JbMoveJournal* journal);
+
+/// True if one of the neighbors of the square at @a idx is uncovered.
+BOOL JbIsNextToUncoveredSquare(JbMinefield* minefield, JbTableIndex idx);
+
+/// Finds a covered, unmarked square next to an uncovered one, with a mine
+/// if @a hasMine is YES and without one otherwise.
+/** @return the index just past the last square if there is none.
+*/
+JbTableIndex JbFindFrontierSquare(JbMinefield* minefield, BOOL hasMine);
+
+/// True if the minefields have the same size, and the same mines and
+/// states in every square.
+BOOL JbHaveSameSquares(JbMinefield* a, JbMinefield* b);
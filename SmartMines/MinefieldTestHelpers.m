@@ -0,0 +1,95 @@
+//
+//  MinefieldTestHelpers.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MinefieldTestHelpers.h"
+#import "MoveJournal.h"
+
+JbMinefield* JbMakeStartedMinefield(uint64_t seed, JbMoveJournal* journal)
+{
+    JbTableSize size = JbMakeTableSize(JbExpertRows, JbExpertColumns);
+    JbMinefield* minefield = [[JbMinefield alloc] initWithSize:size
+                                                 numberOfMines:JbExpertMines];
+    [minefield setJournal:journal];
+    [minefield setSeed:seed];
+    [minefield uncoverAt:JbMakeTableIndex(JbExpertRows / 2, JbExpertColumns / 2)
+         affectedSquares:nil];
+    return minefield;
+}
+
+BOOL JbIsNextToUncoveredSquare(JbMinefield* minefield, JbTableIndex idx)
+{
+    JbTableSize size = [minefield size];
+    unsigned endRow = MIN(idx.row + 2, size.rows);
+    unsigned endCol = MIN(idx.column + 2, size.columns);
+    for (unsigned r = idx.row != 0 ? idx.row - 1 : 0; r != endRow; ++r)
+    {
+        for (unsigned c = idx.column != 0 ? idx.column - 1 : 0; c != endCol; ++c)
+        {
+            if ((r != idx.row || c != idx.column)
+                && [minefield stateAt:JbMakeTableIndex(r, c)] == JbUncovered)
+                return YES;
+        }
+    }
+    return NO;
+}
+
+JbTableIndex JbFindFrontierSquare(JbMinefield* minefield, BOOL hasMine)
+{
+    JbTableSize size = [minefield size];
+    for (unsigned row = 0; row != size.rows; ++row)
+    {
+        for (unsigned col = 0; col != size.columns; ++col)
+        {
+            JbTableIndex idx = JbMakeTableIndex(row, col);
+            if ([minefield stateAt:idx] == JbUnmarked
+                && [minefield hasMineAt:idx] == hasMine
+                && JbIsNextToUncoveredSquare(minefield, idx))
+                return idx;
+        }
+    }
+    return JbMakeTableIndex(size.rows, size.columns);
+}
+
+BOOL JbHaveSameSquares(JbMinefield* a, JbMinefield* b)
+{
+    JbTableSize size = [a size];
+    if (!JbEqualTableSizes(size, [b size]))
+        return NO;
+    for (unsigned row = 0; row != size.rows; ++row)
+    {
+        for (unsigned col = 0; col != size.columns; ++col)
+        {
+            JbTableIndex idx = JbMakeTableIndex(row, col);
+            if ([a stateAt:idx] != [b stateAt:idx] || [a hasMineAt:idx] != [b hasMineAt:idx])
+                return NO;
+        }
+    }
+    return YES;
+}
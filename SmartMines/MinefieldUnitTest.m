@@ -0,0 +1,275 @@
+//
+//  MinefieldUnitTest.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MinefieldUnitTest.h"
+#import <SenTestingKit/SenTestCase.h>
+#import "Minefield.h"
+#import "MinefieldTestHelpers.h"
+#import "Random.h"
+
+/// Copies the states of all the squares of an expert minefield to
+/// @a states, row by row.
+static void GetSquareStates(JbMinefield* minefield, JbMinefieldSquareState* states)
+{
+    for (unsigned row = 0; row != JbExpertRows; ++row)
+    {
+        for (unsigned col = 0; col != JbExpertColumns; ++col)
+            states[row * JbExpertColumns + col] = [minefield stateAt:JbMakeTableIndex(row, col)];
+    }
+}
+
+/// True if the squares of an expert minefield have the states in @a states.
+static BOOL HasSquareStates(JbMinefield* minefield, const JbMinefieldSquareState* states)
+{
+    JbMinefieldSquareState current[JbExpertRows * JbExpertColumns];
+    GetSquareStates(minefield, current);
+    return memcmp(current, states, sizeof(current)) == 0;
+}
+
+/// Computes the openings and isolated numbers of @a minefield with a
+/// breadth-first search, as a reference for its metrics.
+static JbMinefieldMetrics ComputeReferenceMetrics(JbMinefield* minefield)
+{
+    JbTableSize size = [minefield size];
+    size_t squares = (size_t)size.rows * size.columns;
+    BOOL* isEmpty = calloc(squares, sizeof(BOOL));
+    BOOL* isVisited = calloc(squares, sizeof(BOOL));
+    size_t* queue = malloc(squares * sizeof(size_t));
+    NSCAssert(isEmpty != NULL && isVisited != NULL && queue != NULL,
+              @"Unable to allocate memory for the reference metrics");
+
+    for (size_t i = 0; i != squares; ++i)
+    {
+        unsigned row = (unsigned)(i / size.columns);
+        unsigned col = (unsigned)(i % size.columns);
+        isEmpty[i] = YES;
+        for (unsigned r = row != 0 ? row - 1 : 0; r != MIN(row + 2, size.rows); ++r)
+        {
+            for (unsigned c = col != 0 ? col - 1 : 0; c != MIN(col + 2, size.columns); ++c)
+            {
+                if ([minefield hasMineAt:JbMakeTableIndex(r, c)])
+                    isEmpty[i] = NO;
+            }
+        }
+    }
+
+    JbMinefieldMetrics metrics;
+    memset(&metrics, 0, sizeof(metrics));
+    for (size_t i = 0; i != squares; ++i)
+    {
+        unsigned row = (unsigned)(i / size.columns);
+        unsigned col = (unsigned)(i % size.columns);
+        if ([minefield hasMineAt:JbMakeTableIndex(row, col)])
+            continue;
+        BOOL hasEmptyNeighbor = NO;
+        for (unsigned r = row != 0 ? row - 1 : 0; r != MIN(row + 2, size.rows); ++r)
+        {
+            for (unsigned c = col != 0 ? col - 1 : 0; c != MIN(col + 2, size.columns); ++c)
+            {
+                if (isEmpty[(size_t)r * size.columns + c])
+                    hasEmptyNeighbor = YES;
+            }
+        }
+        if (!hasEmptyNeighbor)
+            ++metrics.isolatedNumbers;
+        if (!isEmpty[i] || isVisited[i])
+            continue;
+
+        ++metrics.openings;
+        size_t queueSize = 0;
+        queue[queueSize++] = i;
+        isVisited[i] = YES;
+        for (size_t k = 0; k != queueSize; ++k)
+        {
+            unsigned qRow = (unsigned)(queue[k] / size.columns);
+            unsigned qCol = (unsigned)(queue[k] % size.columns);
+            for (unsigned r = qRow != 0 ? qRow - 1 : 0; r != MIN(qRow + 2, size.rows); ++r)
+            {
+                for (unsigned c = qCol != 0 ? qCol - 1 : 0; c != MIN(qCol + 2, size.columns); ++c)
+                {
+                    size_t n = (size_t)r * size.columns + c;
+                    if (isEmpty[n] && !isVisited[n])
+                    {
+                        isVisited[n] = YES;
+                        queue[queueSize++] = n;
+                    }
+                }
+            }
+        }
+    }
+    metrics.bbbv = metrics.openings + metrics.isolatedNumbers;
+
+    free(queue);
+    free(isVisited);
+    free(isEmpty);
+    return metrics;
+}
+
+@implementation JbMinefieldUnitTest
+
+- (void)testMineProbabilitiesOfNextGame
+{
+    JbMinefield* reused = JbMakeStartedMinefield(1, nil);
+    [reused mineProbabilities];
+    [reused clear];
+    [reused setSeed:2];
+    [reused uncoverAt:JbMakeTableIndex(8, 15) affectedSquares:nil];
+    JbMinefield* fresh = JbMakeStartedMinefield(2, nil);
+
+    const double* expected = [fresh mineProbabilities];
+    const double* actual = [reused mineProbabilities];
+    for (unsigned i = 0; i != JbExpertRows * JbExpertColumns; ++i)
+    {
+        STAssertEqualsWithAccuracy(actual[i], expected[i], 1e-9,
+                                   @"Wrong probability at square %u", i);
+    }
+    [reused release];
+    [fresh release];
+}
+
+- (void)testMetricsOfRandomMinefields
+{
+    JbRandom random;
+    JbSeedRandom(&random, 3);
+    for (unsigned i = 0; i != 3000; ++i)
+    {
+        // Up to three words per row, to cover openings that cross words.
+        unsigned rows = 1 + (unsigned)JbRandomBelow(&random, 40);
+        unsigned columns = 1 + (unsigned)JbRandomBelow(&random, 150);
+        unsigned mines = (unsigned)JbRandomBelow(&random, rows * columns * 3 / 10 + 1);
+        // The first square must be left without a mine.
+        if (mines + 1 >= rows * columns)
+            continue;
+        JbMinefield* minefield = [[JbMinefield alloc] initWithSize:JbMakeTableSize(rows, columns)
+                                                     numberOfMines:mines];
+        [minefield setUsesEasyStart:NO];
+        [minefield setSeed:JbNextRandom(&random)];
+        [minefield placeMinesAroundSquare:JbMakeTableIndex(rows / 2, columns / 2)];
+
+        JbMinefieldMetrics expected = ComputeReferenceMetrics(minefield);
+        JbMinefieldMetrics actual = [minefield metrics];
+        STAssertEquals(actual.openings, expected.openings,
+                       @"Wrong number of openings on minefield %u", i);
+        STAssertEquals(actual.isolatedNumbers, expected.isolatedNumbers,
+                       @"Wrong number of isolated numbers on minefield %u", i);
+        STAssertEquals(actual.bbbv, expected.bbbv,
+                       @"Wrong 3BV on minefield %u", i);
+        STAssertTrue(actual.zini <= actual.bbbv,
+                     @"ZiNi is more than the 3BV on minefield %u", i);
+        [minefield release];
+    }
+}
+
+
+- (void)testRollBackRestoresSquares
+{
+    JbMinefield* minefield = JbMakeStartedMinefield(4, nil);
+    JbMinefieldSquareState states[JbExpertRows * JbExpertColumns];
+    GetSquareStates(minefield, states);
+    unsigned covered = [minefield numberOfCoveredSquares];
+
+    [minefield pushCheckpoint];
+    [minefield markAt:JbFindFrontierSquare(minefield, YES) affectedSquares:nil];
+    [minefield uncoverAt:JbFindFrontierSquare(minefield, NO) affectedSquares:nil];
+    STAssertTrue([minefield numberOfCoveredSquares] < covered, @"Nothing was uncovered");
+    [minefield rollBackWithAffectedSquares:nil];
+
+    STAssertTrue(HasSquareStates(minefield, states), @"The squares weren't rolled back");
+    STAssertEquals([minefield numberOfCoveredSquares], covered, nil);
+    STAssertEquals([minefield numberOfMarkedSquares], 0u, nil);
+    STAssertEquals([minefield numberOfCheckpoints], 0u, nil);
+    [minefield release];
+}
+
+- (void)testRollBackAfterBlowingUp
+{
+    JbMinefield* minefield = JbMakeStartedMinefield(5, nil);
+    JbMinefieldSquareState states[JbExpertRows * JbExpertColumns];
+    GetSquareStates(minefield, states);
+
+    [minefield pushCheckpoint];
+    [minefield uncoverAt:JbFindFrontierSquare(minefield, YES) affectedSquares:nil];
+    STAssertTrue([minefield state] == JbBlownUp, @"Uncovering a mine didn't lose the game");
+    [minefield rollBackWithAffectedSquares:nil];
+
+    STAssertTrue([minefield state] == JbNotCompleted, @"The game's state wasn't rolled back");
+    STAssertTrue(HasSquareStates(minefield, states), @"The squares weren't rolled back");
+    [minefield release];
+}
+
+- (void)testNestedCheckpoints
+{
+    JbMinefield* minefield = JbMakeStartedMinefield(6, nil);
+    JbMinefieldSquareState outerStates[JbExpertRows * JbExpertColumns];
+    JbMinefieldSquareState innerStates[JbExpertRows * JbExpertColumns];
+    GetSquareStates(minefield, outerStates);
+
+    [minefield pushCheckpoint];
+    [minefield markAt:JbFindFrontierSquare(minefield, YES) affectedSquares:nil];
+    GetSquareStates(minefield, innerStates);
+    [minefield pushCheckpoint];
+    [minefield uncoverAt:JbFindFrontierSquare(minefield, NO) affectedSquares:nil];
+    [minefield rollBackWithAffectedSquares:nil];
+    STAssertTrue(HasSquareStates(minefield, innerStates),
+                 @"The inner checkpoint wasn't rolled back");
+    STAssertEquals([minefield numberOfCheckpoints], 1u, nil);
+
+    // The moves that popCheckpoint keeps are undone by the outer rollback.
+    [minefield pushCheckpoint];
+    [minefield uncoverAt:JbFindFrontierSquare(minefield, NO) affectedSquares:nil];
+    [minefield popCheckpoint];
+    STAssertFalse(HasSquareStates(minefield, innerStates), @"popCheckpoint undid the moves");
+    [minefield rollBackWithAffectedSquares:nil];
+    STAssertTrue(HasSquareStates(minefield, outerStates),
+                 @"The outer checkpoint wasn't rolled back");
+    STAssertEquals([minefield numberOfCheckpoints], 0u, nil);
+    [minefield release];
+}
+
+- (void)testRollBackRestoresQuestionMarks
+{
+    JbMinefield* minefield = JbMakeStartedMinefield(7, nil);
+    [minefield setUsesQuestionMarks:YES affectedSquares:nil];
+    JbTableIndex idx = JbFindFrontierSquare(minefield, YES);
+    [minefield markAt:idx affectedSquares:nil];
+    [minefield markAt:idx affectedSquares:nil];
+    STAssertTrue([minefield stateAt:idx] == JbQuestionMarked, @"The square isn't question-marked");
+
+    [minefield pushCheckpoint];
+    [minefield setUsesQuestionMarks:NO affectedSquares:nil];
+    STAssertTrue([minefield stateAt:idx] == JbUnmarked, @"The question mark wasn't removed");
+    [minefield rollBackWithAffectedSquares:nil];
+
+    STAssertTrue([minefield usesQuestionMarks], @"The setting wasn't rolled back");
+    STAssertTrue([minefield stateAt:idx] == JbQuestionMarked, @"The square isn't question-marked");
+    [minefield release];
+}
+
+@end
@@ -29,6 +29,7 @@
 //  OTHER DEALINGS IN THE SOFTWARE.
 
 #import <Cocoa/Cocoa.h>
+#import "BitTable.h"
 #import "Table.h"
 
 typedef struct JbSquareStruct JbSquare;
@@ -74,6 +75,15 @@ typedef enum
     JbOutsideMinefieldCancels
 } JbCancelMode;
 
+/// Draws a minefield and passes the mouse and keyboard events on to its
+/// delegate.
+/** When the squares are smaller than a few pixels, the view switches to a
+    low level of detail: the minefield is drawn as a bitmap with one pixel
+    per square, colored by the square's state, and scaled to fill the view.
+    The bitmap is kept up to date as the squares change, so each change
+    costs a pixel, and drawing costs one scaled blit no matter how many
+    squares there are.
+*/
 @interface JbMinefieldView : NSView
 {
 @private
@@ -93,9 +103,15 @@ typedef enum
     NSImageRep* mDefeatImage;
     NSImageRep* mVictoryImage;
     NSColor* mErrorColor;
+    NSImage* mSprites;
+    float mSpriteSquareSize;
+    NSBitmapImageRep* mOverview;
     BOOL mUsesContentResizeIncrement;
     JbCancelMode mCancelMode;
     BOOL mIsEnabled;
+    unsigned mUpdateDepth;
+    JbBitTable mDirtyTiles;
+    BOOL mHasDirtyTiles;
 }
 + (float)squareSizeForViewSize:(NSSize)viewSize
                  minefieldSize:(JbTableSize)minefieldSize;
@@ -114,6 +130,17 @@ typedef enum
 - (BOOL)isLoweredAtIndex:(JbTableIndex)index;
 - (void)setLowered:(BOOL)newLoweredAtIndex atIndex:(JbTableIndex)index;
 
+/// Starts a batch of changes to the squares.
+/** Until the matching endUpdates, setLowered:atIndex: and
+    setSymbol:atIndex: only mark the tile of 8 x 8 squares they are in as
+    dirty, instead of each invalidating its own square. Batches can be
+    nested.
+*/
+- (void)beginUpdates;
+/// Ends a batch of changes, and invalidates the dirty tiles, joining the
+/// dirty tiles that are next to each other in a row into one rectangle.
+- (void)endUpdates;
+
 - (JbMinefieldSymbol)symbolAtIndex:(JbTableIndex)index;
 - (void)setSymbol:(JbMinefieldSymbol)symbol atIndex:(JbTableIndex)index;
 
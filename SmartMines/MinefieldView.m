@@ -28,6 +28,8 @@
 //  OTHER DEALINGS IN THE SOFTWARE.
 
 #import "MinefieldView.h"
+#import <string.h>
+#import "BoardRenderer.h"
 
 struct JbSquareStruct
 {
@@ -35,7 +37,13 @@ struct JbSquareStruct
     JbMinefieldSymbol symbol;
 };
 
+enum {TileSize = 8};
+enum {NumberOfSymbols = JbMinefieldIncorrectQuestionMark + 1};
+/// Squares smaller than this are drawn as one pixel each.
+enum {LowDetailSquareSize = 6};
+
 static void InitializeSquares(JbSquare* squares, size_t count);
+static void GetOverviewColor(const JbSquare* square, unsigned char rgba[4]);
 static NSArray* StringTuple(NSString* str, NSColor* color);
 static NSImageRep* GetImage(NSString* name);
 static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
@@ -48,9 +56,7 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
 + (float)squareSizeForViewSize:(NSSize)viewSize
                  minefieldSize:(JbTableSize)minefieldSize
 {
-    float maxSquareHeight = viewSize.height / minefieldSize.rows;
-    float maxSquareWidth = viewSize.width / minefieldSize.columns;
-    return floor(MIN(maxSquareHeight, maxSquareWidth));
+    return JbSquareSizeForViewSize(viewSize, minefieldSize);
 }
 
 - (id)initWithFrame:(NSRect)frame
@@ -79,7 +85,13 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
         mDefeatImage = GetImage(@"SadMine");
         mVictoryImage = GetImage(@"HappyMine");
         mErrorColor = [[NSColor colorWithDeviceRed:1.0 green:0 blue:0 alpha:0.25] retain];
+        mSprites = nil;
+        mSpriteSquareSize = 0;
+        mOverview = nil;
         mSquares = NULL;
+        mUpdateDepth = 0;
+        memset(&mDirtyTiles, 0, sizeof(mDirtyTiles));
+        mHasDirtyTiles = NO;
         mUsesContentResizeIncrement = YES;
         mMinefieldSize = JbMakeTableSize(0, 0);
         [self setMinefieldSize:JbMakeTableSize(1, 1)];
@@ -94,6 +106,9 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
 {
     if (mSquares != NULL)
         free(mSquares);
+    JbFreeBitTable(&mDirtyTiles);
+    [mSprites release];
+    [mOverview release];
     [mFlagImage dealloc];
     [mMineImage dealloc];
     [mTransparentMineImage dealloc];
@@ -115,6 +130,8 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
         NSMutableDictionary* attrs = [tuple objectAtIndex:1];
         [attrs setObject:newFont forKey:NSFontAttributeName];
     }
+    [mSprites release];
+    mSprites = nil;
     [self setNeedsDisplay:YES];
 }
 
@@ -131,7 +148,16 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
             free(mSquares);
         mMinefieldSize = newMinefieldSize;
         mSquares =  (JbSquare**)JbAllocTable(mMinefieldSize.rows, mMinefieldSize.columns, sizeof(JbSquare));
+        JbFreeBitTable(&mDirtyTiles);
+        BOOL success = JbInitBitTable(&mDirtyTiles,
+                                      (mMinefieldSize.rows + TileSize - 1) / TileSize,
+                                      (mMinefieldSize.columns + TileSize - 1) / TileSize);
+        NSAssert(success, @"Unable to allocate memory for the dirty tiles");
     }
+    JbFillBitTable(&mDirtyTiles, NO);
+    mHasDirtyTiles = NO;
+    [mOverview release];
+    mOverview = nil;
     
     InitializeSquares(&mSquares[0][0], mMinefieldSize.rows * mMinefieldSize.columns);
 
@@ -179,12 +205,14 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
          horizontalOffset:(float*)horOffset
            verticalOffset:(float*)verOffset
 {
-    size_t rows = mMinefieldSize.rows, cols = mMinefieldSize.columns;
-    NSRect bounds = [self bounds];
-    *squareSize = [JbMinefieldView squareSizeForViewSize:bounds.size
-                                           minefieldSize:mMinefieldSize];
-    *horOffset = floor((bounds.size.width - cols * *squareSize) / 2.0);
-    *verOffset = floor((bounds.size.height - rows * *squareSize) / 2.0);
+    // Whole pixels keep the detailed squares sharp, but below that size
+    // the bitmap may as well fill the view.
+    JbBoardLayout layout = JbMakeBoardLayout([self bounds].size,
+                                             mMinefieldSize,
+                                             LowDetailSquareSize);
+    *squareSize = layout.squareSize;
+    *horOffset = layout.horizontalOffset;
+    *verOffset = layout.verticalOffset;
 }
 
 - (JbTableIndex)minefieldIndexAtViewLocation:(NSPoint)location
@@ -193,6 +221,8 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
     [self computeSquareSize:&squareSize
            horizontalOffset:&horOffset
              verticalOffset:&verOffset];
+    if (squareSize <= 0)
+        return JbMakeTableIndex(UINT_MAX, UINT_MAX);
     return JbMakeTableIndex(floor((location.y - verOffset) / squareSize),
                             floor((location.x - horOffset) / squareSize));
 }
@@ -313,15 +343,7 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
                       squareSize:(float)squareSize
                   frameThickness:(float)thickness
 {
-    NSSize imgSize = [image size];
-    float imgMaxDim = MAX(imgSize.width, imgSize.height);
-    float imgSquareSize = squareSize - 2 * thickness;
-    imgSize = NSMakeSize(imgSquareSize * imgSize.width / imgMaxDim,
-                         imgSquareSize * imgSize.height / imgMaxDim);
-    return NSMakeRect((squareSize - imgSize.width) / 2,
-                      (squareSize - imgSize.height) / 2,
-                      imgSize.width,
-                      imgSize.height);
+    return JbFitImageInSquare([image size], squareSize, thickness);
 }
 
 - (void)drawSymbol:(JbMinefieldSymbol)symbol inRect:(NSRect)rect
@@ -411,13 +433,98 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
     [image drawInRect:imgRect];
 }
 
-- (void)drawRect:(NSRect)rect
+/// Draws every combination of frame and symbol into mSprites.
+/** The atlas has a row of raised squares and a row of lowered squares,
+    each with a column per symbol. It's only rebuilt when the square size
+    or the font changes, so a redraw copies one sprite per square instead
+    of stroking the frames and laying out the numbers.
+*/
+- (void)buildSpritesWithSquareSize:(float)squareSize
 {
-    float squareSize, horOffset, verOffset;
-    [self computeSquareSize:&squareSize
-           horizontalOffset:&horOffset
-             verticalOffset:&verOffset];
+    [mSprites release];
+    mSprites = [[NSImage alloc] initWithSize:NSMakeSize(squareSize * NumberOfSymbols,
+                                                        squareSize * 2)];
+    mSpriteSquareSize = squareSize;
+    float frameThickness = JbFrameThicknessForSquareSize(squareSize);
+    [mSprites lockFocus];
+    for (int lowered = 0; lowered != 2; ++lowered)
+    {
+        for (int symbol = 0; symbol != NumberOfSymbols; ++symbol)
+        {
+            NSRect squareRect = NSMakeRect(symbol * squareSize, lowered * squareSize,
+                                           squareSize, squareSize);
+            if (lowered)
+                [self drawLoweredFrameInRect:squareRect];
+            else
+                [self drawRaisedFrameInRect:squareRect thickness:frameThickness];
+            if (symbol != JbMinefieldEmpty)
+                [self drawSymbol:(JbMinefieldSymbol)symbol
+                          inRect:NSInsetRect(squareRect, frameThickness, frameThickness)];
+        }
+    }
+    [mSprites unlockFocus];
+}
+
+/// Sets the overview's pixel for the square at @a index.
+- (void)updateOverviewAtIndex:(JbTableIndex)index
+{
+    // The bitmap's first row is at the top, the minefield's at the bottom.
+    unsigned char* pixel = [mOverview bitmapData]
+                           + (mMinefieldSize.rows - 1 - index.row) * [mOverview bytesPerRow]
+                           + index.column * 4;
+    GetOverviewColor(&mSquares[index.row][index.column], pixel);
+}
 
+/// Creates the bitmap with one pixel per square that is drawn when the
+/// squares are too small to show any details.
+- (void)buildOverview
+{
+    [mOverview release];
+    mOverview = [[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL
+                                                        pixelsWide:mMinefieldSize.columns
+                                                        pixelsHigh:mMinefieldSize.rows
+                                                     bitsPerSample:8
+                                                   samplesPerPixel:4
+                                                          hasAlpha:YES
+                                                          isPlanar:NO
+                                                    colorSpaceName:NSDeviceRGBColorSpace
+                                                       bytesPerRow:mMinefieldSize.columns * 4
+                                                      bitsPerPixel:32];
+    NSAssert(mOverview != nil, @"Unable to allocate memory for the overview");
+    JbTableIterator it = JbMakeTableIterator(0, 0, mMinefieldSize.rows, mMinefieldSize.columns);
+    while (JbTableIteratorNext(&it))
+        [self updateOverviewAtIndex:it.index];
+}
+
+- (void)drawOverviewWithSquareSize:(float)squareSize
+                  horizontalOffset:(float)horOffset
+                    verticalOffset:(float)verOffset
+{
+    NSRect boardRect = NSMakeRect(horOffset, verOffset,
+                                  squareSize * mMinefieldSize.columns,
+                                  squareSize * mMinefieldSize.rows);
+    if (!mIsEnabled)
+    {
+        [[NSColor colorWithDeviceWhite:0.75 alpha:1.0] setFill];
+        NSRectFill(boardRect);
+        return;
+    }
+
+    if (mOverview == nil)
+        [self buildOverview];
+    NSGraphicsContext* context = [NSGraphicsContext currentContext];
+    NSImageInterpolation interpolation = [context imageInterpolation];
+    [context setImageInterpolation:NSImageInterpolationNone];
+    [mOverview drawInRect:boardRect];
+    [context setImageInterpolation:interpolation];
+}
+
+/// Draws the squares that intersect @a rect.
+- (void)drawSquaresInRect:(NSRect)rect
+                squareSize:(float)squareSize
+          horizontalOffset:(float)horOffset
+            verticalOffset:(float)verOffset
+{
     int row0 = floor((NSMinY(rect) - verOffset) / squareSize);
     int row1 = ceil((NSMaxY(rect) - verOffset) / squareSize);
     if (row0 < 0) row0 = 0;
@@ -427,52 +534,95 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
     int col1 = ceil((NSMaxX(rect) - horOffset) / squareSize);
     if (col0 < 0) col0 = 0;
     if (col1 > mMinefieldSize.columns) col1 = mMinefieldSize.columns;
+    if (row0 >= row1 || col0 >= col1)
+        return;
+
+    if (mSprites == nil || mSpriteSquareSize != squareSize)
+        [self buildSpritesWithSquareSize:squareSize];
 
     NSRect squareRect = NSMakeRect(horOffset + col0 * squareSize,
                                    verOffset + row0 * squareSize,
                                    squareSize, squareSize);
-    float frameThickness = ceil(squareSize / 25.0);
+    NSRect spriteRect = NSMakeRect(0, 0, squareSize, squareSize);
     for (unsigned row = row0; row != row1; ++row)
     {
         for (unsigned col = col0; col != col1; ++col)
         {
             JbSquare* square = &mSquares[row][col];
-            if (mIsEnabled && square->isLowered)
-                [self drawLoweredFrameInRect:squareRect];
-            else
-                [self drawRaisedFrameInRect:squareRect thickness:frameThickness];
-            if (mIsEnabled && square->symbol != JbMinefieldEmpty)
-                [self drawSymbol:square->symbol inRect:NSMakeRect(
-                                squareRect.origin.x + frameThickness,
-                                squareRect.origin.y + frameThickness,
-                                squareRect.size.width - 2 * frameThickness,
-                                squareRect.size.height - 2 * frameThickness)];
+            BOOL isLowered = mIsEnabled && square->isLowered;
+            JbMinefieldSymbol symbol = mIsEnabled ? square->symbol : JbMinefieldEmpty;
+            spriteRect.origin.x = symbol * squareSize;
+            spriteRect.origin.y = isLowered ? squareSize : 0;
+            [mSprites drawInRect:squareRect
+                        fromRect:spriteRect
+                       operation:NSCompositeSourceOver
+                        fraction:1.0];
             squareRect.origin.x += squareRect.size.width;
         }
         squareRect.origin.x = horOffset + col0 * squareSize;
         squareRect.origin.y += squareRect.size.height;
     }
+}
+
+- (void)drawRect:(NSRect)rect
+{
+    float squareSize, horOffset, verOffset;
+    [self computeSquareSize:&squareSize
+           horizontalOffset:&horOffset
+             verticalOffset:&verOffset];
+    if (squareSize <= 0)
+        return;
+
+    if (squareSize < LowDetailSquareSize)
+    {
+        [self drawOverviewWithSquareSize:squareSize
+                        horizontalOffset:horOffset
+                          verticalOffset:verOffset];
+    }
+    else
+    {
+        // After a batch of updates only the invalidated tiles need to be
+        // redrawn, not everything in their bounding rectangle.
+        const NSRect* rects;
+        NSInteger count;
+        [self getRectsBeingDrawn:&rects count:&count];
+        for (NSInteger i = 0; i != count; ++i)
+            [self drawSquaresInRect:rects[i]
+                         squareSize:squareSize
+                   horizontalOffset:horOffset
+                     verticalOffset:verOffset];
+    }
 
     NSImageRep* img = [self backgroundImage:mBackgroundImage];
     if (img)
         [self drawBackgroundImage:img];
-    
-    if (mSelectedSquare.row >= row0 && mSelectedSquare.row < row1 &&
-        mSelectedSquare.column >= col0 && mSelectedSquare.column < col1)
+
+    if (IsLessThanSize(mSelectedSquare, mMinefieldSize))
     {
-        squareRect.origin.x = horOffset + mSelectedSquare.column * squareSize + frameThickness;
-        squareRect.origin.y = verOffset + mSelectedSquare.row * squareSize + frameThickness;
-        squareRect.size.width -= 2 * frameThickness;
-        squareRect.size.height -= 2 * frameThickness;
-        [NSGraphicsContext saveGraphicsState];
-        NSSetFocusRingStyle(NSFocusRingOnly);
-        [[NSBezierPath bezierPathWithRect: NSInsetRect(squareRect,3,3)] fill];
-        [NSGraphicsContext restoreGraphicsState];
+        float frameThickness = JbFrameThicknessForSquareSize(squareSize);
+        NSRect squareRect = NSMakeRect(horOffset + mSelectedSquare.column * squareSize,
+                                       verOffset + mSelectedSquare.row * squareSize,
+                                       squareSize, squareSize);
+        if ([self needsToDrawRect:squareRect])
+        {
+            squareRect = NSInsetRect(squareRect, frameThickness, frameThickness);
+            [NSGraphicsContext saveGraphicsState];
+            NSSetFocusRingStyle(NSFocusRingOnly);
+            [[NSBezierPath bezierPathWithRect: NSInsetRect(squareRect,3,3)] fill];
+            [NSGraphicsContext restoreGraphicsState];
+        }
     }
 }
 
 - (void)setNeedsDisplayAtIndex:(JbTableIndex)index
 {
+    if (mUpdateDepth != 0)
+    {
+        JbSetBit(&mDirtyTiles, index.row / TileSize, index.column / TileSize);
+        mHasDirtyTiles = YES;
+        return;
+    }
+
     float squareSize, horOffset, verOffset;
     [self computeSquareSize:&squareSize
            horizontalOffset:&horOffset
@@ -482,6 +632,49 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
                                            squareSize, squareSize)];
 }
 
+- (void)beginUpdates
+{
+    ++mUpdateDepth;
+}
+
+- (void)endUpdates
+{
+    assert(mUpdateDepth != 0);
+    if (--mUpdateDepth != 0 || !mHasDirtyTiles)
+        return;
+
+    float squareSize, horOffset, verOffset;
+    [self computeSquareSize:&squareSize
+           horizontalOffset:&horOffset
+             verticalOffset:&verOffset];
+    float tileSize = squareSize * TileSize;
+    for (unsigned row = 0; row != mDirtyTiles.rows; ++row)
+    {
+        unsigned col = 0;
+        while (col != mDirtyTiles.columns)
+        {
+            if (!JbGetBit(&mDirtyTiles, row, col))
+            {
+                ++col;
+                continue;
+            }
+            unsigned colBegin = col;
+            while (col != mDirtyTiles.columns && JbGetBit(&mDirtyTiles, row, col))
+                ++col;
+            // The last tiles in a row or column may be partial, so the rect
+            // is clipped to the minefield.
+            unsigned squareRowEnd = MIN((row + 1) * TileSize, mMinefieldSize.rows);
+            unsigned squareColumnEnd = MIN(col * TileSize, mMinefieldSize.columns);
+            [self setNeedsDisplayInRect:NSMakeRect(horOffset + tileSize * colBegin,
+                                                   verOffset + tileSize * row,
+                                                   squareSize * (squareColumnEnd - colBegin * TileSize),
+                                                   squareSize * (squareRowEnd - row * TileSize))];
+        }
+    }
+    JbFillBitTable(&mDirtyTiles, NO);
+    mHasDirtyTiles = NO;
+}
+
 - (BOOL)isLoweredAtIndex:(JbTableIndex)index
 {
     NSAssert2(IsLessThanSize(index, mMinefieldSize), @"Row and/or column is out of range: %d, %d", index.row, index.column);
@@ -495,6 +688,8 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
         return;
     
     mSquares[index.row][index.column].isLowered = newLoweredAtIndex;
+    if (mOverview != nil)
+        [self updateOverviewAtIndex:index];
     [self setNeedsDisplayAtIndex:index];
 }
 
@@ -510,7 +705,11 @@ static inline BOOL IsLessThanSize(JbTableIndex index, JbTableSize size)
     assert(symbol >= JbMinefieldEmpty && symbol <= JbMinefieldIncorrectQuestionMark);
 
     JbSquare* square = &mSquares[index.row][index.column];
+    if (square->symbol == symbol)
+        return;
     square->symbol = symbol;
+    if (mOverview != nil)
+        [self updateOverviewAtIndex:index];
     
     [self setNeedsDisplayAtIndex:index];
 }
@@ -851,6 +1050,48 @@ static void InitializeSquares(JbSquare* squares, size_t count)
     }
 }
 
+/// The overview's color for @a square: gray when covered, pale when
+/// uncovered and darker the more mined neighbors it has, red for marks and
+/// explosions, black for mines that weren't found.
+static void GetOverviewColor(const JbSquare* square, unsigned char rgba[4])
+{
+    unsigned char r, g, b;
+    switch (square->symbol)
+    {
+    case JbMinefieldExplosion:
+    case JbMinefieldIncorrectMark:
+    case JbMinefieldIncorrectQuestionMark:
+        r = 255; g = 0; b = 0;
+        break;
+    case JbMinefieldMark:
+    case JbMinefieldMarkedMine:
+        r = 200; g = 40; b = 40;
+        break;
+    case JbMinefieldQuestionMark:
+    case JbMinefieldQuestionMarkedMine:
+        r = 220; g = 200; b = 40;
+        break;
+    case JbMinefieldUnmarkedMine:
+        r = g = b = 0;
+        break;
+    default:
+        if (square->isLowered)
+        {
+            r = g = (unsigned char)(240 - 20 * square->symbol);
+            b = 255;
+        }
+        else
+        {
+            r = g = b = 160;
+        }
+        break;
+    }
+    rgba[0] = r;
+    rgba[1] = g;
+    rgba[2] = b;
+    rgba[3] = 255;
+}
+
 static NSArray* StringTuple(NSString* str, NSColor* color)
 {
     NSMutableParagraphStyle* paragraphStyle = [[[NSMutableParagraphStyle alloc] init] autorelease];
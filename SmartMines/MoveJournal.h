@@ -0,0 +1,158 @@
+//
+//  MoveJournal.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "Minefield.h"
+
+@class JbStopwatch;
+
+typedef enum
+{
+    JbUncoverMove,
+    JbMarkMove,
+    /// A change of the smart uncover, smart mark or question mark settings
+    /// during the game.
+    JbSettingsMove
+} JbMoveKind;
+
+enum
+{
+    JbJournalUsesEasyStart = 1,
+    JbJournalUsesSmartUncover = 2,
+    JbJournalUsesSmartMark = 4,
+    JbJournalUsesQuestionMarks = 8
+};
+
+typedef struct JbJournalMoveStruct
+{
+    JbMoveKind kind;
+    /// The square of an uncover or mark move.
+    JbTableIndex index;
+    /// The JbJournalUses... flags of a settings move.
+    unsigned settings;
+    /// The time on the game's stopwatch when the move was made.
+    uint32_t milliseconds;
+} JbJournalMove;
+
+/// A record of every move in a game, from which the game can be replayed
+/// exactly.
+/** The journal stores the minefield's size, number of mines, seed,
+    placement square and settings when the mines are placed, which
+    determines the whole minefield, followed by the moves. A minefield
+    with a journal (see JbMinefield's setJournal:) records every
+    uncoverAt: and markAt: in it, with the time on the journal's
+    stopwatch.
+
+    The binary form (see data) is a short header followed by two varints
+    per move: the milliseconds since the previous move shifted left past
+    the move kind, and the square's index (row * columns + column) or the
+    settings. A typical move takes three or four bytes.
+
+    A replay uses a minefield that the caller provides, without a journal
+    or board pool, and only allocates memory when the minefield's size
+    changes, so thousands of journals can be verified per second.
+*/
+@interface JbMoveJournal : NSObject
+{
+    JbTableSize mSize;
+    unsigned mNumberOfMines;
+    uint64_t mSeed;
+    JbTableIndex mPlacementSquare;
+    unsigned mSettings;
+    BOOL mIsStarted;
+    JbJournalMove* mMoves;
+    size_t mNumberOfMoves;
+    size_t mCapacity;
+    JbStopwatch* mStopwatch;
+}
+
+/// Returns nil if @a data isn't a valid journal.
++ (JbMoveJournal*)journalWithData:(NSData*)data;
+- (id)init;
+- (id)initWithData:(NSData*)data;
+
+/// The stopwatch the moves' times are taken from. Without one every move
+/// gets time 0.
+- (JbStopwatch*)stopwatch;
+- (void)setStopwatch:(JbStopwatch*)stopwatch;
+
+/// Removes the moves and the minefield.
+- (void)clear;
+/// Starts a new game on @a minefield, whose mines have just been placed.
+- (void)startWithMinefield:(JbMinefield*)minefield;
+/// True if the journal has a minefield, i.e. startWithMinefield: has been
+/// called since it was cleared. Moves are ignored until then.
+- (BOOL)isStarted;
+
+- (void)recordMove:(JbMoveKind)kind atIndex:(JbTableIndex)index;
+- (void)recordSettingsOfMinefield:(JbMinefield*)minefield;
+/// Removes the moves after the first @a count, e.g. the ones a minefield
+/// has rolled back.
+- (void)removeMovesAfter:(size_t)count;
+
+- (JbTableSize)size;
+- (unsigned)numberOfMines;
+- (uint64_t)seed;
+- (JbTableIndex)placementSquare;
+- (size_t)numberOfMoves;
+- (const JbJournalMove*)moves;
+/// The time of the last move in seconds.
+- (double)seconds;
+
+/// The journal's binary form.
+- (NSData*)data;
+
+/// Gives @a minefield the journal's size, settings and mines, as they were
+/// after the first move's mines were placed.
+- (void)prepareMinefield:(JbMinefield*)minefield;
+/// Makes the moves from number @a first until the first move after
+/// @a seconds, unless the game ends before that.
+/** A viewer replays a game in real time by calling this with the time
+    that has passed since the replay started.
+    @return the number of the next move.
+*/
+- (size_t)replayMovesOnMinefield:(JbMinefield*)minefield
+                       fromIndex:(size_t)first
+                    untilSeconds:(double)seconds
+                 affectedSquares:(id<JbTableIndexCollector>)affectedSquares;
+/// Replays the whole game on @a minefield as fast as possible.
+/** @return the state of the minefield after the last move.
+*/
+- (JbMinefieldState)replayOnMinefield:(JbMinefield*)minefield;
+
+/// True if the game replays to a win on @a minefield, and its last move
+/// was made at @a elapsedTime, a whole number of seconds as given to
+/// JbHighScores.
+/** The minefield is reused for the replay, so a caller that verifies many
+    journals with the same minefield only allocates memory when the size
+    changes.
+*/
+- (BOOL)verifiesElapsedTime:(double)elapsedTime onMinefield:(JbMinefield*)minefield;
+@end
@@ -0,0 +1,389 @@
+//
+//  MoveJournal.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MoveJournal.h"
+#import <assert.h>
+#import <math.h>
+#import <stdlib.h>
+#import <string.h>
+#import "Stopwatch.h"
+
+static const uint8_t JournalMagic[4] = {'J', 'b', 'M', 'J'};
+enum {JournalVersion = 1};
+
+/// The largest number of rows or columns a journal is accepted with, the
+/// same as the largest custom game JbGame allows.
+enum {MaximumRowsOrColumns = 2000};
+
+static void AppendVarint(NSMutableData* data, uint64_t value)
+{
+    uint8_t bytes[10];
+    unsigned count = 0;
+    do
+    {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        bytes[count++] = byte | (value != 0 ? 0x80 : 0);
+    } while (value != 0);
+    [data appendBytes:bytes length:count];
+}
+
+static BOOL ReadVarint(const uint8_t** it, const uint8_t* end, uint64_t* value)
+{
+    uint64_t result = 0;
+    for (unsigned shift = 0; *it != end && shift < 64; shift += 7)
+    {
+        uint8_t byte = *(*it)++;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            *value = result;
+            return YES;
+        }
+    }
+    return NO;
+}
+
+static unsigned GetSettings(JbMinefield* minefield)
+{
+    return ([minefield usesEasyStart] ? JbJournalUsesEasyStart : 0)
+           | ([minefield usesSmartUncover] ? JbJournalUsesSmartUncover : 0)
+           | ([minefield usesSmartMark] ? JbJournalUsesSmartMark : 0)
+           | ([minefield usesQuestionMarks] ? JbJournalUsesQuestionMarks : 0);
+}
+
+static void ApplySettings(JbMinefield* minefield,
+                          unsigned settings,
+                          id<JbTableIndexCollector> affectedSquares)
+{
+    [minefield setUsesSmartUncover:(settings & JbJournalUsesSmartUncover) != 0];
+    [minefield setUsesSmartMark:(settings & JbJournalUsesSmartMark) != 0];
+    [minefield setUsesQuestionMarks:(settings & JbJournalUsesQuestionMarks) != 0
+                    affectedSquares:affectedSquares];
+}
+
+@implementation JbMoveJournal
+
++ (JbMoveJournal*)journalWithData:(NSData*)data
+{
+    return [[[JbMoveJournal alloc] initWithData:data] autorelease];
+}
+
+- (id)init
+{
+    self = [super init];
+    if (self)
+    {
+        mSize = JbMakeTableSize(0, 0);
+        mNumberOfMines = 0;
+        mSeed = 0;
+        mPlacementSquare = JbMakeTableIndex(0, 0);
+        mSettings = 0;
+        mIsStarted = NO;
+        mMoves = NULL;
+        mNumberOfMoves = 0;
+        mCapacity = 0;
+        mStopwatch = nil;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(mMoves);
+    [mStopwatch release];
+    [super dealloc];
+}
+
+- (void)reserveMoves:(size_t)count
+{
+    if (count <= mCapacity)
+        return;
+    size_t newCapacity = MAX(count, mCapacity == 0 ? 64 : mCapacity * 2);
+    JbJournalMove* newMoves = realloc(mMoves, newCapacity * sizeof(JbJournalMove));
+    NSAssert(newMoves != NULL, @"Unable to allocate memory for the journal");
+    mMoves = newMoves;
+    mCapacity = newCapacity;
+}
+
+- (id)initWithData:(NSData*)data
+{
+    self = [self init];
+    if (self)
+    {
+        const uint8_t* it = (const uint8_t*)[data bytes];
+        const uint8_t* end = it + [data length];
+        uint64_t rows, columns, mines, row, column, seed, count;
+        if (end - it < 6 || memcmp(it, JournalMagic, 4) != 0
+            || it[4] != JournalVersion || it[5] > 15)
+        {
+            [self release];
+            return nil;
+        }
+        mSettings = it[5];
+        it += 6;
+        if (!ReadVarint(&it, end, &rows) || !ReadVarint(&it, end, &columns)
+            || !ReadVarint(&it, end, &mines) || !ReadVarint(&it, end, &row)
+            || !ReadVarint(&it, end, &column) || !ReadVarint(&it, end, &seed)
+            || !ReadVarint(&it, end, &count)
+            || rows == 0 || rows > MaximumRowsOrColumns
+            || columns == 0 || columns > MaximumRowsOrColumns
+            || mines >= rows * columns
+            || mines + ((mSettings & JbJournalUsesEasyStart) ? 9 : 1) >= rows * columns
+            || row >= rows || column >= columns
+            || count > (uint64_t)(end - it) / 2)
+        {
+            [self release];
+            return nil;
+        }
+        mSize = JbMakeTableSize((unsigned)rows, (unsigned)columns);
+        mNumberOfMines = (unsigned)mines;
+        mSeed = seed;
+        mPlacementSquare = JbMakeTableIndex((unsigned)row, (unsigned)column);
+        mIsStarted = YES;
+
+        [self reserveMoves:(size_t)count];
+        uint64_t milliseconds = 0;
+        for (; mNumberOfMoves != count; ++mNumberOfMoves)
+        {
+            uint64_t code, value;
+            if (!ReadVarint(&it, end, &code) || !ReadVarint(&it, end, &value)
+                || (code & 3) > JbSettingsMove
+                || ((code & 3) == JbSettingsMove ? value > 15 : value >= rows * columns))
+            {
+                [self release];
+                return nil;
+            }
+            milliseconds = MIN(milliseconds + (code >> 2), (uint64_t)UINT32_MAX);
+            JbJournalMove* move = &mMoves[mNumberOfMoves];
+            move->kind = (JbMoveKind)(code & 3);
+            move->index = move->kind == JbSettingsMove
+                          ? JbMakeTableIndex(0, 0)
+                          : JbMakeTableIndex((unsigned)(value / columns),
+                                             (unsigned)(value % columns));
+            move->settings = move->kind == JbSettingsMove ? (unsigned)value : 0;
+            move->milliseconds = (uint32_t)milliseconds;
+        }
+    }
+    return self;
+}
+
+- (JbStopwatch*)stopwatch
+{
+    return mStopwatch;
+}
+
+- (void)setStopwatch:(JbStopwatch*)stopwatch
+{
+    [stopwatch retain];
+    [mStopwatch release];
+    mStopwatch = stopwatch;
+}
+
+- (void)clear
+{
+    mIsStarted = NO;
+    mNumberOfMoves = 0;
+}
+
+- (void)startWithMinefield:(JbMinefield*)minefield
+{
+    mSize = [minefield size];
+    mNumberOfMines = [minefield numberOfMines];
+    mSeed = [minefield seed];
+    mPlacementSquare = [minefield placementSquare];
+    mSettings = GetSettings(minefield);
+    mNumberOfMoves = 0;
+    mIsStarted = YES;
+}
+
+- (BOOL)isStarted
+{
+    return mIsStarted;
+}
+
+/// Appends a move at the current time, never earlier than the previous one.
+- (JbJournalMove*)addMove:(JbMoveKind)kind
+{
+    [self reserveMoves:mNumberOfMoves + 1];
+    double milliseconds = mStopwatch != nil ? floor([mStopwatch seconds] * 1000) : 0;
+    uint32_t previous = mNumberOfMoves != 0 ? mMoves[mNumberOfMoves - 1].milliseconds : 0;
+    JbJournalMove* move = &mMoves[mNumberOfMoves++];
+    move->kind = kind;
+    move->index = JbMakeTableIndex(0, 0);
+    move->settings = 0;
+    move->milliseconds = (uint32_t)MAX(MIN(milliseconds, (double)UINT32_MAX), (double)previous);
+    return move;
+}
+
+- (void)recordMove:(JbMoveKind)kind atIndex:(JbTableIndex)index
+{
+    assert(kind != JbSettingsMove);
+    if (mIsStarted)
+        [self addMove:kind]->index = index;
+}
+
+- (void)recordSettingsOfMinefield:(JbMinefield*)minefield
+{
+    if (mIsStarted)
+        [self addMove:JbSettingsMove]->settings = GetSettings(minefield);
+}
+
+- (void)removeMovesAfter:(size_t)count
+{
+    if (count < mNumberOfMoves)
+        mNumberOfMoves = count;
+}
+
+- (JbTableSize)size
+{
+    return mSize;
+}
+
+- (unsigned)numberOfMines
+{
+    return mNumberOfMines;
+}
+
+- (uint64_t)seed
+{
+    return mSeed;
+}
+
+- (JbTableIndex)placementSquare
+{
+    return mPlacementSquare;
+}
+
+- (size_t)numberOfMoves
+{
+    return mNumberOfMoves;
+}
+
+- (const JbJournalMove*)moves
+{
+    return mMoves;
+}
+
+- (double)seconds
+{
+    return mNumberOfMoves != 0 ? mMoves[mNumberOfMoves - 1].milliseconds / 1000.0 : 0;
+}
+
+- (NSData*)data
+{
+    assert(mIsStarted);
+    NSMutableData* data = [NSMutableData dataWithCapacity:32 + 4 * mNumberOfMoves];
+    [data appendBytes:JournalMagic length:4];
+    uint8_t versionAndSettings[2] = {JournalVersion, (uint8_t)mSettings};
+    [data appendBytes:versionAndSettings length:2];
+    AppendVarint(data, mSize.rows);
+    AppendVarint(data, mSize.columns);
+    AppendVarint(data, mNumberOfMines);
+    AppendVarint(data, mPlacementSquare.row);
+    AppendVarint(data, mPlacementSquare.column);
+    AppendVarint(data, mSeed);
+    AppendVarint(data, mNumberOfMoves);
+    uint32_t previous = 0;
+    for (size_t i = 0; i != mNumberOfMoves; ++i)
+    {
+        const JbJournalMove* move = &mMoves[i];
+        AppendVarint(data, ((uint64_t)(move->milliseconds - previous) << 2) | move->kind);
+        if (move->kind == JbSettingsMove)
+            AppendVarint(data, move->settings);
+        else
+            AppendVarint(data, (uint64_t)move->index.row * mSize.columns + move->index.column);
+        previous = move->milliseconds;
+    }
+    return data;
+}
+
+- (void)prepareMinefield:(JbMinefield*)minefield
+{
+    assert(mIsStarted);
+    [minefield setSize:mSize numberOfMines:mNumberOfMines];
+    [minefield setUsesEasyStart:(mSettings & JbJournalUsesEasyStart) != 0];
+    ApplySettings(minefield, mSettings, nil);
+    [minefield setSeed:mSeed];
+    [minefield placeMinesAroundSquare:mPlacementSquare];
+}
+
+- (size_t)replayMovesOnMinefield:(JbMinefield*)minefield
+                       fromIndex:(size_t)first
+                    untilSeconds:(double)seconds
+                 affectedSquares:(id<JbTableIndexCollector>)affectedSquares
+{
+    double limit = floor(seconds * 1000);
+    size_t i = first;
+    for (; i < mNumberOfMoves && mMoves[i].milliseconds <= limit; ++i)
+    {
+        JbMinefieldState state = [minefield state];
+        if (state == JbCompleted || state == JbBlownUp)
+            return mNumberOfMoves;
+
+        const JbJournalMove* move = &mMoves[i];
+        switch (move->kind)
+        {
+        case JbUncoverMove:
+            [minefield uncoverAt:move->index affectedSquares:affectedSquares];
+            break;
+        case JbMarkMove:
+            [minefield markAt:move->index affectedSquares:affectedSquares];
+            break;
+        case JbSettingsMove:
+            ApplySettings(minefield, move->settings, affectedSquares);
+            break;
+        }
+    }
+    return i;
+}
+
+- (JbMinefieldState)replayOnMinefield:(JbMinefield*)minefield
+{
+    [self prepareMinefield:minefield];
+    [self replayMovesOnMinefield:minefield
+                       fromIndex:0
+                    untilSeconds:UINT32_MAX
+                 affectedSquares:nil];
+    return [minefield state];
+}
+
+- (BOOL)verifiesElapsedTime:(double)elapsedTime onMinefield:(JbMinefield*)minefield
+{
+    if (!mIsStarted)
+        return NO;
+    BOOL isWon = [self replayOnMinefield:minefield] == JbCompleted;
+    // The time is truncated to whole seconds when the game is won, just
+    // after the last move.
+    double seconds = floor([self seconds]);
+    return isWon && elapsedTime >= seconds && elapsedTime <= seconds + 1;
+}
+
+@end
@@ -0,0 +1,186 @@
+//
+//  MoveJournalUnitTest.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "MoveJournalUnitTest.h"
+#import <SenTestingKit/SenTestCase.h>
+#import "MinefieldTestHelpers.h"
+#import "MoveJournal.h"
+
+/// Plays a game on an expert minefield with a journal: uncovers the middle
+/// square, marks the mines in the first @a rowsWithMarks rows that are
+/// next to an uncovered square, and uncovers every square without a mine.
+static JbMoveJournal* MakeWonJournal(uint64_t seed, unsigned rowsWithMarks)
+{
+    JbMoveJournal* journal = [[[JbMoveJournal alloc] init] autorelease];
+    JbMinefield* minefield = JbMakeStartedMinefield(seed, journal);
+    [minefield setUsesQuestionMarks:YES affectedSquares:nil];
+    for (unsigned row = 0; row != rowsWithMarks; ++row)
+    {
+        for (unsigned col = 0; col != JbExpertColumns; ++col)
+        {
+            JbTableIndex idx = JbMakeTableIndex(row, col);
+            if ([minefield hasMineAt:idx] && JbIsNextToUncoveredSquare(minefield, idx))
+                [minefield markAt:idx affectedSquares:nil];
+        }
+    }
+    for (unsigned row = 0; row != JbExpertRows; ++row)
+    {
+        for (unsigned col = 0; col != JbExpertColumns; ++col)
+        {
+            JbTableIndex idx = JbMakeTableIndex(row, col);
+            if (![minefield hasMineAt:idx] && [minefield stateAt:idx] != JbUncovered)
+                [minefield uncoverAt:idx affectedSquares:nil];
+        }
+    }
+    NSCAssert([minefield state] == JbCompleted, @"The game wasn't won");
+    [minefield setJournal:nil];
+    [minefield release];
+    return journal;
+}
+
+static void AppendVarint(NSMutableData* data, uint64_t value)
+{
+    do
+    {
+        uint8_t byte = (uint8_t)((value & 0x7F) | (value >= 0x80 ? 0x80 : 0));
+        [data appendBytes:&byte length:1];
+        value >>= 7;
+    } while (value != 0);
+}
+
+/// Returns a journal's binary form with the given header fields and no
+/// moves, but room for @a count moves of two bytes.
+static NSData* MakeJournalData(uint64_t rows, uint64_t columns, uint64_t mines,
+                               uint64_t count)
+{
+    static const uint8_t Header[6] = {'J', 'b', 'M', 'J', 1, JbJournalUsesEasyStart};
+    NSMutableData* data = [NSMutableData dataWithBytes:Header length:sizeof(Header)];
+    AppendVarint(data, rows);
+    AppendVarint(data, columns);
+    AppendVarint(data, mines);
+    AppendVarint(data, 0);
+    AppendVarint(data, 0);
+    AppendVarint(data, 1234);
+    AppendVarint(data, count);
+    for (uint64_t i = 0; i != count && i != 16; ++i)
+    {
+        AppendVarint(data, JbUncoverMove);
+        AppendVarint(data, i);
+    }
+    return data;
+}
+
+@implementation JbMoveJournalUnitTest
+
+- (void)testDataRoundTrip
+{
+    JbMoveJournal* journal = MakeWonJournal(1, 4);
+    NSData* data = [journal data];
+    JbMoveJournal* copy = [JbMoveJournal journalWithData:data];
+    STAssertNotNil(copy, @"The journal's data wasn't read");
+    STAssertTrue(JbEqualTableSizes([copy size], [journal size]), @"Wrong size");
+    STAssertEquals([copy numberOfMines], [journal numberOfMines], nil);
+    STAssertEquals([copy seed], [journal seed], nil);
+    STAssertTrue(JbEqualTableIndexes([copy placementSquare], [journal placementSquare]),
+                 @"Wrong placement square");
+    STAssertEquals([copy numberOfMoves], [journal numberOfMoves], nil);
+    for (size_t i = 0; i != [journal numberOfMoves]; ++i)
+    {
+        const JbJournalMove* expected = [journal moves] + i;
+        const JbJournalMove* actual = [copy moves] + i;
+        STAssertTrue(actual->kind == expected->kind
+                     && JbEqualTableIndexes(actual->index, expected->index)
+                     && actual->settings == expected->settings
+                     && actual->milliseconds == expected->milliseconds,
+                     @"Move %u is different", (unsigned)i);
+    }
+    STAssertEqualObjects([copy data], data, @"The data changed in the round trip");
+}
+
+- (void)testReplayWins
+{
+    JbMoveJournal* journal = MakeWonJournal(2, 16);
+    JbMinefield* minefield = [[JbMinefield alloc] init];
+    STAssertTrue([journal replayOnMinefield:minefield] == JbCompleted,
+                 @"The replay didn't win the game");
+    STAssertTrue([journal verifiesElapsedTime:0 onMinefield:minefield],
+                 @"The journal didn't verify the time");
+    STAssertFalse([journal verifiesElapsedTime:5 onMinefield:minefield],
+                  @"The journal verified the wrong time");
+
+    // A journal that ends before the game is won isn't verified.
+    [journal removeMovesAfter:[journal numberOfMoves] - 1];
+    STAssertFalse([journal verifiesElapsedTime:0 onMinefield:minefield],
+                  @"An unfinished game was verified");
+    [minefield release];
+}
+
+- (void)testRejectsTruncatedData
+{
+    NSData* data = [MakeWonJournal(3, 2) data];
+    for (NSUInteger length = 0; length != [data length]; ++length)
+    {
+        NSData* prefix = [data subdataWithRange:NSMakeRange(0, length)];
+        STAssertNil([JbMoveJournal journalWithData:prefix],
+                    @"A journal truncated to %u bytes was read", (unsigned)length);
+    }
+}
+
+- (void)testRejectsHostileData
+{
+    STAssertNotNil([JbMoveJournal journalWithData:MakeJournalData(16, 30, 99, 16)],
+                   @"A valid journal was rejected");
+    STAssertNil([JbMoveJournal journalWithData:MakeJournalData(2001, 30, 99, 0)],
+                @"A journal with too many rows was read");
+    STAssertNil([JbMoveJournal journalWithData:MakeJournalData(16, 2001, 99, 0)],
+                @"A journal with too many columns was read");
+    STAssertNil([JbMoveJournal journalWithData:MakeJournalData(16, 0, 0, 0)],
+                @"A journal without columns was read");
+    STAssertNil([JbMoveJournal journalWithData:MakeJournalData(16, 30, 471, 0)],
+                @"A journal with too many mines was read");
+    STAssertNil([JbMoveJournal journalWithData:MakeJournalData(16, 30, UINT64_MAX - 4, 0)],
+                @"A journal with an overflowing number of mines was read");
+    STAssertNil([JbMoveJournal journalWithData:MakeJournalData(16, 30, 99, (uint64_t)1 << 40)],
+                @"A journal with more moves than data was read");
+
+    // The index of the last move is outside the minefield.
+    NSMutableData* data = [NSMutableData dataWithData:MakeJournalData(2, 8, 1, 16)];
+    uint8_t lastIndex = 16;
+    [data replaceBytesInRange:NSMakeRange([data length] - 1, 1) withBytes:&lastIndex];
+    STAssertNil([JbMoveJournal journalWithData:data],
+                @"A journal with a move outside the minefield was read");
+
+    NSMutableData* badMagic = [NSMutableData dataWithData:MakeJournalData(16, 30, 99, 0)];
+    [badMagic replaceBytesInRange:NSMakeRange(0, 1) withBytes:"X"];
+    STAssertNil([JbMoveJournal journalWithData:badMagic],
+                @"A journal with the wrong magic was read");
+}
+
+@end
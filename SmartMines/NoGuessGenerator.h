@@ -0,0 +1,93 @@
+//
+//  NoGuessGenerator.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "Table.h"
+
+/// Finds a seed that gives a minefield that can be solved without guessing.
+/** Candidate minefields are generated from seeds derived from a base seed,
+    uncovered at the first square and handed to JbMinefieldSolver. A
+    candidate is accepted if the solver can complete it without guessing.
+
+    The candidates are tried by one worker thread per processor. The
+    attempts are independent and equally expensive, so the workers simply
+    take the next attempt number from a shared counter, which keeps them all
+    busy without any other coordination. Every worker stops as soon as one
+    of them has found a solvable minefield.
+
+    Each generator finds one seed; create a new one for the next minefield.
+*/
+@interface JbNoGuessGenerator : NSObject
+{
+    JbTableSize mSize;
+    unsigned mNumberOfMines;
+    BOOL mUsesEasyStart;
+    JbTableIndex mFirstSquare;
+    uint64_t mBaseSeed;
+    uint64_t mMaximumNumberOfAttempts;
+    unsigned mNumberOfThreads;
+    NSCondition* mCondition;
+    unsigned mRunningThreads;
+    volatile uint64_t mNextAttempt;
+    volatile uint64_t mNumberOfAttempts;
+    volatile BOOL mIsDone;
+    BOOL mHasFoundSeed;
+    uint64_t mSeed;
+    double mSeconds;
+}
+
+- (id)initWithSize:(JbTableSize)size
+     numberOfMines:(unsigned)mines
+     usesEasyStart:(BOOL)usesEasyStart
+       firstSquare:(JbTableIndex)firstSquare
+          baseSeed:(uint64_t)baseSeed;
+
+/// The number of worker threads. The default is the number of processors.
+- (unsigned)numberOfThreads;
+- (void)setNumberOfThreads:(unsigned)threads;
+
+/// The generator gives up after this many candidates (default 100000).
+- (uint64_t)maximumNumberOfAttempts;
+- (void)setMaximumNumberOfAttempts:(uint64_t)attempts;
+
+/// Tries candidates until a solvable minefield has been found.
+/** Blocks until a worker has found a solvable minefield, or until the
+    maximum number of attempts have been made.
+    @return YES if a seed was found.
+*/
+- (BOOL)run;
+
+/// The seed of the solvable minefield found by run.
+- (uint64_t)seed;
+/// The number of candidates that were tried, by all the workers.
+- (uint64_t)numberOfAttempts;
+/// The time it took to find the first solvable minefield.
+- (double)seconds;
+@end
@@ -0,0 +1,204 @@
+//
+//  NoGuessGenerator.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "NoGuessGenerator.h"
+#import <assert.h>
+#import "Minefield.h"
+#import "MinefieldSolver.h"
+#import "Random.h"
+#import "Stopwatch.h"
+
+/// Returns the seed of candidate number @a attempt.
+/** The seeds only depend on the base seed and the attempt number, not on
+    which thread tries them.
+*/
+static uint64_t CandidateSeed(uint64_t baseSeed, uint64_t attempt)
+{
+    JbRandom random;
+    JbSeedRandom(&random, baseSeed + attempt * 0x9E3779B97F4A7C15ULL);
+    return JbNextRandom(&random);
+}
+
+@implementation JbNoGuessGenerator
+
+- (id)initWithSize:(JbTableSize)size
+     numberOfMines:(unsigned)mines
+     usesEasyStart:(BOOL)usesEasyStart
+       firstSquare:(JbTableIndex)firstSquare
+          baseSeed:(uint64_t)baseSeed
+{
+    assert(firstSquare.row < size.rows && firstSquare.column < size.columns);
+    self = [super init];
+    if (self)
+    {
+        mSize = size;
+        mNumberOfMines = mines;
+        mUsesEasyStart = usesEasyStart;
+        mFirstSquare = firstSquare;
+        mBaseSeed = baseSeed;
+        mMaximumNumberOfAttempts = 100000;
+        mNumberOfThreads = MAX((unsigned)[[NSProcessInfo processInfo] activeProcessorCount], 1u);
+        mCondition = [[NSCondition alloc] init];
+        mRunningThreads = 0;
+        mNextAttempt = 0;
+        mNumberOfAttempts = 0;
+        mIsDone = NO;
+        mHasFoundSeed = NO;
+        mSeed = baseSeed;
+        mSeconds = 0;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [mCondition release];
+    [super dealloc];
+}
+
+- (unsigned)numberOfThreads
+{
+    return mNumberOfThreads;
+}
+
+- (void)setNumberOfThreads:(unsigned)threads
+{
+    assert(threads != 0);
+    mNumberOfThreads = threads;
+}
+
+- (uint64_t)maximumNumberOfAttempts
+{
+    return mMaximumNumberOfAttempts;
+}
+
+- (void)setMaximumNumberOfAttempts:(uint64_t)attempts
+{
+    mMaximumNumberOfAttempts = attempts;
+}
+
+/// The body of each worker thread.
+/** Every worker has its own minefield, solver and list of uncovered
+    squares, and they are reused for all the worker's candidates, so trying
+    a candidate doesn't allocate any memory.
+*/
+- (void)runWorker:(id)unused
+{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    JbMinefield* minefield = [[JbMinefield alloc] initWithSize:mSize
+                                                 numberOfMines:mNumberOfMines];
+    [minefield setUsesEasyStart:mUsesEasyStart];
+    JbMinefieldSolver* solver = [[JbMinefieldSolver alloc] initWithSize:mSize
+                                                          numberOfMines:mNumberOfMines];
+    JbTableIndexList* opening = [[JbTableIndexList alloc] initWithCapacity:64];
+    while (!mIsDone)
+    {
+        uint64_t attempt = __sync_fetch_and_add(&mNextAttempt, 1);
+        if (attempt >= mMaximumNumberOfAttempts)
+            break;
+
+        uint64_t seed = CandidateSeed(mBaseSeed, attempt);
+        [minefield clear];
+        [minefield setSeed:seed];
+        [solver clear];
+        [opening removeAllValues];
+        [minefield uncoverAt:mFirstSquare affectedSquares:opening];
+        [solver addUncoveredSquares:opening ofMinefield:minefield];
+        BOOL isSolvable = [minefield state] == JbCompleted
+                          || [solver solveMinefield:minefield];
+        __sync_add_and_fetch(&mNumberOfAttempts, 1);
+
+        if (isSolvable)
+        {
+            [mCondition lock];
+            if (!mIsDone)
+            {
+                mIsDone = YES;
+                mHasFoundSeed = YES;
+                mSeed = seed;
+            }
+            [mCondition unlock];
+        }
+    }
+    [opening release];
+    [solver release];
+    [minefield release];
+
+    [mCondition lock];
+    --mRunningThreads;
+    [mCondition signal];
+    [mCondition unlock];
+    [pool release];
+}
+
+- (BOOL)run
+{
+    assert(mRunningThreads == 0 && !mIsDone);
+    JbStopwatch* stopwatch = [[JbStopwatch alloc] init];
+    [stopwatch start];
+
+    [mCondition lock];
+    mRunningThreads = mNumberOfThreads;
+    [mCondition unlock];
+    // The threads retain the generator, so the workers that are still busy
+    // with a candidate when a seed has been found can finish it after run
+    // has returned.
+    for (unsigned i = 0; i != mNumberOfThreads; ++i)
+        [NSThread detachNewThreadSelector:@selector(runWorker:)
+                                 toTarget:self
+                               withObject:nil];
+
+    [mCondition lock];
+    while (!mIsDone && mRunningThreads != 0)
+        [mCondition wait];
+    mIsDone = YES;
+    [mCondition unlock];
+
+    mSeconds = [stopwatch stop];
+    [stopwatch release];
+    return mHasFoundSeed;
+}
+
+- (uint64_t)seed
+{
+    return mSeed;
+}
+
+- (uint64_t)numberOfAttempts
+{
+    return mNumberOfAttempts;
+}
+
+- (double)seconds
+{
+    return mSeconds;
+}
+
+@end
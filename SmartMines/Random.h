@@ -0,0 +1,83 @@
+//
+//  Random.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import <assert.h>
+#import <stdint.h>
+
+/// State of a xoshiro256** pseudo-random number generator.
+/** Every JbRandom is independent of the others and of random(), so each
+    minefield (or thread) can have its own generator and produce the same
+    sequence of numbers every time it is given the same seed.
+*/
+typedef struct JbRandomStruct
+{
+    uint64_t state[4];
+} JbRandom;
+
+/// Initializes @a random so that it produces the sequence given by @a seed.
+void JbSeedRandom(JbRandom* random, uint64_t seed);
+
+/// Returns a seed that is different for each call, even across threads.
+uint64_t JbMakeRandomSeed(void);
+
+static inline uint64_t JbRotateLeft64(uint64_t value, unsigned bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/// Returns the next 64-bit number in @a random's sequence.
+static inline uint64_t JbNextRandom(JbRandom* random)
+{
+    uint64_t* s = random->state;
+    uint64_t result = JbRotateLeft64(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = JbRotateLeft64(s[3], 45);
+    return result;
+}
+
+/// Returns a uniformly distributed number from 0 up to, but not including,
+/// @a bound.
+static inline uint64_t JbRandomBelow(JbRandom* random, uint64_t bound)
+{
+    assert(bound != 0);
+    // Reject the lowest (2^64 mod bound) values to avoid modulo bias.
+    uint64_t threshold = (0 - bound) % bound;
+    uint64_t value;
+    do
+        value = JbNextRandom(random);
+    while (value < threshold);
+    return value % bound;
+}
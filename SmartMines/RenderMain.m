@@ -0,0 +1,182 @@
+//
+//  RenderMain.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+/// Command line driver for JbBoardRenderer.
+/** Plays a game until the solver is stuck, then either writes the
+    minefield to an image file or measures how many frames per second the
+    renderer draws. The benchmark prints one line per game size, starting
+    with the standard sizes, followed by the size given with -g.
+*/
+
+#import <Foundation/Foundation.h>
+#import <stdio.h>
+#import <stdlib.h>
+#import <string.h>
+#import <unistd.h>
+
+#import "BoardRenderer.h"
+#import "Game.h"
+#import "Minefield.h"
+#import "MinefieldSolver.h"
+#import "Random.h"
+#import "Stopwatch.h"
+
+static void PrintUsage(const char* program)
+{
+    fprintf(stderr,
+            "usage: %s [-g ROWSxCOLUMNSxMINES] [-s SEED] [-z SQUARESIZE] [-o FILE] [-b FRAMES]\n"
+            "  -g  game size (default 16x30x99)\n"
+            "  -s  the minefield's seed\n"
+            "  -z  the size of the squares in pixels (default 16)\n"
+            "  -o  write the minefield to FILE, as PNG unless the name ends\n"
+            "      with .ppm\n"
+            "  -b  render FRAMES frames of each standard size and the -g size,\n"
+            "      and print the frame rates\n",
+            program);
+}
+
+/// Returns a minefield where the middle square has been uncovered and the
+/// solver has uncovered everything it could without guessing.
+static JbMinefield* MakeMinefield(JbGame* game, uint64_t seed)
+{
+    JbTableSize size = [game size];
+    JbMinefield* minefield = [[[JbMinefield alloc] initWithSize:size
+                                                  numberOfMines:[game mines]] autorelease];
+    [minefield setSeed:seed];
+    JbTableIndexList* affected = [[[JbTableIndexList alloc] initWithCapacity:64] autorelease];
+    [minefield uncoverAt:JbMakeTableIndex(size.rows / 2, size.columns / 2)
+         affectedSquares:affected];
+    JbMinefieldSolver* solver = [[[JbMinefieldSolver alloc] initWithSize:size
+                                                           numberOfMines:[game mines]]
+                                  autorelease];
+    [solver addUncoveredSquares:affected ofMinefield:minefield];
+    [solver solveMinefield:minefield];
+    return minefield;
+}
+
+static void RunBenchmark(JbGame* game,
+                         uint64_t seed,
+                         JbBoardRenderer* renderer,
+                         unsigned frames)
+{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    JbMinefield* minefield = MakeMinefield(game, seed);
+    [renderer renderMinefield:minefield];
+
+    JbStopwatch* stopwatch = [[[JbStopwatch alloc] init] autorelease];
+    [stopwatch start];
+    for (unsigned i = 0; i != frames; ++i)
+        [renderer renderMinefield:minefield];
+    double seconds = [stopwatch stop];
+
+    printf("game=%s square_size=%u width=%u height=%u frames=%u seconds=%.6f"
+           " frames_per_second=%.1f megapixels_per_second=%.1f\n",
+           [[game description] UTF8String], [renderer squareSize],
+           [renderer width], [renderer height], frames, seconds,
+           seconds > 0 ? frames / seconds : 0.0,
+           seconds > 0 ? (double)[renderer width] * [renderer height] * frames
+                         / seconds / 1e6
+                       : 0.0);
+    [pool release];
+}
+
+int main(int argc, char* argv[])
+{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    const char* description = "16x30x99";
+    const char* fileName = NULL;
+    uint64_t seed = JbMakeRandomSeed();
+    unsigned squareSize = 16;
+    unsigned frames = 0;
+
+    int option;
+    while ((option = getopt(argc, argv, "g:s:z:o:b:")) != -1)
+    {
+        switch (option)
+        {
+        case 'g': description = optarg; break;
+        case 's': seed = strtoull(optarg, NULL, 10); break;
+        case 'z': squareSize = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'o': fileName = optarg; break;
+        case 'b': frames = (unsigned)strtoul(optarg, NULL, 10); break;
+        default:
+            PrintUsage(argv[0]);
+            [pool release];
+            return 1;
+        }
+    }
+
+    JbGame* game = [[[JbGame alloc] initWithDescription:
+                        [NSString stringWithUTF8String:description]] autorelease];
+    if (game == nil)
+    {
+        fprintf(stderr, "%s: invalid game size: %s\n", argv[0], description);
+        [pool release];
+        return 1;
+    }
+    if (squareSize == 0 || (fileName == NULL && frames == 0))
+    {
+        PrintUsage(argv[0]);
+        [pool release];
+        return 1;
+    }
+
+    JbBoardRenderer* renderer = [[[JbBoardRenderer alloc] initWithSquareSize:squareSize]
+                                 autorelease];
+    if (frames != 0)
+    {
+        static const char* const StandardGames[] = {"9x9x10", "16x16x40", "16x30x99"};
+        for (unsigned i = 0; i != sizeof(StandardGames) / sizeof(*StandardGames); ++i)
+        {
+            NSString* standard = [NSString stringWithUTF8String:StandardGames[i]];
+            JbGame* standardGame = [[[JbGame alloc] initWithDescription:standard]
+                                    autorelease];
+            if (![[standardGame description] isEqualToString:[game description]])
+                RunBenchmark(standardGame, seed, renderer, frames);
+        }
+        RunBenchmark(game, seed, renderer, frames);
+    }
+
+    BOOL success = YES;
+    if (fileName != NULL)
+    {
+        [renderer renderMinefield:MakeMinefield(game, seed)];
+        NSString* path = [NSString stringWithUTF8String:fileName];
+        if ([[[path pathExtension] lowercaseString] isEqualToString:@"ppm"])
+            success = [renderer writePPMToFile:path];
+        else
+            success = [renderer writePNGToFile:path];
+        if (!success)
+            fprintf(stderr, "%s: can't write %s\n", argv[0], fileName);
+    }
+
+    [pool release];
+    return success ? 0 : 1;
+}
@@ -0,0 +1,700 @@
+//
+//  ServerMain.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+/// A line protocol for bots that play JbMinefield from another process.
+/** The server reads requests from stdin and writes the replies to stdout,
+    or with -u serves the connections to a Unix socket one at a time. Each
+    line is a batch of commands separated by ';', and gets one reply line
+    with the commands' replies separated by ';':
+    @code
+    new ROWS COLUMNS MINES [SEED]  start a game       -> new ROWS COLUMNS MINES SEED
+    u ROW COLUMN                   uncover            -> move reply
+    m ROW COLUMN                   mark               -> move reply
+    c ROW COLUMN                   chord: uncover the neighbors of an
+                                   uncovered number whose mines are marked
+    q                              query the state    -> state S COVERED MARKED MINES
+    board                          the whole board    -> board ROW/ROW/...
+    mode text|binary               the reply format   -> mode text|binary
+    @endcode
+    A move reply is the game's state (n: not started, p: playing, w: won,
+    l: lost) followed by the squares that changed, each as "ROW COLUMN
+    CODE", where CODE is 0-8 for an uncovered square's number, '.' for a
+    covered square, 'F' for a mark, '?' for a question mark and '*' for a
+    mine. Errors are replied as "error MESSAGE". Squares are numbered from
+    0, and the first uncover places the mines with easy start. Games have
+    from 3 to 2000 rows and columns.
+
+    A mode change applies from the next line, so all the replies on a line
+    have the same format. In binary mode every reply line is instead a
+    frame: its length as a four-byte little-endian number, followed by one
+    record per command. A move record is the byte 0, the state (0-3 as
+    JbMinefieldState), the number of changed squares as a varint, and for
+    each square the difference between its index (ROW * COLUMNS + COLUMN)
+    and the previous square's index as a zigzag varint, followed by its
+    code as a byte (0-8, 9 covered, 10 marked, 11 question-marked, 12
+    mine). Any other reply is the byte 1, its length as a varint, and the
+    text.
+
+    Replies are buffered, and only written when every complete line that
+    has been read so far has been handled, so a bot that sends many lines
+    without waiting for the replies gets them in few writes.
+*/
+
+#import <Foundation/Foundation.h>
+#import <errno.h>
+#import <limits.h>
+#import <signal.h>
+#import <stdio.h>
+#import <stdlib.h>
+#import <string.h>
+#import <sys/socket.h>
+#import <sys/un.h>
+#import <unistd.h>
+
+#import "Minefield.h"
+#import "Random.h"
+#import "TableIndexList.h"
+
+enum {MinimumReadSize = 65536};
+/// The longest request line that is accepted.
+enum {MaximumLineLength = 1 << 24};
+/// The most rows or columns a game can have, as in JbGame.
+enum {MaxRowsOrColumns = 2000};
+
+typedef enum
+{
+    JbCoveredCode = 9,
+    JbMarkedCode,
+    JbQuestionMarkedCode,
+    JbMineCode
+} JbSquareCode;
+
+typedef struct
+{
+    char* bytes;
+    size_t size;
+    size_t capacity;
+} JbBuffer;
+
+typedef struct
+{
+    JbMinefield* minefield;
+    JbTableIndexList* affectedSquares;
+    JbRandom random;
+    BOOL isBinary;
+    /// The mode of the next line, set by the mode command.
+    BOOL isNextLineBinary;
+    JbBuffer output;
+} JbServerSession;
+
+static void Reserve(JbBuffer* buffer, size_t size)
+{
+    if (buffer->size + size <= buffer->capacity)
+        return;
+    size_t capacity = MAX(buffer->size + size, buffer->capacity * 2);
+    char* bytes = realloc(buffer->bytes, capacity);
+    NSCAssert(bytes != NULL, @"Unable to allocate memory for the buffer");
+    buffer->bytes = bytes;
+    buffer->capacity = capacity;
+}
+
+static void AppendBytes(JbBuffer* buffer, const void* bytes, size_t size)
+{
+    Reserve(buffer, size);
+    memcpy(buffer->bytes + buffer->size, bytes, size);
+    buffer->size += size;
+}
+
+static void AppendText(JbBuffer* buffer, const char* text)
+{
+    AppendBytes(buffer, text, strlen(text));
+}
+
+static void AppendByte(JbBuffer* buffer, uint8_t byte)
+{
+    Reserve(buffer, 1);
+    buffer->bytes[buffer->size++] = (char)byte;
+}
+
+static void AppendUnsigned(JbBuffer* buffer, unsigned long long value)
+{
+    char digits[20];
+    unsigned count = 0;
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    Reserve(buffer, count);
+    while (count != 0)
+        buffer->bytes[buffer->size++] = digits[--count];
+}
+
+static void AppendVarint(JbBuffer* buffer, uint64_t value)
+{
+    Reserve(buffer, 10);
+    do
+    {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buffer->bytes[buffer->size++] = (char)(byte | (value != 0 ? 0x80 : 0));
+    } while (value != 0);
+}
+
+static BOOL WriteAll(int file, const char* bytes, size_t size)
+{
+    while (size != 0)
+    {
+        ssize_t n = write(file, bytes, size);
+        if (n <= 0)
+        {
+            if (n == -1 && errno == EINTR)
+                continue;
+            return NO;
+        }
+        bytes += n;
+        size -= (size_t)n;
+    }
+    return YES;
+}
+
+static const char* SkipSpaces(const char* it, const char* end)
+{
+    while (it != end && (*it == ' ' || *it == '\t' || *it == '\r'))
+        ++it;
+    return it;
+}
+
+/// Parses a number after optional spaces.
+/** Returns NO, without moving @a it, if there is no number or it doesn't
+    fit in an unsigned long long.
+*/
+static BOOL ParseNumber(const char** it, const char* end, unsigned long long* value)
+{
+    const char* p = SkipSpaces(*it, end);
+    if (p == end || *p < '0' || *p > '9')
+        return NO;
+    unsigned long long result = 0;
+    for (; p != end && *p >= '0' && *p <= '9'; ++p)
+    {
+        unsigned digit = (unsigned)(*p - '0');
+        if (result > (ULLONG_MAX - digit) / 10)
+            return NO;
+        result = result * 10 + digit;
+    }
+    *it = p;
+    *value = result;
+    return YES;
+}
+
+/// True if the word at @a it is @a word, in which case @a it is moved past
+/// it.
+static BOOL ParseWord(const char** it, const char* end, const char* word)
+{
+    const char* p = SkipSpaces(*it, end);
+    size_t length = strlen(word);
+    if ((size_t)(end - p) < length || memcmp(p, word, length) != 0
+        || (p + length != end && p[length] != ' ' && p[length] != '\t'
+            && p[length] != '\r'))
+        return NO;
+    *it = p + length;
+    return YES;
+}
+
+static unsigned GetSquareCode(JbMinefield* minefield, JbTableIndex idx)
+{
+    switch ([minefield stateAt:idx])
+    {
+    case JbUnmarked:
+        return JbCoveredCode;
+    case JbMarked:
+        return JbMarkedCode;
+    case JbQuestionMarked:
+        return JbQuestionMarkedCode;
+    case JbUncovered:
+    default:
+        return [minefield hasMineAt:idx] ? JbMineCode
+                                         : [minefield countNeighborsWithMinesAt:idx];
+    }
+}
+
+static char GetSquareCharacter(unsigned code)
+{
+    static const char Characters[] = "012345678.F?*";
+    return Characters[code];
+}
+
+static char GetStateCharacter(JbMinefieldState state)
+{
+    static const char Characters[] = "npwl";
+    return Characters[state];
+}
+
+/// Starts a text reply, which in binary mode is a record of its own.
+static void BeginText(JbServerSession* session, size_t* start)
+{
+    if (session->isBinary)
+        AppendByte(&session->output, 1);
+    *start = session->output.size;
+}
+
+/// Ends a text reply started by BeginText.
+/** In binary mode the text is moved to make room for its length.
+*/
+static void EndText(JbServerSession* session, size_t start)
+{
+    if (!session->isBinary)
+        return;
+    JbBuffer* output = &session->output;
+    size_t length = output->size - start;
+    uint8_t prefix[10];
+    unsigned prefixLength = 0;
+    uint64_t value = length;
+    do
+    {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        prefix[prefixLength++] = byte | (value != 0 ? 0x80 : 0);
+    } while (value != 0);
+    Reserve(output, prefixLength);
+    memmove(output->bytes + start + prefixLength, output->bytes + start, length);
+    memcpy(output->bytes + start, prefix, prefixLength);
+    output->size += prefixLength;
+}
+
+static void ReplyError(JbServerSession* session, const char* message)
+{
+    size_t start;
+    BeginText(session, &start);
+    AppendText(&session->output, "error ");
+    AppendText(&session->output, message);
+    EndText(session, start);
+}
+
+static void ReplyMove(JbServerSession* session)
+{
+    JbMinefield* minefield = session->minefield;
+    JbTableIndexList* affected = session->affectedSquares;
+    JbBuffer* output = &session->output;
+    JbTableIndex* begin = [affected begin];
+    JbTableIndex* end = [affected end];
+    if (session->isBinary)
+    {
+        unsigned columns = [minefield size].columns;
+        AppendByte(output, 0);
+        AppendByte(output, (uint8_t)[minefield state]);
+        AppendVarint(output, (uint64_t)(end - begin));
+        int64_t previous = 0;
+        for (JbTableIndex* it = begin; it != end; ++it)
+        {
+            int64_t index = (int64_t)it->row * columns + it->column;
+            int64_t delta = index - previous;
+            AppendVarint(output, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+            AppendByte(output, (uint8_t)GetSquareCode(minefield, *it));
+            previous = index;
+        }
+    }
+    else
+    {
+        AppendByte(output, (uint8_t)GetStateCharacter([minefield state]));
+        for (JbTableIndex* it = begin; it != end; ++it)
+        {
+            AppendByte(output, ' ');
+            AppendUnsigned(output, it->row);
+            AppendByte(output, ' ');
+            AppendUnsigned(output, it->column);
+            AppendByte(output, ' ');
+            AppendByte(output, (uint8_t)GetSquareCharacter(GetSquareCode(minefield, *it)));
+        }
+    }
+}
+
+static void HandleNew(JbServerSession* session, const char* it, const char* end)
+{
+    unsigned long long rows, columns, mines, seed;
+    if (!ParseNumber(&it, end, &rows) || !ParseNumber(&it, end, &columns)
+        || !ParseNumber(&it, end, &mines))
+    {
+        ReplyError(session, "usage: new ROWS COLUMNS MINES [SEED]");
+        return;
+    }
+    if (!ParseNumber(&it, end, &seed))
+        seed = JbNextRandom(&session->random);
+    if (SkipSpaces(it, end) != end)
+    {
+        ReplyError(session, "usage: new ROWS COLUMNS MINES [SEED]");
+        return;
+    }
+    if (rows < 3 || columns < 3 || rows > MaxRowsOrColumns || columns > MaxRowsOrColumns
+        || mines >= rows * columns - 9)
+    {
+        ReplyError(session, "invalid game size");
+        return;
+    }
+
+    JbTableSize size = JbMakeTableSize((unsigned)rows, (unsigned)columns);
+    if (session->minefield == nil)
+    {
+        session->minefield = [[JbMinefield alloc] initWithSize:size
+                                                 numberOfMines:(unsigned)mines];
+        [session->minefield setUsesEasyStart:YES];
+        [session->minefield setUsesSmartUncover:NO];
+        [session->minefield setUsesSmartMark:NO];
+        [session->minefield setUsesQuestionMarks:NO affectedSquares:nil];
+    }
+    else if (!JbEqualTableSizes([session->minefield size], size)
+             || [session->minefield numberOfMines] != mines)
+    {
+        [session->minefield setSize:size numberOfMines:(unsigned)mines];
+    }
+    [session->minefield clear];
+    [session->minefield setSeed:seed];
+
+    size_t start;
+    BeginText(session, &start);
+    AppendText(&session->output, "new ");
+    AppendUnsigned(&session->output, rows);
+    AppendByte(&session->output, ' ');
+    AppendUnsigned(&session->output, columns);
+    AppendByte(&session->output, ' ');
+    AppendUnsigned(&session->output, mines);
+    AppendByte(&session->output, ' ');
+    AppendUnsigned(&session->output, seed);
+    EndText(session, start);
+}
+
+static void HandleMove(JbServerSession* session, char command, const char* it, const char* end)
+{
+    JbMinefield* minefield = session->minefield;
+    unsigned long long row, column;
+    if (!ParseNumber(&it, end, &row) || !ParseNumber(&it, end, &column))
+    {
+        ReplyError(session, "usage: u|m|c ROW COLUMN");
+        return;
+    }
+    if (minefield == nil)
+    {
+        ReplyError(session, "no game");
+        return;
+    }
+    JbTableSize size = [minefield size];
+    if (row >= size.rows || column >= size.columns)
+    {
+        ReplyError(session, "square is outside the minefield");
+        return;
+    }
+    JbMinefieldState state = [minefield state];
+    if (state == JbCompleted || state == JbBlownUp)
+    {
+        ReplyError(session, "game over");
+        return;
+    }
+
+    JbTableIndex idx = JbMakeTableIndex((unsigned)row, (unsigned)column);
+    [session->affectedSquares removeAllValues];
+    if (command == 'u')
+    {
+        // Smart uncover is off, so uncovering an uncovered square does nothing.
+        [minefield uncoverAt:idx affectedSquares:session->affectedSquares];
+    }
+    else if (command == 'm')
+    {
+        if (state == JbNotStarted)
+        {
+            ReplyError(session, "game not started");
+            return;
+        }
+        [minefield markAt:idx affectedSquares:session->affectedSquares];
+    }
+    else
+    {
+        if ([minefield stateAt:idx] != JbUncovered)
+        {
+            ReplyError(session, "not an uncovered square");
+            return;
+        }
+        [minefield setUsesSmartUncover:YES];
+        [minefield uncoverAt:idx affectedSquares:session->affectedSquares];
+        [minefield setUsesSmartUncover:NO];
+    }
+    ReplyMove(session);
+}
+
+static void HandleQuery(JbServerSession* session)
+{
+    JbMinefield* minefield = session->minefield;
+    if (minefield == nil)
+    {
+        ReplyError(session, "no game");
+        return;
+    }
+    size_t start;
+    BeginText(session, &start);
+    AppendText(&session->output, "state ");
+    AppendByte(&session->output, (uint8_t)GetStateCharacter([minefield state]));
+    AppendByte(&session->output, ' ');
+    AppendUnsigned(&session->output, [minefield numberOfCoveredSquares]);
+    AppendByte(&session->output, ' ');
+    AppendUnsigned(&session->output, [minefield numberOfMarkedSquares]);
+    AppendByte(&session->output, ' ');
+    AppendUnsigned(&session->output, [minefield numberOfMines]);
+    EndText(session, start);
+}
+
+static void HandleBoard(JbServerSession* session)
+{
+    JbMinefield* minefield = session->minefield;
+    if (minefield == nil)
+    {
+        ReplyError(session, "no game");
+        return;
+    }
+    JbTableSize size = [minefield size];
+    size_t start;
+    BeginText(session, &start);
+    AppendText(&session->output, "board ");
+    Reserve(&session->output, (size_t)size.rows * (size.columns + 1));
+    for (unsigned row = 0; row != size.rows; ++row)
+    {
+        if (row != 0)
+            AppendByte(&session->output, '/');
+        for (unsigned column = 0; column != size.columns; ++column)
+        {
+            unsigned code = GetSquareCode(minefield, JbMakeTableIndex(row, column));
+            AppendByte(&session->output, (uint8_t)GetSquareCharacter(code));
+        }
+    }
+    EndText(session, start);
+}
+
+static void HandleCommand(JbServerSession* session, const char* it, const char* end)
+{
+    const char* p = it;
+    if (ParseWord(&p, end, "u") || ParseWord(&p, end, "m") || ParseWord(&p, end, "c"))
+        HandleMove(session, p[-1], p, end);
+    else if (ParseWord(&p, end, "new"))
+        HandleNew(session, p, end);
+    else if (ParseWord(&p, end, "q"))
+        HandleQuery(session);
+    else if (ParseWord(&p, end, "board"))
+        HandleBoard(session);
+    else if (ParseWord(&p, end, "mode"))
+    {
+        BOOL isBinary = ParseWord(&p, end, "binary");
+        if (!isBinary && !ParseWord(&p, end, "text"))
+        {
+            ReplyError(session, "usage: mode text|binary");
+            return;
+        }
+        // The line's replies are all in the old mode, so the bot knows
+        // where it ends.
+        size_t start;
+        BeginText(session, &start);
+        AppendText(&session->output, isBinary ? "mode binary" : "mode text");
+        EndText(session, start);
+        session->isNextLineBinary = isBinary;
+    }
+    else
+        ReplyError(session, "unknown command");
+}
+
+static void HandleLine(JbServerSession* session, const char* begin, const char* end)
+{
+    if (SkipSpaces(begin, end) == end)
+        return;
+    JbBuffer* output = &session->output;
+    BOOL isBinary = session->isBinary;
+    size_t frameStart = output->size;
+    if (isBinary)
+        AppendBytes(output, "\0\0\0\0", 4);
+
+    const char* it = begin;
+    while (it != end)
+    {
+        const char* next = memchr(it, ';', (size_t)(end - it));
+        if (next == NULL)
+            next = end;
+        if (it != begin && !isBinary)
+            AppendByte(output, ';');
+        HandleCommand(session, it, next);
+        it = next != end ? next + 1 : end;
+    }
+
+    if (isBinary)
+    {
+        uint32_t length = (uint32_t)(output->size - frameStart - 4);
+        uint8_t prefix[4] = {length, length >> 8, length >> 16, length >> 24};
+        memcpy(output->bytes + frameStart, prefix, 4);
+    }
+    else
+    {
+        AppendByte(output, '\n');
+    }
+    session->isBinary = session->isNextLineBinary;
+}
+
+/// Handles the requests from @a input until the end of the file.
+static BOOL Serve(int input, int output, uint64_t seed)
+{
+    JbServerSession session;
+    session.minefield = nil;
+    session.affectedSquares = [[JbTableIndexList alloc] initWithCapacity:256];
+    JbSeedRandom(&session.random, seed);
+    session.isBinary = NO;
+    session.isNextLineBinary = NO;
+    memset(&session.output, 0, sizeof(session.output));
+    JbBuffer buffer;
+    memset(&buffer, 0, sizeof(buffer));
+
+    BOOL success = YES;
+    size_t lineStart = 0;
+    while (success)
+    {
+        Reserve(&buffer, MinimumReadSize);
+        ssize_t n = read(input, buffer.bytes + buffer.size, buffer.capacity - buffer.size);
+        if (n == -1 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        size_t scanStart = buffer.size;
+        buffer.size += (size_t)n;
+
+        NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+        const char* newline;
+        while ((newline = memchr(buffer.bytes + scanStart, '\n',
+                                 buffer.size - scanStart)) != NULL)
+        {
+            HandleLine(&session, buffer.bytes + lineStart, newline);
+            lineStart = (size_t)(newline - buffer.bytes) + 1;
+            scanStart = lineStart;
+        }
+        [pool release];
+
+        // Keep the incomplete line at the start of the buffer.
+        memmove(buffer.bytes, buffer.bytes + lineStart, buffer.size - lineStart);
+        buffer.size -= lineStart;
+        lineStart = 0;
+        if (buffer.size > MaximumLineLength)
+        {
+            fprintf(stderr, "request line is too long\n");
+            success = NO;
+        }
+
+        success = success && WriteAll(output, session.output.bytes, session.output.size);
+        session.output.size = 0;
+    }
+    if (success && buffer.size != 0)
+    {
+        HandleLine(&session, buffer.bytes, buffer.bytes + buffer.size);
+        success = WriteAll(output, session.output.bytes, session.output.size);
+    }
+
+    free(buffer.bytes);
+    free(session.output.bytes);
+    [session.affectedSquares release];
+    [session.minefield release];
+    return success;
+}
+
+/// Serves the connections to a Unix socket at @a path, one at a time.
+static BOOL ServeSocket(const char* path, uint64_t seed)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "socket path is too long: %s\n", path);
+        return NO;
+    }
+    strcpy(address.sun_path, path);
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if (server == -1
+        || bind(server, (struct sockaddr*)&address, sizeof(address)) != 0
+        || listen(server, 16) != 0)
+    {
+        fprintf(stderr, "can't listen to %s: %s\n", path, strerror(errno));
+        if (server != -1)
+            close(server);
+        return NO;
+    }
+
+    JbRandom random;
+    JbSeedRandom(&random, seed);
+    while (YES)
+    {
+        int connection = accept(server, NULL, NULL);
+        if (connection == -1)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+        Serve(connection, connection, JbNextRandom(&random));
+        close(connection);
+    }
+    close(server);
+    unlink(path);
+    return NO;
+}
+
+int main(int argc, char* argv[])
+{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    const char* socketPath = NULL;
+    uint64_t seed = JbMakeRandomSeed();
+
+    int option;
+    while ((option = getopt(argc, argv, "u:s:")) != -1)
+    {
+        switch (option)
+        {
+        case 'u': socketPath = optarg; break;
+        case 's': seed = strtoull(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr,
+                    "usage: %s [-u SOCKETPATH] [-s SEED]\n"
+                    "  -u  serve the connections to a Unix socket instead of stdin\n"
+                    "  -s  seed that the seeds of games without one are drawn from\n",
+                    argv[0]);
+            [pool release];
+            return 1;
+        }
+    }
+
+    // A bot that disconnects early shouldn't stop the server.
+    signal(SIGPIPE, SIG_IGN);
+    BOOL success = socketPath != NULL ? ServeSocket(socketPath, seed)
+                                      : Serve(STDIN_FILENO, STDOUT_FILENO, seed);
+    [pool release];
+    return success ? 0 : 1;
+}
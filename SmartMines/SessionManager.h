@@ -0,0 +1,153 @@
+//
+//  SessionManager.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "Minefield.h"
+
+@class JbSessionManager;
+
+typedef enum
+{
+    /// Starts a new game in the session, with a new seed.
+    JbSessionNewGame,
+    JbSessionUncover,
+    JbSessionMark,
+    /// Ends the session. Its id may be reused by a later session.
+    JbSessionClose
+} JbSessionCommand;
+
+/// The id createSessionWithSize:numberOfMines:usesEasyStart:seed: returns
+/// when it can't create the session.
+enum {JbInvalidSessionId = 0xFFFFFFFF};
+
+typedef struct JbSessionRequestStruct
+{
+    uint32_t session;
+    JbSessionCommand command;
+    /// The square of an uncover or mark.
+    JbTableIndex index;
+} JbSessionRequest;
+
+typedef struct JbSessionResultStruct
+{
+    /// NO if the session doesn't exist, the square is outside the
+    /// minefield, or the game is over (or, for marks, not started).
+    BOOL isValid;
+    JbMinefieldState state;
+    /// The number of uncovers and marks in the session's current game,
+    /// including this one.
+    unsigned numberOfMoves;
+    /// The squares the request affected. They are only valid until the
+    /// delegate returns.
+    const JbTableIndex* affectedSquares;
+    size_t numberOfAffectedSquares;
+} JbSessionResult;
+
+/// Receives the results of the requests, on the sessions' worker threads.
+@protocol JbSessionManagerDelegate
+/// Called once for every request, in the order the session's requests were
+/// submitted. The delegate may submit new requests.
+- (void)sessionManager:(JbSessionManager*)manager
+      didHandleRequest:(const JbSessionRequest*)request
+                result:(const JbSessionResult*)result;
+@end
+
+/// Hosts many games at the same time on a fixed pool of worker threads.
+/** Every session is owned by one worker, chosen when the session is
+    created, and all its requests are handled by that worker in the order
+    they were submitted. A session's minefield is therefore only ever used
+    by one thread, and needs no locks. The workers have nothing else in
+    common: each has its own queue, its own random number generator, its
+    own list of affected squares, and its own spare minefields from closed
+    sessions, which new sessions of the same size reuse. Once the workers'
+    buffers have grown, handling a move allocates no memory, and the moves
+    per second grow with the number of workers until the processors are
+    busy.
+
+    Submitting a request only takes the lock of the session's worker for
+    as long as it takes to append to its queue. A worker takes everything
+    in its queue at once, and handles it without holding the lock.
+
+    The worker threads retain the manager until it is stopped.
+*/
+@class JbSessionWorker;
+
+@interface JbSessionManager : NSObject
+{
+    JbSessionWorker** mWorkers;
+    unsigned mNumberOfWorkers;
+    id<JbSessionManagerDelegate> mDelegate;
+    NSCondition* mIdleCondition;
+    volatile unsigned mNextWorker;
+    volatile unsigned long long mNumberOfSubmittedRequests;
+    volatile unsigned long long mNumberOfHandledRequests;
+}
+
+/// Creates a manager with @a threads workers, or one per processor if
+/// @a threads is 0.
+- (id)initWithNumberOfThreads:(unsigned)threads;
+
+- (unsigned)numberOfThreads;
+
+/// The delegate isn't retained, and must be set before the first request is
+/// submitted.
+- (id<JbSessionManagerDelegate>)delegate;
+- (void)setDelegate:(id<JbSessionManagerDelegate>)delegate;
+
+/// Creates a session and submits its first JbSessionNewGame request.
+/** A @a seed of 0 lets the worker choose the seeds. The minefield must
+    have at least one row and one column, and room for the mines outside
+    the first uncovered square (and its neighbors with easy start). This is
+    checked on the calling thread, as the workers have no way to report it.
+    @return the id of the new session, or JbInvalidSessionId if the size
+            or number of mines is invalid.
+*/
+- (uint32_t)createSessionWithSize:(JbTableSize)size
+                    numberOfMines:(unsigned)mines
+                    usesEasyStart:(BOOL)usesEasyStart
+                             seed:(uint64_t)seed;
+
+/// Queues @a request for the session's worker. Thread-safe.
+- (void)submitRequest:(JbSessionRequest)request;
+/// Queues @a count requests, taking each worker's lock once.
+- (void)submitRequests:(const JbSessionRequest*)requests count:(size_t)count;
+
+/// Blocks until the workers have handled all the requests that have been
+/// submitted, including those the delegate submits meanwhile.
+- (void)waitUntilIdle;
+
+/// The number of open sessions.
+- (unsigned)numberOfSessions;
+/// The number of uncovers and marks the workers have handled.
+- (unsigned long long)numberOfMoves;
+
+/// Stops the worker threads after they have handled their queues.
+- (void)stop;
+@end
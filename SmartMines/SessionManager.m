@@ -0,0 +1,548 @@
+//
+//  SessionManager.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "SessionManager.h"
+#import <assert.h>
+#import <stdlib.h>
+#import <string.h>
+#import "Random.h"
+#import "TableIndexList.h"
+
+/// A request as it is queued: JbSessionNewGame requests that create a
+/// session also carry its settings.
+typedef struct
+{
+    JbSessionRequest request;
+    BOOL isCreation;
+    JbTableSize size;
+    unsigned numberOfMines;
+    BOOL usesEasyStart;
+    uint64_t seed;
+} JbSessionTask;
+
+typedef struct
+{
+    /// nil if the slot isn't in use.
+    JbMinefield* minefield;
+    /// Every new game in the session takes its seed from here.
+    JbRandom random;
+    unsigned numberOfMoves;
+} JbSession;
+
+/// The largest number of minefields from closed sessions a worker keeps.
+enum {MaximumSpareMinefields = 16};
+
+/// Grows @a array to at least @a count elements of @a elementSize bytes.
+static void* GrowArray(void* array, size_t* capacity, size_t count, size_t elementSize)
+{
+    if (count <= *capacity)
+        return array;
+    size_t newCapacity = MAX(count, *capacity == 0 ? 16 : *capacity * 2);
+    void* newArray = realloc(array, newCapacity * elementSize);
+    NSCAssert(newArray != NULL, @"Unable to allocate memory for the sessions");
+    *capacity = newCapacity;
+    return newArray;
+}
+
+@interface JbSessionManager (Workers)
+/// Called by the workers after every batch.
+- (void)didHandleRequests:(size_t)count;
+@end
+
+/// One worker thread and the sessions it owns.
+/** The members up to mNumberOfSessions are shared with the threads that
+    submit requests, and protected by mCondition. The rest are only used
+    by the worker thread.
+*/
+@interface JbSessionWorker : NSObject
+{
+    JbSessionManager* mManager;
+    unsigned mIndex;
+    unsigned mNumberOfWorkers;
+    NSCondition* mCondition;
+    JbSessionTask* mQueue;
+    size_t mQueueCount;
+    size_t mQueueCapacity;
+    uint32_t* mFreeSlots;
+    size_t mNumberOfFreeSlots;
+    size_t mFreeSlotsCapacity;
+    uint32_t mNumberOfSlots;
+    unsigned mNumberOfSessions;
+    BOOL mIsStopped;
+
+    JbSessionTask* mBatch;
+    size_t mBatchCapacity;
+    JbSession* mSessions;
+    size_t mSessionsCapacity;
+    JbMinefield* mSpareMinefields[MaximumSpareMinefields];
+    unsigned mNumberOfSpareMinefields;
+    JbTableIndexList* mAffectedSquares;
+    JbRandom mRandom;
+    volatile unsigned long long mNumberOfMoves;
+}
+
+- (id)initWithManager:(JbSessionManager*)manager
+                index:(unsigned)index
+      numberOfWorkers:(unsigned)workers;
+- (uint32_t)createSessionWithSize:(JbTableSize)size
+                    numberOfMines:(unsigned)mines
+                    usesEasyStart:(BOOL)usesEasyStart
+                             seed:(uint64_t)seed;
+- (void)lockQueue;
+- (void)appendRequest:(const JbSessionRequest*)request;
+- (void)unlockQueue;
+- (unsigned)numberOfSessions;
+- (unsigned long long)numberOfMoves;
+- (void)stop;
+@end
+
+@implementation JbSessionWorker
+
+- (id)initWithManager:(JbSessionManager*)manager
+                index:(unsigned)index
+      numberOfWorkers:(unsigned)workers
+{
+    self = [super init];
+    if (self)
+    {
+        mManager = manager;
+        mIndex = index;
+        mNumberOfWorkers = workers;
+        mCondition = [[NSCondition alloc] init];
+        mQueue = NULL;
+        mQueueCount = 0;
+        mQueueCapacity = 0;
+        mFreeSlots = NULL;
+        mNumberOfFreeSlots = 0;
+        mFreeSlotsCapacity = 0;
+        mNumberOfSlots = 0;
+        mNumberOfSessions = 0;
+        mIsStopped = NO;
+        mBatch = NULL;
+        mBatchCapacity = 0;
+        mSessions = NULL;
+        mSessionsCapacity = 0;
+        mNumberOfSpareMinefields = 0;
+        mAffectedSquares = [[JbTableIndexList alloc] initWithCapacity:64];
+        JbSeedRandom(&mRandom, JbMakeRandomSeed());
+        mNumberOfMoves = 0;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    for (size_t i = 0; i != mSessionsCapacity; ++i)
+        [mSessions[i].minefield release];
+    for (unsigned i = 0; i != mNumberOfSpareMinefields; ++i)
+        [mSpareMinefields[i] release];
+    free(mSessions);
+    free(mBatch);
+    free(mFreeSlots);
+    free(mQueue);
+    [mAffectedSquares release];
+    [mCondition release];
+    [super dealloc];
+}
+
+- (void)appendTask:(const JbSessionTask*)task
+{
+    mQueue = GrowArray(mQueue, &mQueueCapacity, mQueueCount + 1, sizeof(JbSessionTask));
+    mQueue[mQueueCount++] = *task;
+}
+
+- (uint32_t)createSessionWithSize:(JbTableSize)size
+                    numberOfMines:(unsigned)mines
+                    usesEasyStart:(BOOL)usesEasyStart
+                             seed:(uint64_t)seed
+{
+    [mCondition lock];
+    uint32_t slot = mNumberOfFreeSlots != 0 ? mFreeSlots[--mNumberOfFreeSlots]
+                                            : mNumberOfSlots++;
+    ++mNumberOfSessions;
+    JbSessionTask task;
+    task.request.session = slot * mNumberOfWorkers + mIndex;
+    task.request.command = JbSessionNewGame;
+    task.request.index = JbMakeTableIndex(0, 0);
+    task.isCreation = YES;
+    task.size = size;
+    task.numberOfMines = mines;
+    task.usesEasyStart = usesEasyStart;
+    task.seed = seed;
+    [self appendTask:&task];
+    [mCondition broadcast];
+    [mCondition unlock];
+    return task.request.session;
+}
+
+- (void)lockQueue
+{
+    [mCondition lock];
+}
+
+- (void)appendRequest:(const JbSessionRequest*)request
+{
+    JbSessionTask task;
+    memset(&task, 0, sizeof(task));
+    task.request = *request;
+    [self appendTask:&task];
+}
+
+- (void)unlockQueue
+{
+    [mCondition broadcast];
+    [mCondition unlock];
+}
+
+/// Returns a minefield for a new session, from the spare ones if possible.
+- (JbMinefield*)minefieldWithSize:(JbTableSize)size numberOfMines:(unsigned)mines
+{
+    for (unsigned i = 0; i != mNumberOfSpareMinefields; ++i)
+    {
+        JbMinefield* minefield = mSpareMinefields[i];
+        if (JbEqualTableSizes([minefield size], size) && [minefield numberOfMines] == mines)
+        {
+            mSpareMinefields[i] = mSpareMinefields[--mNumberOfSpareMinefields];
+            return minefield;
+        }
+    }
+    return [[JbMinefield alloc] initWithSize:size numberOfMines:mines];
+}
+
+- (void)recycleMinefield:(JbMinefield*)minefield
+{
+    if (mNumberOfSpareMinefields == MaximumSpareMinefields)
+    {
+        [mSpareMinefields[0] release];
+        mSpareMinefields[0] = mSpareMinefields[--mNumberOfSpareMinefields];
+    }
+    mSpareMinefields[mNumberOfSpareMinefields++] = minefield;
+}
+
+- (void)createSession:(const JbSessionTask*)task
+{
+    uint32_t slot = task->request.session / mNumberOfWorkers;
+    size_t oldCapacity = mSessionsCapacity;
+    mSessions = GrowArray(mSessions, &mSessionsCapacity, slot + 1, sizeof(JbSession));
+    memset(mSessions + oldCapacity, 0, (mSessionsCapacity - oldCapacity) * sizeof(JbSession));
+
+    JbSession* session = &mSessions[slot];
+    assert(session->minefield == nil);
+    session->minefield = [self minefieldWithSize:task->size numberOfMines:task->numberOfMines];
+    [session->minefield setUsesEasyStart:task->usesEasyStart];
+    JbSeedRandom(&session->random, task->seed != 0 ? task->seed : JbNextRandom(&mRandom));
+}
+
+- (void)closeSession:(JbSession*)session slot:(uint32_t)slot
+{
+    [self recycleMinefield:session->minefield];
+    session->minefield = nil;
+    [mCondition lock];
+    mFreeSlots = GrowArray(mFreeSlots, &mFreeSlotsCapacity,
+                           mNumberOfFreeSlots + 1, sizeof(uint32_t));
+    mFreeSlots[mNumberOfFreeSlots++] = slot;
+    --mNumberOfSessions;
+    [mCondition unlock];
+}
+
+- (void)handleTask:(const JbSessionTask*)task
+          delegate:(id<JbSessionManagerDelegate>)delegate
+{
+    if (task->isCreation)
+        [self createSession:task];
+
+    const JbSessionRequest* request = &task->request;
+    JbSessionResult result;
+    memset(&result, 0, sizeof(result));
+    result.state = JbNotStarted;
+    [mAffectedSquares removeAllValues];
+
+    uint32_t slot = request->session / mNumberOfWorkers;
+    JbSession* session = slot < mSessionsCapacity ? &mSessions[slot] : NULL;
+    JbMinefield* minefield = session != NULL ? session->minefield : nil;
+    if (minefield != nil)
+    {
+        JbTableSize size = [minefield size];
+        JbMinefieldState state = [minefield state];
+        BOOL isInside = request->index.row < size.rows && request->index.column < size.columns;
+        BOOL isOver = state == JbCompleted || state == JbBlownUp;
+        switch (request->command)
+        {
+        case JbSessionNewGame:
+            [minefield clear];
+            [minefield setSeed:JbNextRandom(&session->random)];
+            session->numberOfMoves = 0;
+            result.isValid = YES;
+            break;
+        case JbSessionUncover:
+            result.isValid = isInside && !isOver;
+            if (result.isValid)
+                [minefield uncoverAt:request->index affectedSquares:mAffectedSquares];
+            break;
+        case JbSessionMark:
+            result.isValid = isInside && !isOver && state != JbNotStarted;
+            if (result.isValid)
+                [minefield markAt:request->index affectedSquares:mAffectedSquares];
+            break;
+        case JbSessionClose:
+            result.isValid = YES;
+            break;
+        }
+        if (result.isValid && request->command != JbSessionNewGame
+            && request->command != JbSessionClose)
+        {
+            ++session->numberOfMoves;
+            ++mNumberOfMoves;
+        }
+        result.state = [minefield state];
+        result.numberOfMoves = session->numberOfMoves;
+        if (request->command == JbSessionClose)
+            [self closeSession:session slot:slot];
+    }
+    result.affectedSquares = [mAffectedSquares begin];
+    result.numberOfAffectedSquares = [mAffectedSquares count];
+    [delegate sessionManager:mManager didHandleRequest:request result:&result];
+}
+
+/// The body of the worker thread.
+/** The worker swaps its queue with an empty batch buffer, so the threads
+    that submit requests can fill the queue while it handles the batch.
+*/
+- (void)runWorker:(id)unused
+{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    id<JbSessionManagerDelegate> delegate = [mManager delegate];
+    [mCondition lock];
+    while (YES)
+    {
+        if (mQueueCount == 0)
+        {
+            if (mIsStopped)
+                break;
+            [mCondition wait];
+            continue;
+        }
+
+        JbSessionTask* batch = mQueue;
+        size_t batchCapacity = mQueueCapacity;
+        size_t count = mQueueCount;
+        mQueue = mBatch;
+        mQueueCapacity = mBatchCapacity;
+        mQueueCount = 0;
+        [mCondition unlock];
+
+        NSAutoreleasePool* batchPool = [[NSAutoreleasePool alloc] init];
+        for (size_t i = 0; i != count; ++i)
+            [self handleTask:&batch[i] delegate:delegate];
+        [batchPool release];
+        mBatch = batch;
+        mBatchCapacity = batchCapacity;
+        [mManager didHandleRequests:count];
+
+        [mCondition lock];
+    }
+    [mCondition unlock];
+    // The manager was retained for the thread when it was started.
+    [mManager release];
+    [pool release];
+}
+
+- (unsigned)numberOfSessions
+{
+    [mCondition lock];
+    unsigned count = mNumberOfSessions;
+    [mCondition unlock];
+    return count;
+}
+
+- (unsigned long long)numberOfMoves
+{
+    return mNumberOfMoves;
+}
+
+- (void)stop
+{
+    [mCondition lock];
+    mIsStopped = YES;
+    [mCondition broadcast];
+    [mCondition unlock];
+}
+
+@end
+
+@implementation JbSessionManager
+
+- (id)initWithNumberOfThreads:(unsigned)threads
+{
+    self = [super init];
+    if (self)
+    {
+        if (threads == 0)
+            threads = MAX((unsigned)[[NSProcessInfo processInfo] activeProcessorCount], 1u);
+        mWorkers = malloc(threads * sizeof(JbSessionWorker*));
+        NSAssert(mWorkers != NULL, @"Unable to allocate memory for the workers");
+        mNumberOfWorkers = threads;
+        for (unsigned i = 0; i != threads; ++i)
+            mWorkers[i] = [[JbSessionWorker alloc] initWithManager:self
+                                                             index:i
+                                                   numberOfWorkers:threads];
+        mDelegate = nil;
+        mIdleCondition = [[NSCondition alloc] init];
+        mNextWorker = 0;
+        mNumberOfSubmittedRequests = 0;
+        mNumberOfHandledRequests = 0;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    for (unsigned i = 0; i != mNumberOfWorkers; ++i)
+        [mWorkers[i] release];
+    free(mWorkers);
+    [mIdleCondition release];
+    [super dealloc];
+}
+
+- (unsigned)numberOfThreads
+{
+    return mNumberOfWorkers;
+}
+
+- (id<JbSessionManagerDelegate>)delegate
+{
+    return mDelegate;
+}
+
+- (void)setDelegate:(id<JbSessionManagerDelegate>)delegate
+{
+    BOOL isFirst = mDelegate == nil;
+    mDelegate = delegate;
+    // The workers are started when they have a delegate to report to.
+    if (isFirst && delegate != nil)
+    {
+        for (unsigned i = 0; i != mNumberOfWorkers; ++i)
+        {
+            [self retain];
+            [NSThread detachNewThreadSelector:@selector(runWorker:)
+                                     toTarget:mWorkers[i]
+                                   withObject:nil];
+        }
+    }
+}
+
+- (uint32_t)createSessionWithSize:(JbTableSize)size
+                    numberOfMines:(unsigned)mines
+                    usesEasyStart:(BOOL)usesEasyStart
+                             seed:(uint64_t)seed
+{
+    size_t squares = (size_t)size.rows * size.columns;
+    if (size.rows == 0 || size.columns == 0
+        || (size_t)mines + (usesEasyStart ? 9 : 1) >= squares)
+        return JbInvalidSessionId;
+
+    __sync_add_and_fetch(&mNumberOfSubmittedRequests, 1);
+    unsigned index = __sync_fetch_and_add(&mNextWorker, 1) % mNumberOfWorkers;
+    return [mWorkers[index] createSessionWithSize:size
+                                    numberOfMines:mines
+                                    usesEasyStart:usesEasyStart
+                                             seed:seed];
+}
+
+- (void)submitRequest:(JbSessionRequest)request
+{
+    [self submitRequests:&request count:1];
+}
+
+- (void)submitRequests:(const JbSessionRequest*)requests count:(size_t)count
+{
+    __sync_add_and_fetch(&mNumberOfSubmittedRequests, count);
+    for (unsigned w = 0; w != mNumberOfWorkers; ++w)
+    {
+        BOOL isLocked = NO;
+        for (size_t i = 0; i != count; ++i)
+        {
+            if (requests[i].session % mNumberOfWorkers != w)
+                continue;
+            if (!isLocked)
+            {
+                [mWorkers[w] lockQueue];
+                isLocked = YES;
+            }
+            [mWorkers[w] appendRequest:&requests[i]];
+        }
+        if (isLocked)
+            [mWorkers[w] unlockQueue];
+    }
+}
+
+- (void)didHandleRequests:(size_t)count
+{
+    // The requests the delegate submitted while these were handled have
+    // already been counted as submitted.
+    if (__sync_add_and_fetch(&mNumberOfHandledRequests, count) == mNumberOfSubmittedRequests)
+    {
+        [mIdleCondition lock];
+        [mIdleCondition broadcast];
+        [mIdleCondition unlock];
+    }
+}
+
+- (void)waitUntilIdle
+{
+    [mIdleCondition lock];
+    while (mNumberOfHandledRequests != mNumberOfSubmittedRequests)
+        [mIdleCondition wait];
+    [mIdleCondition unlock];
+}
+
+- (unsigned)numberOfSessions
+{
+    unsigned count = 0;
+    for (unsigned i = 0; i != mNumberOfWorkers; ++i)
+        count += [mWorkers[i] numberOfSessions];
+    return count;
+}
+
+- (unsigned long long)numberOfMoves
+{
+    unsigned long long count = 0;
+    for (unsigned i = 0; i != mNumberOfWorkers; ++i)
+        count += [mWorkers[i] numberOfMoves];
+    return count;
+}
+
+- (void)stop
+{
+    for (unsigned i = 0; i != mNumberOfWorkers; ++i)
+        [mWorkers[i] stop];
+}
+
+@end
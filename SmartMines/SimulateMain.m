@@ -0,0 +1,324 @@
+//
+//  SimulateMain.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+/// Command line driver for JbSimulation.
+/** Plays a number of games of each configuration with the auto-player on
+    all processors and prints a summary line per configuration, as CSV or
+    JSON. The configurations are all the combinations of the game sizes
+    (-g), the mine densities of sizes given without a number of mines (-d),
+    and the easy start and smart rule settings (-E and -M).
+*/
+
+#import <Foundation/Foundation.h>
+#import <math.h>
+#import <stdio.h>
+#import <stdlib.h>
+#import <string.h>
+#import <unistd.h>
+
+#import "Game.h"
+#import "Random.h"
+#import "Simulation.h"
+
+enum {MaximumConfigurations = 1024};
+enum {OffSetting = 1, OnSetting = 2, BothSettings = OffSetting | OnSetting};
+
+static void PrintUsage(const char* program)
+{
+    fprintf(stderr,
+            "usage: %s [-g ROWSxCOLUMNS[xMINES]]... [-d PERCENT,...] [-E on|off|both]\n"
+            "          [-M on|off|both] [-n GAMES] [-s SEED] [-t THREADS] [-f csv|json] [-o FILE]\n"
+            "  -g  game size, may be repeated (default 16x30x99)\n"
+            "  -d  mine densities in percent for the sizes without mines\n"
+            "  -E  easy start (default on)\n"
+            "  -M  smart uncover and smart mark (default on)\n"
+            "  -n  number of games per configuration (default 10000)\n"
+            "  -s  seed that the seeds of the individual games are derived from\n"
+            "  -t  number of threads (default the number of processors)\n"
+            "  -f  output format (default csv)\n"
+            "  -o  write the summary to FILE instead of stdout\n",
+            program);
+}
+
+/// Parses "on", "off" or "both".
+static int ParseSetting(const char* text)
+{
+    if (strcmp(text, "on") == 0)
+        return OnSetting;
+    if (strcmp(text, "off") == 0)
+        return OffSetting;
+    if (strcmp(text, "both") == 0)
+        return BothSettings;
+    return 0;
+}
+
+/// Adds the configurations of the size in @a description to
+/// @a configurations.
+/** @return NO if the description or one of the densities is invalid.
+*/
+static BOOL AddConfigurations(const char* description,
+                              const double* densities,
+                              unsigned numberOfDensities,
+                              int easyStartSettings,
+                              int smartRuleSettings,
+                              JbSimulationConfiguration* configurations,
+                              unsigned* count)
+{
+    unsigned rows, columns, mines;
+    char extra;
+    unsigned mineCounts[64];
+    unsigned numberOfMineCounts = 0;
+    int fields = sscanf(description, "%ux%ux%u%c", &rows, &columns, &mines, &extra);
+    if (fields == 3)
+    {
+        mineCounts[numberOfMineCounts++] = mines;
+    }
+    else if (sscanf(description, "%ux%u%c", &rows, &columns, &extra) == 2
+             && numberOfDensities != 0)
+    {
+        for (unsigned i = 0; i != numberOfDensities; ++i)
+            mineCounts[numberOfMineCounts++] = (unsigned)lround(rows * columns * densities[i] / 100);
+    }
+    else
+    {
+        return NO;
+    }
+
+    JbTableSize size = JbMakeTableSize(rows, columns);
+    for (unsigned i = 0; i != numberOfMineCounts; ++i)
+    {
+        if (![JbGame isValidGameSize:size mines:mineCounts[i]])
+            return NO;
+        for (int easyStart = OffSetting; easyStart <= OnSetting; easyStart <<= 1)
+        {
+            for (int smartRules = OffSetting; smartRules <= OnSetting; smartRules <<= 1)
+            {
+                if (!(easyStartSettings & easyStart) || !(smartRuleSettings & smartRules))
+                    continue;
+                if (*count == MaximumConfigurations)
+                    return NO;
+                configurations[(*count)++] = JbMakeSimulationConfiguration(
+                        size, mineCounts[i], easyStart == OnSetting, smartRules == OnSetting);
+            }
+        }
+    }
+    return YES;
+}
+
+/// Parses a comma-separated list of up to 64 percentages.
+static unsigned ParseDensities(const char* text, double* densities)
+{
+    unsigned count = 0;
+    while (*text != '\0' && count != 64)
+    {
+        char* end;
+        double density = strtod(text, &end);
+        if (end == text || density <= 0 || density >= 100)
+            return 0;
+        densities[count++] = density;
+        if (*end == ',')
+            ++end;
+        else if (*end != '\0')
+            return 0;
+        text = end;
+    }
+    return count;
+}
+
+static void PrintResults(FILE* file,
+                         BOOL isJson,
+                         BOOL isFirst,
+                         JbSimulation* simulation)
+{
+    JbSimulationConfiguration configuration = [simulation configuration];
+    JbSimulationResults results = [simulation results];
+    double games = results.games != 0 ? (double)results.games : 1;
+    double meanSeconds = results.seconds / games;
+    double variance = results.secondsSquared / games - meanSeconds * meanSeconds;
+    double wallSeconds = [simulation wallSeconds];
+    unsigned squares = configuration.size.rows * configuration.size.columns;
+    if (isJson)
+    {
+        fprintf(file,
+                "%s\n  {\"rows\": %u, \"columns\": %u, \"mines\": %u, \"density\": %.4f,"
+                " \"easy_start\": %s, \"smart_rules\": %s, \"games\": %llu,"
+                " \"won\": %llu, \"lost\": %llu, \"win_rate\": %.6f,"
+                " \"won_without_guessing\": %llu, \"guesses_per_game\": %.4f,"
+                " \"clicks_per_game\": %.4f, \"efficient_clicks_per_game\": %.4f,"
+                " \"mean_ms\": %.6f, \"stddev_ms\": %.6f, \"max_ms\": %.6f,"
+                " \"wall_seconds\": %.3f, \"games_per_second\": %.1f}",
+                isFirst ? "" : ",",
+                configuration.size.rows, configuration.size.columns,
+                configuration.numberOfMines,
+                (double)configuration.numberOfMines / squares,
+                configuration.usesEasyStart ? "true" : "false",
+                configuration.usesSmartRules ? "true" : "false",
+                results.games, results.won, results.lost, results.won / games,
+                results.wonWithoutGuessing, results.guesses / games,
+                results.clicks / games, results.efficientClicks / games,
+                meanSeconds * 1000, sqrt(MAX(variance, 0.0)) * 1000,
+                results.maximumSeconds * 1000,
+                wallSeconds, wallSeconds > 0 ? results.games / wallSeconds : 0.0);
+    }
+    else
+    {
+        if (isFirst)
+            fprintf(file, "rows,columns,mines,density,easy_start,smart_rules,games,won,lost,"
+                          "win_rate,won_without_guessing,guesses_per_game,clicks_per_game,"
+                          "efficient_clicks_per_game,mean_ms,stddev_ms,max_ms,"
+                          "wall_seconds,games_per_second\n");
+        fprintf(file,
+                "%u,%u,%u,%.4f,%d,%d,%llu,%llu,%llu,%.6f,%llu,%.4f,%.4f,%.4f,"
+                "%.6f,%.6f,%.6f,%.3f,%.1f\n",
+                configuration.size.rows, configuration.size.columns,
+                configuration.numberOfMines,
+                (double)configuration.numberOfMines / squares,
+                configuration.usesEasyStart ? 1 : 0,
+                configuration.usesSmartRules ? 1 : 0,
+                results.games, results.won, results.lost, results.won / games,
+                results.wonWithoutGuessing, results.guesses / games,
+                results.clicks / games, results.efficientClicks / games,
+                meanSeconds * 1000, sqrt(MAX(variance, 0.0)) * 1000,
+                results.maximumSeconds * 1000,
+                wallSeconds, wallSeconds > 0 ? results.games / wallSeconds : 0.0);
+    }
+    fflush(file);
+}
+
+int main(int argc, char* argv[])
+{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    const char* descriptions[MaximumConfigurations];
+    unsigned numberOfDescriptions = 0;
+    double densities[64];
+    unsigned numberOfDensities = 0;
+    int easyStartSettings = OnSetting;
+    int smartRuleSettings = OnSetting;
+    unsigned long long games = 10000;
+    uint64_t seed = JbMakeRandomSeed();
+    unsigned threads = 0;
+    BOOL isJson = NO;
+    const char* outputFileName = NULL;
+
+    int option;
+    BOOL isValid = YES;
+    while (isValid && (option = getopt(argc, argv, "g:d:E:M:n:s:t:f:o:")) != -1)
+    {
+        switch (option)
+        {
+        case 'g':
+            isValid = numberOfDescriptions != MaximumConfigurations;
+            if (isValid)
+                descriptions[numberOfDescriptions++] = optarg;
+            break;
+        case 'd':
+            numberOfDensities = ParseDensities(optarg, densities);
+            isValid = numberOfDensities != 0;
+            break;
+        case 'E': easyStartSettings = ParseSetting(optarg); isValid = easyStartSettings != 0; break;
+        case 'M': smartRuleSettings = ParseSetting(optarg); isValid = smartRuleSettings != 0; break;
+        case 'n': games = strtoull(optarg, NULL, 10); break;
+        case 's': seed = strtoull(optarg, NULL, 10); break;
+        case 't': threads = (unsigned)strtoul(optarg, NULL, 10); isValid = threads != 0; break;
+        case 'f':
+            isJson = strcmp(optarg, "json") == 0;
+            isValid = isJson || strcmp(optarg, "csv") == 0;
+            break;
+        case 'o': outputFileName = optarg; break;
+        default: isValid = NO; break;
+        }
+    }
+    if (!isValid || optind != argc)
+    {
+        PrintUsage(argv[0]);
+        [pool release];
+        return 1;
+    }
+    if (numberOfDescriptions == 0)
+        descriptions[numberOfDescriptions++] = "16x30x99";
+
+    JbSimulationConfiguration* configurations =
+            malloc(MaximumConfigurations * sizeof(JbSimulationConfiguration));
+    NSCAssert(configurations != NULL, @"Unable to allocate memory for the configurations");
+    unsigned numberOfConfigurations = 0;
+    for (unsigned i = 0; i != numberOfDescriptions; ++i)
+    {
+        if (!AddConfigurations(descriptions[i], densities, numberOfDensities,
+                               easyStartSettings, smartRuleSettings,
+                               configurations, &numberOfConfigurations))
+        {
+            fprintf(stderr, "%s: invalid game size: %s\n", argv[0], descriptions[i]);
+            free(configurations);
+            [pool release];
+            return 1;
+        }
+    }
+
+    FILE* file = stdout;
+    if (outputFileName != NULL)
+    {
+        file = fopen(outputFileName, "w");
+        if (file == NULL)
+        {
+            fprintf(stderr, "%s: can't create %s\n", argv[0], outputFileName);
+            free(configurations);
+            [pool release];
+            return 1;
+        }
+    }
+
+    if (isJson)
+        fprintf(file, "[");
+    for (unsigned i = 0; i != numberOfConfigurations; ++i)
+    {
+        NSAutoreleasePool* configurationPool = [[NSAutoreleasePool alloc] init];
+        JbSimulation* simulation = [[[JbSimulation alloc]
+                                        initWithConfiguration:configurations[i]
+                                                numberOfGames:games
+                                                     baseSeed:seed] autorelease];
+        if (threads != 0)
+            [simulation setNumberOfThreads:threads];
+        [simulation run];
+        PrintResults(file, isJson, i == 0, simulation);
+        [configurationPool release];
+    }
+    if (isJson)
+        fprintf(file, "\n]\n");
+
+    BOOL success = YES;
+    if (file != stdout && fclose(file) != 0)
+    {
+        fprintf(stderr, "%s: can't write %s\n", argv[0], outputFileName);
+        success = NO;
+    }
+    free(configurations);
+    [pool release];
+    return success ? 0 : 1;
+}
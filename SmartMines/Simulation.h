@@ -0,0 +1,120 @@
+//
+//  Simulation.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+#import "Table.h"
+
+/// The rules of the games in a simulation.
+typedef struct JbSimulationConfigurationStruct
+{
+    JbTableSize size;
+    unsigned numberOfMines;
+    BOOL usesEasyStart;
+    /// Smart uncover and smart mark. They don't change how the auto-player
+    /// plays, but which of the 3BV and the ZiNi is the least number of
+    /// clicks a player needs.
+    BOOL usesSmartRules;
+} JbSimulationConfiguration;
+
+JbSimulationConfiguration JbMakeSimulationConfiguration(JbTableSize size,
+                                                        unsigned mines,
+                                                        BOOL usesEasyStart,
+                                                        BOOL usesSmartRules);
+
+/// The sums over all the games of a simulation.
+typedef struct JbSimulationResultsStruct
+{
+    unsigned long long games;
+    unsigned long long won;
+    unsigned long long lost;
+    /// The number of games that were won without guessing.
+    unsigned long long wonWithoutGuessing;
+    /// The number of times the auto-player had to guess, not counting the
+    /// first click.
+    unsigned long long guesses;
+    /// The auto-player's clicks: the first click, the guesses and the squares
+    /// the solver uncovered.
+    unsigned long long clicks;
+    /// The least number of clicks a player needs with the configuration's
+    /// rules: the 3BV, or the ZiNi with smart rules.
+    unsigned long long efficientClicks;
+    /// The time spent on the games, summed over the worker threads.
+    double seconds;
+    double secondsSquared;
+    double maximumSeconds;
+} JbSimulationResults;
+
+/// Plays many games with the same configuration on all the processors to
+/// measure how hard it is.
+/** Every game is played by an auto-player that uncovers the centre square,
+    lets JbMinefieldSolver uncover everything it can deduce, and guesses
+    the square least likely to have a mine when the solver is stuck.
+
+    Game number n gets a seed derived from the base seed and n, so the
+    results only depend on the base seed and the number of games, not on
+    the number of threads. The workers take the games in chunks from a
+    shared counter, and every worker adds its games to accumulators of its
+    own, on a cache line of their own, so the workers never wait for each
+    other or share a written cache line. The accumulators are added
+    together when all the workers are done.
+*/
+@interface JbSimulation : NSObject
+{
+    JbSimulationConfiguration mConfiguration;
+    unsigned long long mNumberOfGames;
+    uint64_t mBaseSeed;
+    unsigned mNumberOfThreads;
+    NSCondition* mCondition;
+    unsigned mRunningThreads;
+    unsigned mNextWorker;
+    volatile unsigned long long mNextGame;
+    JbSimulationResults* mWorkerResults;
+    JbSimulationResults mResults;
+    double mWallSeconds;
+}
+
+- (id)initWithConfiguration:(JbSimulationConfiguration)configuration
+              numberOfGames:(unsigned long long)games
+                   baseSeed:(uint64_t)baseSeed;
+
+- (JbSimulationConfiguration)configuration;
+- (unsigned long long)numberOfGames;
+
+/// The number of worker threads. The default is the number of processors.
+- (unsigned)numberOfThreads;
+- (void)setNumberOfThreads:(unsigned)threads;
+
+/// Plays all the games, and blocks until they are done.
+- (void)run;
+
+- (JbSimulationResults)results;
+/// The time run took.
+- (double)wallSeconds;
+@end
@@ -0,0 +1,294 @@
+//
+//  Simulation.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "Simulation.h"
+#import <assert.h>
+#import <stdlib.h>
+#import <string.h>
+#import "Minefield.h"
+#import "MinefieldSolver.h"
+#import "Random.h"
+#import "Stopwatch.h"
+#import "TableIndexList.h"
+
+/// The number of games a worker takes from the shared counter at a time.
+enum {GamesPerChunk = 64};
+
+/// The accumulators of each worker are aligned to this, so no two workers
+/// write to the same cache line.
+enum {CacheLineSize = 64};
+
+/// The size of each worker's accumulators, rounded up to whole cache lines.
+static size_t WorkerResultsStride(void)
+{
+    return (sizeof(JbSimulationResults) + CacheLineSize - 1)
+           / CacheLineSize * CacheLineSize;
+}
+
+static JbSimulationResults* GetWorkerResults(JbSimulationResults* results,
+                                             unsigned worker)
+{
+    return (JbSimulationResults*)((uint8_t*)results + worker * WorkerResultsStride());
+}
+
+/// Returns the seed of game number @a game.
+static uint64_t GameSeed(uint64_t baseSeed, unsigned long long game)
+{
+    JbRandom random;
+    JbSeedRandom(&random, baseSeed + game * 0x9E3779B97F4A7C15ULL);
+    return JbNextRandom(&random);
+}
+
+static void AddResults(JbSimulationResults* sum, const JbSimulationResults* results)
+{
+    sum->games += results->games;
+    sum->won += results->won;
+    sum->lost += results->lost;
+    sum->wonWithoutGuessing += results->wonWithoutGuessing;
+    sum->guesses += results->guesses;
+    sum->clicks += results->clicks;
+    sum->efficientClicks += results->efficientClicks;
+    sum->seconds += results->seconds;
+    sum->secondsSquared += results->secondsSquared;
+    sum->maximumSeconds = MAX(sum->maximumSeconds, results->maximumSeconds);
+}
+
+JbSimulationConfiguration JbMakeSimulationConfiguration(JbTableSize size,
+                                                        unsigned mines,
+                                                        BOOL usesEasyStart,
+                                                        BOOL usesSmartRules)
+{
+    JbSimulationConfiguration configuration;
+    configuration.size = size;
+    configuration.numberOfMines = mines;
+    configuration.usesEasyStart = usesEasyStart;
+    configuration.usesSmartRules = usesSmartRules;
+    return configuration;
+}
+
+@implementation JbSimulation
+
+- (id)initWithConfiguration:(JbSimulationConfiguration)configuration
+              numberOfGames:(unsigned long long)games
+                   baseSeed:(uint64_t)baseSeed
+{
+    self = [super init];
+    if (self)
+    {
+        mConfiguration = configuration;
+        mNumberOfGames = games;
+        mBaseSeed = baseSeed;
+        mNumberOfThreads = MAX((unsigned)[[NSProcessInfo processInfo] activeProcessorCount], 1u);
+        mCondition = [[NSCondition alloc] init];
+        mRunningThreads = 0;
+        mNextWorker = 0;
+        mNextGame = 0;
+        mWorkerResults = NULL;
+        memset(&mResults, 0, sizeof(mResults));
+        mWallSeconds = 0;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(mWorkerResults);
+    [mCondition release];
+    [super dealloc];
+}
+
+- (JbSimulationConfiguration)configuration
+{
+    return mConfiguration;
+}
+
+- (unsigned long long)numberOfGames
+{
+    return mNumberOfGames;
+}
+
+- (unsigned)numberOfThreads
+{
+    return mNumberOfThreads;
+}
+
+- (void)setNumberOfThreads:(unsigned)threads
+{
+    assert(threads != 0);
+    mNumberOfThreads = threads;
+}
+
+/// Plays game number @a game and adds it to @a results.
+- (void)playGame:(unsigned long long)game
+     onMinefield:(JbMinefield*)minefield
+          solver:(JbMinefieldSolver*)solver
+        affected:(JbTableIndexList*)affected
+         results:(JbSimulationResults*)results
+{
+    JbTableSize size = mConfiguration.size;
+    [minefield clear];
+    [minefield setSeed:GameSeed(mBaseSeed, game)];
+    [solver clear];
+    unsigned long long solverMoves = [solver numberOfMoves];
+    unsigned guesses = 0;
+    JbTableIndex idx = JbMakeTableIndex(size.rows / 2, size.columns / 2);
+    while (YES)
+    {
+        [affected removeAllValues];
+        [minefield uncoverAt:idx affectedSquares:affected];
+        if ([minefield state] != JbNotCompleted)
+            break;
+        [solver addUncoveredSquares:affected ofMinefield:minefield];
+        if ([solver solveMinefield:minefield] || [minefield state] != JbNotCompleted)
+            break;
+        [[solver mineSquares] removeAllValues];
+        idx = [solver guessSquareOfMinefield:minefield];
+        ++guesses;
+    }
+
+    JbMinefieldMetrics metrics = [minefield metrics];
+    ++results->games;
+    if ([minefield state] == JbCompleted)
+    {
+        ++results->won;
+        if (guesses == 0)
+            ++results->wonWithoutGuessing;
+    }
+    else
+    {
+        ++results->lost;
+    }
+    results->guesses += guesses;
+    results->clicks += 1 + guesses + ([solver numberOfMoves] - solverMoves);
+    results->efficientClicks += mConfiguration.usesSmartRules ? metrics.zini : metrics.bbbv;
+}
+
+/// The body of each worker thread.
+/** Every worker has its own minefield, solver and list of affected squares,
+    and reuses them for all its games.
+*/
+- (void)runWorker:(id)unused
+{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    [mCondition lock];
+    JbSimulationResults* results = GetWorkerResults(mWorkerResults, mNextWorker++);
+    [mCondition unlock];
+
+    JbTableSize size = mConfiguration.size;
+    unsigned mines = mConfiguration.numberOfMines;
+    JbMinefield* minefield = [[JbMinefield alloc] initWithSize:size numberOfMines:mines];
+    [minefield setUsesEasyStart:mConfiguration.usesEasyStart];
+    [minefield setUsesSmartUncover:mConfiguration.usesSmartRules];
+    [minefield setUsesSmartMark:mConfiguration.usesSmartRules];
+    JbMinefieldSolver* solver = [[JbMinefieldSolver alloc] initWithSize:size
+                                                          numberOfMines:mines];
+    JbTableIndexList* affected = [[JbTableIndexList alloc] initWithCapacity:64];
+    JbStopwatch* stopwatch = [[JbStopwatch alloc] init];
+    while (YES)
+    {
+        unsigned long long first = __sync_fetch_and_add(&mNextGame, GamesPerChunk);
+        if (first >= mNumberOfGames)
+            break;
+        unsigned long long last = MIN(first + GamesPerChunk, mNumberOfGames);
+        for (unsigned long long game = first; game != last; ++game)
+        {
+            [stopwatch reset];
+            [stopwatch start];
+            [self playGame:game
+               onMinefield:minefield
+                    solver:solver
+                  affected:affected
+                   results:results];
+            double seconds = [stopwatch stop];
+            results->seconds += seconds;
+            results->secondsSquared += seconds * seconds;
+            results->maximumSeconds = MAX(results->maximumSeconds, seconds);
+        }
+    }
+    [stopwatch release];
+    [affected release];
+    [solver release];
+    [minefield release];
+
+    [mCondition lock];
+    --mRunningThreads;
+    [mCondition signal];
+    [mCondition unlock];
+    [pool release];
+}
+
+- (void)run
+{
+    assert(mRunningThreads == 0);
+    JbStopwatch* stopwatch = [[JbStopwatch alloc] init];
+    [stopwatch start];
+
+    free(mWorkerResults);
+    mWorkerResults = NULL;
+    if (posix_memalign((void**)&mWorkerResults, CacheLineSize,
+                       mNumberOfThreads * WorkerResultsStride()) != 0)
+        mWorkerResults = NULL;
+    NSAssert(mWorkerResults != NULL, @"Unable to allocate memory for the simulation");
+    memset(mWorkerResults, 0, mNumberOfThreads * WorkerResultsStride());
+    mNextWorker = 0;
+    mNextGame = 0;
+
+    [mCondition lock];
+    mRunningThreads = mNumberOfThreads;
+    [mCondition unlock];
+    for (unsigned i = 0; i != mNumberOfThreads; ++i)
+        [NSThread detachNewThreadSelector:@selector(runWorker:)
+                                 toTarget:self
+                               withObject:nil];
+
+    [mCondition lock];
+    while (mRunningThreads != 0)
+        [mCondition wait];
+    [mCondition unlock];
+
+    memset(&mResults, 0, sizeof(mResults));
+    for (unsigned i = 0; i != mNumberOfThreads; ++i)
+        AddResults(&mResults, GetWorkerResults(mWorkerResults, i));
+
+    mWallSeconds = [stopwatch stop];
+    [stopwatch release];
+}
+
+- (JbSimulationResults)results
+{
+    return mResults;
+}
+
+- (double)wallSeconds
+{
+    return mWallSeconds;
+}
+
+@end
@@ -28,7 +28,7 @@
 //  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 //  OTHER DEALINGS IN THE SOFTWARE.
 
-#import <Cocoa/Cocoa.h>
+#import <Foundation/Foundation.h>
 
 @interface JbStopwatch : NSObject
 {
@@ -38,6 +38,8 @@
 - (void)start;
 - (double)stop;
 - (void)reset;
+/// Stops the stopwatch and sets its time to @a seconds.
+- (void)resetToSeconds:(double)seconds;
 - (double)seconds;
 - (BOOL)isMeasuring;
 @end
@@ -66,6 +66,12 @@ static double GetCurrentTime(void);
     mCurrentStartTime = mAccumulatedSeconds = 0.0;
 }
 
+- (void)resetToSeconds:(double)seconds
+{
+    mCurrentStartTime = 0.0;
+    mAccumulatedSeconds = seconds;
+}
+
 - (double)seconds
 {
     if (mCurrentStartTime == 0.0)
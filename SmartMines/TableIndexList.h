@@ -34,8 +34,15 @@
 #import <stddef.h>
 #import <Foundation/NSObject.h>
 
+/// Something squares can be added to, such as the squares affected by a
+/// move.
+@protocol JbTableIndexCollector <NSObject>
+- (void)addValue:(JbTableIndex)value;
+- (void)addValues:(const JbTableIndex*)values count:(size_t)count;
+@end
+
 /// JbTableIndexList is a growable list (array) of JbTableIndex values.
-@interface JbTableIndexList : NSObject <NSCopying>
+@interface JbTableIndexList : NSObject <NSCopying, JbTableIndexCollector>
 {
 @private
     JbTableIndex* mList;
@@ -76,6 +83,12 @@
 */
 - (void)addValue:(JbTableIndex)value;
 
+/// Appends @a count values from @a values to the list.
+/** The capacity is increased at most once, no matter how many values are
+    appended.
+*/
+- (void)addValues:(const JbTableIndex*)values count:(size_t)count;
+
 /// Returns a pointer to the first element in the list.
 /** The rest of the elements in the list are accessed through
     the index operator or by using a the pointer as pointer as
@@ -102,6 +115,9 @@
 */
 - (void)removeAllValues;
 
+/// Removes the last value in the list.
+- (void)removeLastValue;
+
 /// Replaces the current value at @a index with @a value.
 - (void)setValue:(JbTableIndex)value atIndex:(size_t)index;
 
@@ -136,6 +136,27 @@
     return;
 }
 
+- (void)addValues:(const JbTableIndex*)values count:(size_t)count
+{
+    if (count == 0)
+        return;
+
+    if (mCount + count > mCapacity)
+    {
+        size_t newCapacity = (mCapacity * 3 + 1) / 2;
+        if (newCapacity < mCount + count)
+            newCapacity = mCount + count;
+        JbTableIndex* newList = realloc(mList, newCapacity * sizeof(JbTableIndex));
+        if (newList == NULL)
+            return;
+        mList = newList;
+        mCapacity = newCapacity;
+    }
+
+    memcpy(&mList[mCount], values, count * sizeof(JbTableIndex));
+    mCount += count;
+}
+
 - (JbTableIndex*)begin
 {
     return mList;
@@ -162,6 +183,12 @@
     mCount = 0;
 }
 
+- (void)removeLastValue
+{
+    assert(mCount != 0);
+    --mCount;
+}
+
 - (void)setValue:(JbTableIndex)value atIndex:(size_t)index
 {
     assert(index < mCount);
@@ -63,4 +63,20 @@
     [list release];
 }
 
+- (void)testRemoveLastValue
+{
+    JbTableIndexList* list = [[JbTableIndexList alloc] initWithCapacity:2];
+    [list addValue:JbMakeTableIndex(1, 2)];
+    [list addValue:JbMakeTableIndex(3, 4)];
+    [list removeLastValue];
+    STAssertTrue([list count] == 1,
+                 @"Size check failed (reported size = %d)", [list count]);
+    STAssertTrue([list valueAtIndex:0].row == 1 && [list valueAtIndex:0].column == 2,
+                 @"The wrong value was removed");
+    [list addValue:JbMakeTableIndex(5, 6)];
+    STAssertTrue([list valueAtIndex:1].row == 5 && [list valueAtIndex:1].column == 6,
+                 @"Value retrieved from list is not the same as the one appended to it");
+    [list release];
+}
+
 @end
@@ -0,0 +1,114 @@
+//
+//  TableSpanList.h
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import <stddef.h>
+#import <Foundation/NSObject.h>
+#import "Table.h"
+#import "TableIndexList.h"
+
+/// The squares from columnBegin up to, but not including, columnEnd in
+/// a row.
+typedef struct JbTableSpanStruct
+{
+    unsigned row;
+    unsigned columnBegin;
+    unsigned columnEnd;
+} JbTableSpan;
+
+JbTableSpan JbMakeTableSpan(unsigned row, unsigned columnBegin, unsigned columnEnd);
+
+/// A set of squares stored as runs of adjacent squares in the same row.
+/** Squares that are added next to the end of the last span extend it, so
+    squares added in row order, like the squares of an opening, take 12
+    bytes per run instead of 8 bytes per square. Squares added in any other
+    order start new spans until normalize sorts them into row order and
+    joins the ones that touch.
+
+    The list also keeps the bounding rectangle of its squares.
+*/
+@interface JbTableSpanList : NSObject <JbTableIndexCollector>
+{
+@private
+    JbTableSpan* mList;
+    size_t mCapacity;
+    size_t mCount;
+    size_t mNumberOfSquares;
+    unsigned mRowBegin;
+    unsigned mRowEnd;
+    unsigned mColumnBegin;
+    unsigned mColumnEnd;
+    BOOL mIsNormalized;
+}
+/// Create a new auto-released list with initial capacity of 0.
++ (JbTableSpanList*)list;
+
+/// Create a new auto-released list with room for @a capacity spans.
++ (JbTableSpanList*)listWithCapacity:(size_t)capacity;
+
+- (id)initWithCapacity:(size_t)capacity;
+
+/// Adds the square at @a value, extending the last span if it is the
+/// square after it.
+- (void)addValue:(JbTableIndex)value;
+
+/// Adds @a count squares from @a values.
+- (void)addValues:(const JbTableIndex*)values count:(size_t)count;
+
+/// Adds the squares in @a span, extending the last span if they follow
+/// it. @a span must not be empty.
+- (void)addSpan:(JbTableSpan)span;
+
+/// Sorts the spans in row order and joins the ones that touch or overlap.
+/** Does nothing if the squares were added in row order.
+*/
+- (void)normalize;
+
+/// Returns a pointer to the first span.
+- (JbTableSpan*)begin;
+
+/// Returns a pointer to the span after the last one.
+- (JbTableSpan*)end;
+
+/// Returns the number of spans.
+- (size_t)count;
+
+/// Returns the number of squares in all the spans.
+/** Squares that have been added more than once are counted once for every
+    time until normalize has been called.
+*/
+- (size_t)numberOfSquares;
+
+/// Returns the smallest rectangle that contains all the squares, or an
+/// empty rectangle if there are none.
+- (JbTableRect)bounds;
+
+/// Removes all the spans, but keeps the memory.
+- (void)removeAllValues;
+@end
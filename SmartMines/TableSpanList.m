@@ -0,0 +1,216 @@
+//
+//  TableSpanList.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "TableSpanList.h"
+
+#import <assert.h>
+#import <stdlib.h>
+#import <string.h>
+
+JbTableSpan JbMakeTableSpan(unsigned row, unsigned columnBegin, unsigned columnEnd)
+{
+    JbTableSpan span = {row, columnBegin, columnEnd};
+    return span;
+}
+
+static int CompareSpans(const void* a, const void* b)
+{
+    const JbTableSpan* spanA = (const JbTableSpan*)a;
+    const JbTableSpan* spanB = (const JbTableSpan*)b;
+    if (spanA->row != spanB->row)
+        return spanA->row < spanB->row ? -1 : 1;
+    if (spanA->columnBegin != spanB->columnBegin)
+        return spanA->columnBegin < spanB->columnBegin ? -1 : 1;
+    return 0;
+}
+
+@implementation JbTableSpanList
+
++ (JbTableSpanList*)list
+{
+    return [[[JbTableSpanList alloc] init] autorelease];
+}
+
++ (JbTableSpanList*)listWithCapacity:(size_t)capacity
+{
+    return [[[JbTableSpanList alloc] initWithCapacity:capacity] autorelease];
+}
+
+- (id)init
+{
+    self = [super init];
+    if (self)
+    {
+        mList = NULL;
+        mCapacity = 0;
+        [self removeAllValues];
+    }
+    return self;
+}
+
+- (id)initWithCapacity:(size_t)capacity
+{
+    self = [self init];
+    if (self && capacity != 0)
+    {
+        mCapacity = capacity;
+        mList = (JbTableSpan*)malloc(capacity * sizeof(JbTableSpan));
+        assert(mList != NULL);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (mList != NULL)
+        free(mList);
+    [super dealloc];
+}
+
+- (void)addSpan:(JbTableSpan)span
+{
+    assert(span.columnBegin < span.columnEnd);
+    mNumberOfSquares += span.columnEnd - span.columnBegin;
+    if (mCount == 0)
+    {
+        mRowBegin = span.row;
+        mRowEnd = span.row + 1;
+        mColumnBegin = span.columnBegin;
+        mColumnEnd = span.columnEnd;
+    }
+    else
+    {
+        if (span.row < mRowBegin) mRowBegin = span.row;
+        if (span.row >= mRowEnd) mRowEnd = span.row + 1;
+        if (span.columnBegin < mColumnBegin) mColumnBegin = span.columnBegin;
+        if (span.columnEnd > mColumnEnd) mColumnEnd = span.columnEnd;
+
+        JbTableSpan* last = &mList[mCount - 1];
+        if (last->row == span.row && last->columnEnd == span.columnBegin)
+        {
+            last->columnEnd = span.columnEnd;
+            return;
+        }
+        if (last->row > span.row
+            || (last->row == span.row && last->columnEnd > span.columnBegin))
+            mIsNormalized = NO;
+    }
+
+    if (mCount == mCapacity)
+    {
+        size_t newCapacity = mCapacity == 0 ? 8 : (mCapacity * 3 + 1) / 2;
+        JbTableSpan* newList = realloc(mList, newCapacity * sizeof(JbTableSpan));
+        if (newList == NULL)
+            return;
+        mList = newList;
+        mCapacity = newCapacity;
+    }
+    mList[mCount++] = span;
+}
+
+- (void)addValue:(JbTableIndex)value
+{
+    [self addSpan:JbMakeTableSpan(value.row, value.column, value.column + 1)];
+}
+
+- (void)addValues:(const JbTableIndex*)values count:(size_t)count
+{
+    for (size_t i = 0; i != count; ++i)
+        [self addSpan:JbMakeTableSpan(values[i].row, values[i].column, values[i].column + 1)];
+}
+
+- (void)normalize
+{
+    if (mIsNormalized)
+        return;
+
+    qsort(mList, mCount, sizeof(JbTableSpan), CompareSpans);
+    size_t count = 0;
+    mNumberOfSquares = 0;
+    for (size_t i = 0; i != mCount; ++i)
+    {
+        JbTableSpan* last = count != 0 ? &mList[count - 1] : NULL;
+        if (last != NULL && last->row == mList[i].row
+            && last->columnEnd >= mList[i].columnBegin)
+        {
+            if (mList[i].columnEnd > last->columnEnd)
+            {
+                mNumberOfSquares += mList[i].columnEnd - last->columnEnd;
+                last->columnEnd = mList[i].columnEnd;
+            }
+        }
+        else
+        {
+            mNumberOfSquares += mList[i].columnEnd - mList[i].columnBegin;
+            mList[count++] = mList[i];
+        }
+    }
+    mCount = count;
+    mIsNormalized = YES;
+}
+
+- (JbTableSpan*)begin
+{
+    return mList;
+}
+
+- (JbTableSpan*)end
+{
+    return &mList[mCount];
+}
+
+- (size_t)count
+{
+    return mCount;
+}
+
+- (size_t)numberOfSquares
+{
+    return mNumberOfSquares;
+}
+
+- (JbTableRect)bounds
+{
+    if (mCount == 0)
+        return JbMakeTableRect(0, 0, 0, 0);
+    return JbMakeTableRect(mRowBegin, mColumnBegin,
+                           mRowEnd - mRowBegin, mColumnEnd - mColumnBegin);
+}
+
+- (void)removeAllValues
+{
+    mCount = 0;
+    mNumberOfSquares = 0;
+    mRowBegin = mRowEnd = 0;
+    mColumnBegin = mColumnEnd = 0;
+    mIsNormalized = YES;
+}
+
+@end
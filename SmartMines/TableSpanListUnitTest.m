@@ -0,0 +1,127 @@
+//
+//  TableSpanListUnitTest.m
+//
+//  Created by Jan Erik Breimo on 2026-10-17.
+//  Copyright (c) 2026 Jan Erik Breimo. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any
+//  person obtaining a copy of this software and associated
+//  documentation files (the "Software"), to deal in the
+//  Software without restriction, including without
+//  limitation the rights to use, copy, modify, merge,
+//  publish, distribute, sublicense, and/or sell copies of
+//  the Software, and to permit persons to whom the
+//  Software is furnished to do so, subject to the
+//  following conditions:
+//
+//  The above copyright notice and this permission notice
+//  shall be included in all copies or substantial portions
+//  of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF
+//  ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED
+//  TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//  PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+//  SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+//  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+//  ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+//  OTHER DEALINGS IN THE SOFTWARE.
+
+#import "TableSpanListUnitTest.h"
+#import <SenTestingKit/SenTestCase.h>
+#import "TableSpanList.h"
+
+static BOOL IsSpan(const JbTableSpan* span,
+                   unsigned row,
+                   unsigned columnBegin,
+                   unsigned columnEnd)
+{
+    return span->row == row && span->columnBegin == columnBegin
+           && span->columnEnd == columnEnd;
+}
+
+@implementation JbTableSpanListUnitTest
+
+- (void)testAddInRowOrder
+{
+    JbTableSpanList* list = [[JbTableSpanList alloc] initWithCapacity:1];
+    [list addValue:JbMakeTableIndex(0, 2)];
+    [list addValue:JbMakeTableIndex(0, 3)];
+    [list addValue:JbMakeTableIndex(0, 4)];
+    [list addValue:JbMakeTableIndex(1, 0)];
+    [list addSpan:JbMakeTableSpan(1, 1, 3)];
+    STAssertTrue([list count] == 2, @"Wrong number of spans (%u)", (unsigned)[list count]);
+    STAssertTrue(IsSpan([list begin], 0, 2, 5), @"Wrong first span");
+    STAssertTrue(IsSpan([list begin] + 1, 1, 0, 3), @"Wrong second span");
+    STAssertTrue([list numberOfSquares] == 6, @"Wrong number of squares");
+
+    [list normalize];
+    STAssertTrue([list count] == 2, @"normalize changed spans that were in row order");
+
+    JbTableRect bounds = [list bounds];
+    STAssertTrue(bounds.origin.row == 0 && bounds.origin.column == 0
+                 && bounds.size.rows == 2 && bounds.size.columns == 5,
+                 @"Wrong bounds");
+    [list release];
+}
+
+- (void)testNormalize
+{
+    JbTableSpanList* list = [[JbTableSpanList alloc] initWithCapacity:1];
+    [list addSpan:JbMakeTableSpan(2, 3, 6)];
+    [list addSpan:JbMakeTableSpan(0, 4, 5)];
+    [list addSpan:JbMakeTableSpan(2, 1, 4)];
+    [list addSpan:JbMakeTableSpan(2, 7, 8)];
+    [list addSpan:JbMakeTableSpan(0, 5, 6)];
+    [list addSpan:JbMakeTableSpan(2, 6, 7)];
+    [list addSpan:JbMakeTableSpan(1, 9, 10)];
+    STAssertTrue([list numberOfSquares] == 11, @"Wrong number of squares before normalize");
+
+    [list normalize];
+    STAssertTrue([list count] == 3, @"Wrong number of spans (%u)", (unsigned)[list count]);
+    STAssertTrue(IsSpan([list begin], 0, 4, 6), @"Touching spans weren't joined");
+    STAssertTrue(IsSpan([list begin] + 1, 1, 9, 10), @"The rows weren't sorted");
+    STAssertTrue(IsSpan([list begin] + 2, 2, 1, 8), @"Overlapping spans weren't joined");
+    STAssertTrue([list numberOfSquares] == 10, @"Wrong number of squares after normalize");
+
+    JbTableRect bounds = [list bounds];
+    STAssertTrue(bounds.origin.row == 0 && bounds.origin.column == 1
+                 && bounds.size.rows == 3 && bounds.size.columns == 9,
+                 @"Wrong bounds");
+    [list release];
+}
+
+- (void)testNormalizeDuplicates
+{
+    JbTableSpanList* list = [[JbTableSpanList alloc] initWithCapacity:1];
+    [list addValue:JbMakeTableIndex(3, 3)];
+    [list addValue:JbMakeTableIndex(3, 2)];
+    [list addValue:JbMakeTableIndex(3, 3)];
+    STAssertTrue([list numberOfSquares] == 3, @"Wrong number of squares before normalize");
+
+    [list normalize];
+    STAssertTrue([list count] == 1, @"Wrong number of spans (%u)", (unsigned)[list count]);
+    STAssertTrue(IsSpan([list begin], 3, 2, 4), @"Wrong span");
+    STAssertTrue([list numberOfSquares] == 2, @"Duplicates were counted after normalize");
+    [list release];
+}
+
+- (void)testRemoveAllValues
+{
+    JbTableSpanList* list = [[JbTableSpanList alloc] initWithCapacity:1];
+    [list addSpan:JbMakeTableSpan(5, 1, 2)];
+    [list addSpan:JbMakeTableSpan(4, 1, 2)];
+    [list removeAllValues];
+    STAssertTrue([list count] == 0 && [list numberOfSquares] == 0, @"The list isn't empty");
+    STAssertTrue([list bounds].size.rows == 0 && [list bounds].size.columns == 0,
+                 @"The bounds of an empty list aren't empty");
+
+    [list addValue:JbMakeTableIndex(1, 1)];
+    [list normalize];
+    STAssertTrue([list count] == 1 && IsSpan([list begin], 1, 1, 2),
+                 @"The list wasn't reusable");
+    [list release];
+}
+
+@end
@@ -29,11 +29,8 @@
 //  OTHER DEALINGS IN THE SOFTWARE.
 
 #import <Cocoa/Cocoa.h>
-#import <stdlib.h>
-#import <time.h>
 
 int main(int argc, char *argv[])
 {
-    srandom((unsigned)time(NULL));
     return NSApplicationMain(argc,  (const char **) argv);
 }